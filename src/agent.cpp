@@ -1,5 +1,7 @@
 // agent.cpp
 #include "agent.h"
+#include "logging_service.h"
+#include <exception>
 #include <utility>
 
 namespace ai_framework {
@@ -13,7 +15,11 @@ std::string Agent::GetId() const {
 }
 
 void Agent::so_define_agent() {
-    // Base implementation - does nothing by default
+    // Answer messages sent to the agent; ProcessMessage may run
+    // concurrently, so an adv_thread_pool dispatcher can handle several at once
+    so_subscribe_self().event([this](const messages::AgentMessage& msg) {
+        Respond(msg);
+    }, so_5::thread_safe);
 }
 
 void Agent::so_evt_start() {
@@ -24,4 +30,22 @@ void Agent::so_evt_finish() {
     // Base implementation - does nothing by default
 }
 
+void Agent::Respond(const messages::AgentMessage& msg) {
+    std::string response;
+    std::string error;
+    try {
+        response = ProcessMessage(msg.content);
+    } catch (const std::exception& e) {
+        error = e.what();
+        LoggingService::GetInstance().Log(
+            LogLevel::ERROR, 
+            "Agent " + m_id + " failed to process message: " + error);
+    }
+    
+    if (msg.replyTo) {
+        so_5::send<messages::AgentResponse>(
+            msg.replyTo, m_id, std::move(response), msg.requestId, std::move(error));
+    }
+}
+
 } // namespace ai_framework
\ No newline at end of file
@@ -2,6 +2,7 @@
 #ifndef AI_FRAMEWORK_AGENT_H
 #define AI_FRAMEWORK_AGENT_H
 
+#include "messages.h"
 #include <memory>
 #include <string>
 #include <vector>
@@ -61,6 +62,8 @@ protected:
      * @brief Define SObjectizer event subscriptions
      * 
      * This method is called by SObjectizer when the agent is registered.
+     * Subscribes AgentMessage on the agent's direct mbox to Respond; an
+     * override must call it.
      */
     virtual void so_define_agent() override;
     
@@ -77,6 +80,16 @@ protected:
      * This method is called by SObjectizer when the agent is shutting down.
      */
     virtual void so_evt_finish() override;
+    
+    /**
+     * @brief Process an AgentMessage and send the AgentResponse to its replyTo
+     * 
+     * Runs ProcessMessage on the thread delivering the message. An exception
+     * is reported in the response's error instead of the content.
+     * 
+     * @param msg The message to answer
+     */
+    void Respond(const messages::AgentMessage& msg);
 
 private:
 
@@ -2,6 +2,8 @@
 #include "agent_factory.h"
 #include "learning_agent.h"
 #include "rule_based_agent.h"
+#include "logging_service.h"
+#include <exception>
 
 namespace ai_framework {
 
@@ -9,24 +11,38 @@ std::shared_ptr<Agent> AgentFactory::CreateAgent(
     so_5::environment_t& env,
     const std::string& type,
     const std::string& id,
-    const std::string& config) {
+    const std::string& config,
+    so_5::disp_binder_shptr_t binder) {
     
-    std::shared_ptr<Agent> agent = nullptr;
-    
-    env.introduce_coop([&](so_5::coop_t& coop){
+    try {
+        // The coop owns the agent, so the instance SObjectizer delivers
+        // AgentMessages to is the one the caller configures and calls
+        so_5::coop_unique_holder_t coop = binder ?
+            env.make_coop(std::move(binder)) : env.make_coop();
+        Agent* agent = nullptr;
         if (type == "learning") {
-            coop.make_agent<LearningAgent>(id);
-            agent = std::make_shared<LearningAgent>(env, id);
+            agent = coop->make_agent<LearningAgent>(id);
         } else if (type == "rule_based") {
-            coop.make_agent<RuleBasedAgent>(id);
-            agent = std::make_shared<RuleBasedAgent>(env, id);
+            agent = coop->make_agent<RuleBasedAgent>(id);
+        }
+        
+        // An unregistered coop is destroyed with its agent
+        if (!agent || !agent->Initialize(config)) {
+            return nullptr;
         }
-    });
-    if (agent && !agent->Initialize(config)) {
-        agent = nullptr;
+        so_5::coop_handle_t handle = env.register_coop(std::move(coop));
+        
+        // Releasing the last reference deregisters the coop; SObjectizer
+        // destroys the agent once it has handled its remaining events
+        return std::shared_ptr<Agent>(agent, [&env, handle](Agent*) {
+            env.deregister_coop(handle, so_5::dereg_reason::normal);
+        });
+    } catch (const std::exception& e) {
+        LoggingService::GetInstance().Log(
+            LogLevel::ERROR, 
+            "Failed to register agent " + id + ": " + std::string(e.what()));
+        return nullptr;
     }
-    
-    return agent;
 }
 
 } // namespace ai_framework
\ No newline at end of file
@@ -24,13 +24,18 @@ public:
      * @param type The type of agent to create
      * @param id Unique identifier for the new agent
      * @param config Configuration for the new agent
-     * @return std::shared_ptr<Agent> Pointer to the created agent
+     * @param binder Dispatcher to run the agent on, null for the default one
+     * @return std::shared_ptr<Agent> Pointer to the created agent, registered
+     *         with SObjectizer until the last copy is released; null if the
+     *         type is unknown or initialization failed. The environment
+     *         must outlive every copy.
      */
     static std::shared_ptr<Agent> CreateAgent(
         so_5::environment_t& env,
         const std::string& type,
         const std::string& id,
-        const std::string& config);
+        const std::string& config,
+        so_5::disp_binder_shptr_t binder = nullptr);
 };
 
 } // namespace ai_framework
@@ -1,24 +1,204 @@
 // agent_manager.cpp
 #include "agent_manager.h"
 #include "agent_factory.h"
+#include "learning_agent.h"
 #include "rule_based_agent.h"
+#include "logging_service.h"
+#include "memory_budget.h"
+#include "messages.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <exception>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace ai_framework {
 
+/**
+ * @brief Requests awaiting their AgentResponse, shared with the ReplyAgent
+ */
+struct AgentManager::PendingReplies {
+    /**
+     * @brief One outstanding request
+     */
+    struct Reply {
+        /** Target agent, kept registered until it has answered */
+        std::shared_ptr<Agent> agent;
+        
+        /** Dispatcher the agent runs on, whose queue depth counts this request */
+        std::shared_ptr<DispatcherRegistry::Binding> binding;
+        
+        ResponseCallback callback;
+    };
+    
+    std::mutex mutex;
+    std::unordered_map<uint64_t, Reply> replies;
+    uint64_t nextId = 1;
+    
+    /**
+     * @brief Remove a request
+     * 
+     * @return bool False if it was already completed
+     */
+    bool Take(uint64_t requestId, Reply& reply) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = replies.find(requestId);
+        if (it == replies.end()) {
+            return false;
+        }
+        reply = std::move(it->second);
+        replies.erase(it);
+        reply.binding->queueDepth.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+};
+
+/**
+ * @brief Agent completing SendMessageAsync requests as their responses arrive
+ */
+class AgentManager::ReplyAgent : public so_5::agent_t {
+public:
+    ReplyAgent(so_5::environment_t& env, std::shared_ptr<PendingReplies> pending)
+        : so_5::agent_t(env), m_pending(std::move(pending)) {
+    }
+    
+protected:
+    void so_define_agent() override {
+        so_subscribe_self().event([this](const messages::AgentResponse& msg) {
+            PendingReplies::Reply reply;
+            if (!m_pending->Take(msg.requestId, reply)) {
+                return;
+            }
+            reply.binding->delivered.fetch_add(1, std::memory_order_relaxed);
+            
+            if (msg.error.empty()) {
+                reply.callback(true, msg.content);
+            }
+            else {
+                reply.callback(false, msg.error);
+            }
+        });
+    }
+    
+private:
+    std::shared_ptr<PendingReplies> m_pending;
+};
+
+/**
+ * @brief Pairs posted by IngestAgentMemoryAsync
+ */
+struct AgentManager::IngestRequest final : public so_5::message_t {
+    std::shared_ptr<LearningAgent> agent;
+    std::vector<std::pair<std::string, std::string>> pairs;
+    IngestCallback callback;
+    
+    IngestRequest(std::shared_ptr<LearningAgent> target,
+                  std::vector<std::pair<std::string, std::string>> learned,
+                  IngestCallback done)
+        : agent(std::move(target)),
+          pairs(std::move(learned)),
+          callback(std::move(done)) {}
+};
+
+/**
+ * @brief Rules posted by ReloadAgentRulesAsync
+ */
+struct AgentManager::ReloadRequest final : public so_5::message_t {
+    std::shared_ptr<RuleBasedAgent> agent;
+    std::string rulesConfig;
+    ReloadCallback callback;
+    
+    ReloadRequest(std::shared_ptr<RuleBasedAgent> target,
+                  std::string rules,
+                  ReloadCallback done)
+        : agent(std::move(target)),
+          rulesConfig(std::move(rules)),
+          callback(std::move(done)) {}
+};
+
+/**
+ * @brief Agent running IngestAgentMemoryAsync and ReloadAgentRulesAsync
+ *        requests on a thread of its own
+ */
+class AgentManager::IngestAgent : public so_5::agent_t {
+public:
+    explicit IngestAgent(so_5::environment_t& env)
+        : so_5::agent_t(env) {
+    }
+    
+protected:
+    void so_define_agent() override {
+        so_subscribe_self().event([](const IngestRequest& msg) {
+            size_t ingested = 0;
+            std::string error;
+            try {
+                ingested = msg.agent->Ingest(msg.pairs);
+            } catch (const std::exception& e) {
+                error = e.what();
+                LoggingService::GetInstance().Log(
+                    LogLevel::ERROR, 
+                    "Agent " + msg.agent->GetId() + " failed to ingest pairs: " + error);
+            }
+            msg.callback(error.empty(), ingested, error);
+        });
+        
+        so_subscribe_self().event([](const ReloadRequest& msg) {
+            // ReloadRules logs its own failures
+            msg.callback(msg.agent && msg.agent->ReloadRules(msg.rulesConfig));
+        });
+    }
+};
+
 AgentManager::AgentManager(so_5::environment_t& env)
-    : m_env(env) {
+    : m_env(env),
+      m_dispatchers(env),
+      m_pending(std::make_shared<PendingReplies>()) {
+    
+    so_5::coop_unique_holder_t coop = m_env.make_coop();
+    m_replyMbox = coop->make_agent<ReplyAgent>(m_pending)->so_direct_mbox();
+    
+    // A batch of pairs keeps its thread busy for a while; replies must not
+    // wait behind it
+    m_ingestMbox = coop->make_agent_with_binder<IngestAgent>(
+        so_5::disp::one_thread::make_dispatcher(m_env, "ingest").binder())->so_direct_mbox();
+    m_replyCoop = m_env.register_coop(std::move(coop));
 }
 
 AgentManager::~AgentManager() {
-    // Clear all agents
-    std::lock_guard<std::mutex> lock(m_agentsMutex);
-    m_agents.clear();
+    // Responses arriving from now on are dropped; fail what is outstanding
+    m_env.deregister_coop(m_replyCoop, so_5::dereg_reason::normal);
+    
+    std::unordered_map<uint64_t, PendingReplies::Reply> replies;
+    {
+        std::lock_guard<std::mutex> lock(m_pending->mutex);
+        replies.swap(m_pending->replies);
+    }
+    for (auto& pair : replies) {
+        pair.second.binding->queueDepth.fetch_sub(1, std::memory_order_relaxed);
+        pair.second.callback(false, "Agent manager shut down");
+    }
+    
+    // No lookup can still be running; each shard frees its current table,
+    // and the agents with it, as it is destroyed
 }
 
 bool AgentManager::Initialize(const std::string& config) {
-    // Implementation would parse config and set up initial state
-    return true;
+    try {
+        nlohmann::json configJson = nlohmann::json::parse(config);
+        
+        // Bytes all learning agents may use together
+        if (configJson.contains("memory_budget_bytes")) {
+            MemoryBudget::GetInstance().SetLimit(configJson["memory_budget_bytes"].get<uint64_t>());
+        }
+        
+        // Dispatchers agents run on, by agent type or by name
+        return m_dispatchers.Configure(config);
+    } catch (const std::exception& e) {
+        LoggingService::GetInstance().Log(
+            LogLevel::ERROR,
+            "Failed to initialize AgentManager: " + std::string(e.what()));
+        return false;
+    }
 }
 
 bool AgentManager::CreateAgent(
@@ -26,19 +206,43 @@ bool AgentManager::CreateAgent(
     const std::string& id,
     const std::string& config) {
     
-    // Check if an agent with this ID already exists
+    // Bind the agent to the dispatcher it or its type is configured for
+    std::string dispatcher;
+    try {
+        nlohmann::json configJson = nlohmann::json::parse(config);
+        if (configJson.is_object()) {
+            dispatcher = configJson.value("dispatcher", std::string());
+        }
+    } catch (const std::exception&) {
+        // The agent's Initialize rejects the configuration
+    }
+    auto binding = m_dispatchers.Resolve(type, dispatcher);
+    if (!binding) {
+        LoggingService::GetInstance().Log(
+            LogLevel::ERROR,
+            "Unknown dispatcher for agent " + id + ": " + dispatcher);
+        return false;
+    }
+    
+    // Reserve the ID, so that only one agent is ever built for it: a
+    // learning agent opens its memory files as it is initialized
+    AgentShard& shard = ShardOf(id);
     {
-        std::lock_guard<std::mutex> lock(m_agentsMutex);
-        if (m_agents.find(id) != m_agents.end()) {
+        std::lock_guard<std::mutex> lock(shard.writeMutex);
+        const AgentTable* current = shard.table.Load();
+        if (current->find(id) != current->end() || !shard.reserved.insert(id).second) {
             return false;
         }
     }
     
     // Create the agent
-
-    auto agent = AgentFactory::CreateAgent(m_env, type, id, config);
-    if (!agent) {
-        return false;
+    std::shared_ptr<Agent> agent;
+    try {
+        agent = AgentFactory::CreateAgent(m_env, type, id, config, binding->binder);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(shard.writeMutex);
+        shard.reserved.erase(id);
+        throw;
     }
     
     // // Register the agent with SObjectizer
@@ -56,26 +260,47 @@ bool AgentManager::CreateAgent(
     //     coop.add_agent(agent.get(), ""); //)<RuleBasedAgent>(id)
     // });
    
-    // Add the agent to our map
-    {
-        std::lock_guard<std::mutex> lock(m_agentsMutex);
-        m_agents[id] = agent;
+    // Publish a copy of the shard's table with the agent added; only
+    // writers replace the table, so holding the mutex keeps it alive
+    std::lock_guard<std::mutex> lock(shard.writeMutex);
+    shard.reserved.erase(id);
+    if (!agent) {
+        return false;
     }
+    const AgentTable* current = shard.table.Load();
+    
+    auto table = std::make_unique<AgentTable>(*current);
+    table->emplace(id, AgentEntry{std::move(agent), binding});
+    shard.table.Store(std::move(table));
+    binding->agents.fetch_add(1, std::memory_order_relaxed);
     
     return true;
 }
 
 bool AgentManager::DestroyAgent(const std::string& id) {
-    std::lock_guard<std::mutex> lock(m_agentsMutex);
+    std::shared_ptr<Agent> removed;
     
-    auto it = m_agents.find(id);
-    if (it == m_agents.end()) {
-        return false;
+    {
+        AgentShard& shard = ShardOf(id);
+        std::lock_guard<std::mutex> lock(shard.writeMutex);
+        const AgentTable* current = shard.table.Load();
+        
+        auto it = current->find(id);
+        if (it == current->end()) {
+            return false;
+        }
+        removed = it->second.agent;
+        it->second.binding->agents.fetch_sub(1, std::memory_order_relaxed);
+        
+        auto table = std::make_unique<AgentTable>(*current);
+        table->erase(id);
+        shard.table.Store(std::move(table));
     }
     
-    // The agent will be deregistered from SObjectizer when the shared_ptr
-    // is destroyed
-    m_agents.erase(it);
+    // The agent will be deregistered from SObjectizer when the last
+    // shared_ptr is destroyed: here, unless a message is still being
+    // processed or a reader still holds the old table
+    removed.reset();
     
     return true;
 }
@@ -84,46 +309,211 @@ std::string AgentManager::SendMessage(
     const std::string& agentId,
     const std::string& message) {
     
-    std::shared_ptr<Agent> agent;
+    // Get the agent
+    std::shared_ptr<Agent> agent = GetAgent(agentId);
+    
+    // Process the message
+    return agent->ProcessMessage(message);
+}
+
+void AgentManager::SendMessageAsync(
+    const std::string& agentId,
+    const std::string& message,
+    ResponseCallback callback) {
     
     // Get the agent
+    AgentEntry entry;
+    if (!FindEntry(agentId, entry)) {
+        throw std::runtime_error("Agent not found: " + agentId);
+    }
+    so_5::mbox_t mbox = entry.agent->so_direct_mbox();
+    
+    uint64_t requestId;
     {
-        std::lock_guard<std::mutex> lock(m_agentsMutex);
-        auto it = m_agents.find(agentId);
-        if (it == m_agents.end()) {
-            throw std::runtime_error("Agent not found: " + agentId);
+        std::lock_guard<std::mutex> lock(m_pending->mutex);
+        requestId = m_pending->nextId++;
+        entry.binding->queueDepth.fetch_add(1, std::memory_order_relaxed);
+        m_pending->replies.emplace(
+            requestId,
+            PendingReplies::Reply{std::move(entry.agent), std::move(entry.binding), std::move(callback)});
+    }
+    
+    // The agent answers to the ReplyAgent, which runs the callback
+    try {
+        so_5::send<messages::AgentMessage>(
+            mbox, std::string(), agentId, message, m_replyMbox, requestId);
+    } catch (...) {
+        PendingReplies::Reply reply;
+        m_pending->Take(requestId, reply);
+        throw;
+    }
+}
+
+std::future<std::string> AgentManager::SendMessageAsync(
+    const std::string& agentId,
+    const std::string& message) {
+    
+    auto promise = std::make_shared<std::promise<std::string>>();
+    std::future<std::string> future = promise->get_future();
+    
+    SendMessageAsync(agentId, message, [promise](bool success, const std::string& content) {
+        if (success) {
+            promise->set_value(content);
+        }
+        else {
+            promise->set_exception(std::make_exception_ptr(std::runtime_error(content)));
         }
-        agent = it->second;
+    });
+    
+    return future;
+}
+
+bool AgentManager::ReloadAgentRules(
+    const std::string& agentId,
+    const std::string& rulesConfig) {
+    
+    // Get the agent
+    std::shared_ptr<Agent> agent = GetAgent(agentId);
+    
+    auto ruleAgent = std::dynamic_pointer_cast<RuleBasedAgent>(agent);
+    if (!ruleAgent) {
+        return false;
     }
     
-    // Process the message
-    return agent->ProcessMessage(message);
+    // Compiles on the calling thread; message traffic is not held up
+    return ruleAgent->ReloadRules(rulesConfig);
+}
+
+void AgentManager::ReloadAgentRulesAsync(
+    const std::string& agentId,
+    std::string rulesConfig,
+    ReloadCallback callback) {
+    
+    // Get the agent; one that is not rule-based is reported by the callback
+    auto ruleAgent = std::dynamic_pointer_cast<RuleBasedAgent>(GetAgent(agentId));
+    
+    so_5::send<ReloadRequest>(m_ingestMbox, std::move(ruleAgent), std::move(rulesConfig), std::move(callback));
+}
+
+std::string AgentManager::GetAgentRuleProfile(const std::string& agentId) const {
+    // Get the agent
+    std::shared_ptr<Agent> agent = GetAgent(agentId);
+    
+    auto ruleAgent = std::dynamic_pointer_cast<RuleBasedAgent>(agent);
+    if (!ruleAgent) {
+        throw std::runtime_error("Agent is not rule-based: " + agentId);
+    }
+    
+    return ruleAgent->DumpRuleProfile();
+}
+
+size_t AgentManager::IngestAgentMemory(
+    const std::string& agentId,
+    const std::vector<std::pair<std::string, std::string>>& pairs) {
+    
+    // Get the agent
+    std::shared_ptr<Agent> agent = GetAgent(agentId);
+    
+    auto learningAgent = std::dynamic_pointer_cast<LearningAgent>(agent);
+    if (!learningAgent) {
+        throw std::runtime_error("Agent is not a learning agent: " + agentId);
+    }
+    
+    // Tokenizes on several threads; message traffic is not held up
+    return learningAgent->Ingest(pairs);
+}
+
+void AgentManager::IngestAgentMemoryAsync(
+    const std::string& agentId,
+    std::vector<std::pair<std::string, std::string>> pairs,
+    IngestCallback callback) {
+    
+    // Get the agent
+    auto learningAgent = std::dynamic_pointer_cast<LearningAgent>(GetAgent(agentId));
+    if (!learningAgent) {
+        throw std::runtime_error("Agent is not a learning agent: " + agentId);
+    }
+    
+    so_5::send<IngestRequest>(m_ingestMbox, std::move(learningAgent), std::move(pairs), std::move(callback));
+}
+
+std::string AgentManager::GetDispatcherStats() const {
+    nlohmann::json dump = nlohmann::json::object();
+    for (const auto& stats : m_dispatchers.GetStats()) {
+        dump[stats.name] = {
+            {"type", stats.type},
+            {"threads", stats.threads},
+            {"agents", stats.agents},
+            {"queue_depth", stats.queueDepth},
+            {"delivered", stats.delivered}
+        };
+    }
+    return dump.dump();
 }
 
 bool AgentManager::AgentExists(const std::string& id) const {
-    std::lock_guard<std::mutex> lock(m_agentsMutex);
-    return m_agents.find(id) != m_agents.end();
+    return FindAgent(id) != nullptr;
 }
 
 void AgentManager::RegisterAgentType(
     const std::string& type, 
     const std::function<std::shared_ptr<Agent>(so_5::environment_t&, const std::string&)>& factory) {
     
-    std::lock_guard<std::mutex> lock(m_agentsMutex);
+    std::lock_guard<std::mutex> lock(m_factoriesMutex);
     m_agentFactories[type] = factory;
 }
 
 std::vector<std::string> AgentManager::GetAllAgentIds() const {
     std::vector<std::string> ids;
     
-    std::lock_guard<std::mutex> lock(m_agentsMutex);
-    ids.reserve(m_agents.size());
-    
-    for (const auto& pair : m_agents) {
-        ids.push_back(pair.first);
+    {
+        EpochGuard guard;
+        for (const auto& shard : m_shards) {
+            for (const auto& pair : *shard.table.Load()) {
+                ids.push_back(pair.first);
+            }
+        }
     }
     
+    // Same order as before the registry was sharded
+    std::sort(ids.begin(), ids.end());
     return ids;
 }
 
+AgentManager::AgentShard& AgentManager::ShardOf(const std::string& id) {
+    return m_shards[std::hash<std::string>{}(id) % SHARD_COUNT];
+}
+
+const AgentManager::AgentShard& AgentManager::ShardOf(const std::string& id) const {
+    return m_shards[std::hash<std::string>{}(id) % SHARD_COUNT];
+}
+
+std::shared_ptr<Agent> AgentManager::FindAgent(const std::string& id) const {
+    AgentEntry entry;
+    return FindEntry(id, entry) ? entry.agent : nullptr;
+}
+
+bool AgentManager::FindEntry(const std::string& id, AgentEntry& entry) const {
+    const AgentShard& shard = ShardOf(id);
+    
+    // The table stays valid until the guard ends; the agent is kept alive
+    // past that by the copied shared_ptr
+    EpochGuard guard;
+    const AgentTable* table = shard.table.Load();
+    auto it = table->find(id);
+    if (it == table->end()) {
+        return false;
+    }
+    entry = it->second;
+    return true;
+}
+
+std::shared_ptr<Agent> AgentManager::GetAgent(const std::string& id) const {
+    std::shared_ptr<Agent> agent = FindAgent(id);
+    if (!agent) {
+        throw std::runtime_error("Agent not found: " + id);
+    }
+    return agent;
+}
+
 } // namespace ai_framework
\ No newline at end of file
@@ -3,9 +3,19 @@
 #define AI_FRAMEWORK_AGENT_MANAGER_H
 
 #include "agent.h"
+#include "dispatcher_registry.h"
+#include "rcu.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <mutex>
 #include <so_5/all.hpp>
 
@@ -16,9 +26,41 @@ namespace ai_framework {
  * 
  * This class keeps track of all active agents, handles agent creation
  * and destruction, and routes messages between agents.
+ *
+ * The registry is split into shards by agent ID. Each shard publishes an
+ * immutable table through an RcuPointer, so looking an agent up takes no
+ * lock and never waits for CreateAgent or DestroyAgent; those copy the
+ * shard's table, change the copy and publish it under the shard's mutex.
  */
 class AgentManager {
 public:
+    /**
+     * @brief Receives the outcome of SendMessageAsync
+     * 
+     * Called with true and the agent's response, or with false and the
+     * reason the message could not be processed. Runs on a SObjectizer
+     * worker thread and must not block.
+     */
+    using ResponseCallback = std::function<void(bool success, const std::string& content)>;
+    
+    /**
+     * @brief Receives the outcome of IngestAgentMemoryAsync
+     * 
+     * Called with true and the number of pairs learned, or with false and
+     * the reason nothing was learned. Runs on the ingest worker thread and
+     * must not block.
+     */
+    using IngestCallback = std::function<void(bool success, size_t ingested, const std::string& error)>;
+    
+    /**
+     * @brief Receives the outcome of ReloadAgentRulesAsync
+     * 
+     * Called with true once the new rules are published, or with false if
+     * the agent is not rule-based or the rules are invalid. Runs on the
+     * ingest worker thread and must not block.
+     */
+    using ReloadCallback = std::function<void(bool success)>;
+    
     /**
      * @brief Constructor for AgentManager
      * 
@@ -66,6 +108,104 @@ public:
      */
     std::string SendMessage(const std::string& agentId, const std::string& message);
     
+    /**
+     * @brief Post a message to an agent's mbox without waiting for the answer
+     * 
+     * The agent handles the AgentMessage on its dispatcher's thread and sends
+     * an AgentResponse back; the callback runs when that arrives. The agent
+     * is kept alive until then, even if it is destroyed meanwhile.
+     * 
+     * @param agentId ID of the target agent
+     * @param message Message to send
+     * @param callback Receives the response
+     * @throws std::runtime_error If the agent does not exist
+     */
+    void SendMessageAsync(const std::string& agentId, const std::string& message,
+                          ResponseCallback callback);
+    
+    /**
+     * @brief Post a message to an agent's mbox, returning a future of the answer
+     * 
+     * @param agentId ID of the target agent
+     * @param message Message to send
+     * @return std::future<std::string> Response from the agent; holds a
+     *         std::runtime_error if the agent failed to process the message
+     * @throws std::runtime_error If the agent does not exist
+     */
+    std::future<std::string> SendMessageAsync(const std::string& agentId, const std::string& message);
+    
+    /**
+     * @brief Replace the rules of a rule-based agent without recreating it
+     * 
+     * @param agentId ID of the target agent
+     * @param rulesConfig JSON with "rules" and optionally "default_response"
+     * @return bool True if the new rules were published, false if the agent
+     *         is not rule-based or the rules are invalid
+     */
+    bool ReloadAgentRules(const std::string& agentId, const std::string& rulesConfig);
+    
+    /**
+     * @brief Replace the rules of a rule-based agent without waiting for it
+     * 
+     * The rules are compiled on the same worker thread as
+     * IngestAgentMemoryAsync requests, in the order they were posted, so a
+     * large rule set never holds up the caller's thread. Requests still
+     * queued when the manager is destroyed are dropped without a callback.
+     * 
+     * @param agentId ID of the target agent
+     * @param rulesConfig JSON with "rules" and optionally "default_response"
+     * @param callback Receives whether the new rules were published
+     * @throws std::runtime_error If the agent does not exist
+     */
+    void ReloadAgentRulesAsync(const std::string& agentId,
+                               std::string rulesConfig,
+                               ReloadCallback callback);
+    
+    /**
+     * @brief Get the per-rule hit and latency counters of a rule-based agent
+     * 
+     * @param agentId ID of the target agent
+     * @return std::string JSON dump of the agent's rule counters
+     * @throws std::runtime_error If the agent does not exist or is not rule-based
+     */
+    std::string GetAgentRuleProfile(const std::string& agentId) const;
+    
+    /**
+     * @brief Teach a learning agent (message, response) pairs in bulk
+     * 
+     * @param agentId ID of the target agent
+     * @param pairs Messages with the response to learn for each
+     * @return size_t Number of pairs learned
+     * @throws std::runtime_error If the agent does not exist or is not a learning agent
+     */
+    size_t IngestAgentMemory(const std::string& agentId,
+                             const std::vector<std::pair<std::string, std::string>>& pairs);
+    
+    /**
+     * @brief Teach a learning agent pairs in bulk without waiting for it
+     * 
+     * The pairs are ingested on a worker thread of the manager's own, one
+     * request at a time in the order they were posted, so the caller's
+     * thread, such as a network event loop, is never held up. Requests still
+     * queued when the manager is destroyed are dropped without a callback.
+     * 
+     * @param agentId ID of the target agent
+     * @param pairs Messages with the response to learn for each
+     * @param callback Receives the number of pairs learned
+     * @throws std::runtime_error If the agent does not exist or is not a learning agent
+     */
+    void IngestAgentMemoryAsync(const std::string& agentId,
+                                std::vector<std::pair<std::string, std::string>> pairs,
+                                IngestCallback callback);
+    
+    /**
+     * @brief Get the counters of every dispatcher binding
+     * 
+     * @return std::string JSON object keyed by binding name, with each
+     *         binding's type, threads, agents, queue_depth and delivered
+     */
+    std::string GetDispatcherStats() const;
+    
     /**
      * @brief Check if an agent with the given ID exists
      * 
@@ -91,14 +231,93 @@ public:
     );
 
 private:
+    class ReplyAgent;
+    class IngestAgent;
+    struct PendingReplies;
+    struct IngestRequest;
+    struct ReloadRequest;
+    
+    /**
+     * @brief A registered agent and the dispatcher it runs on
+     */
+    struct AgentEntry {
+        std::shared_ptr<Agent> agent;
+        std::shared_ptr<DispatcherRegistry::Binding> binding;
+    };
+    
+    /** Agents of one shard by ID; never changed once published */
+    using AgentTable = std::unordered_map<std::string, AgentEntry>;
+    
+    /**
+     * @brief One shard of the agent registry
+     */
+    struct alignas(64) AgentShard {
+        /** Current table, replaced as a whole on every change */
+        RcuPointer<const AgentTable> table{std::make_unique<AgentTable>()};
+        
+        /** Mutex serializing writers of this shard */
+        std::mutex writeMutex;
+        
+        /** IDs whose agents are being built; guarded by writeMutex */
+        std::unordered_set<std::string> reserved;
+    };
+    
+    /** Number of registry shards */
+    static constexpr size_t SHARD_COUNT = 64;
+    
+    /**
+     * @brief Get the shard an agent ID belongs to
+     */
+    AgentShard& ShardOf(const std::string& id);
+    const AgentShard& ShardOf(const std::string& id) const;
+    
+    /**
+     * @brief Look an agent up without taking a lock
+     * 
+     * @param id Agent ID
+     * @return std::shared_ptr<Agent> The agent, or null if there is none
+     */
+    std::shared_ptr<Agent> FindAgent(const std::string& id) const;
+    
+    /**
+     * @brief Look an agent and its dispatcher binding up without taking a lock
+     * 
+     * @param id Agent ID
+     * @param entry Receives the agent and its binding
+     * @return bool False if there is no such agent
+     */
+    bool FindEntry(const std::string& id, AgentEntry& entry) const;
+    
+    /**
+     * @brief Look an agent up, failing if there is none
+     * 
+     * @throws std::runtime_error If the agent does not exist
+     */
+    std::shared_ptr<Agent> GetAgent(const std::string& id) const;
+    
     /** Reference to SObjectizer environment */
     so_5::environment_t& m_env;
     
-    /** Map of agent ID to agent instance */
-    std::map<std::string, std::shared_ptr<Agent>> m_agents;
+    /** Agent registry */
+    std::array<AgentShard, SHARD_COUNT> m_shards;
+    
+    /** Dispatchers agents are bound to */
+    DispatcherRegistry m_dispatchers;
+    
+    /** Requests posted by SendMessageAsync awaiting their AgentResponse */
+    std::shared_ptr<PendingReplies> m_pending;
+    
+    /** Mbox of the agent collecting AgentResponses */
+    so_5::mbox_t m_replyMbox;
+    
+    /** Mbox of the agent running IngestAgentMemoryAsync and ReloadAgentRulesAsync requests */
+    so_5::mbox_t m_ingestMbox;
+    
+    /** Coop of those two agents */
+    so_5::coop_handle_t m_replyCoop;
     
-    /** Mutex for thread-safe access to the agents map */
-    mutable std::mutex m_agentsMutex;
+    /** Mutex guarding the factory map */
+    mutable std::mutex m_factoriesMutex;
 
     /** Map of agent type to factory function */
     std::map<std::string, std::function<std::shared_ptr<Agent>(
@@ -0,0 +1,461 @@
+// cold_store.cpp
+#include "cold_store.h"
+#include "learning_memory.h"
+#include "logging_service.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <zlib.h>
+
+namespace ai_framework {
+
+namespace {
+
+void PutUint32(std::string& buffer, uint32_t value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+uint32_t GetUint32(const char* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Spread a fingerprint's bits before masking to a slot index
+ */
+size_t SlotIndex(uint32_t fingerprint, size_t mask) {
+    uint64_t hash = fingerprint;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return static_cast<size_t>(hash) & mask;
+}
+
+} // namespace
+
+void ColdStore::Add(uint64_t hash, std::string_view key, const std::vector<std::string_view>& responses) {
+    Erase(hash);
+
+    // Record: key length, response count, key, then each response with its length
+    size_t start = m_open.size();
+    PutUint32(m_open, static_cast<uint32_t>(key.size()));
+    PutUint32(m_open, static_cast<uint32_t>(responses.size()));
+    m_open.append(key.data(), key.size());
+    for (std::string_view response : responses) {
+        PutUint32(m_open, static_cast<uint32_t>(response.size()));
+        m_open.append(response.data(), response.size());
+    }
+
+    uint32_t location = static_cast<uint32_t>(m_blocks.size() << RECORD_BITS) | m_openRecords;
+    InsertSlot(Fingerprint(hash), location);
+    ++m_openRecords;
+    ++m_openLive;
+    m_liveBytes += m_open.size() - start;
+
+    if (m_open.size() >= BLOCK_BYTES || m_openRecords == MAX_BLOCK_RECORDS) {
+        Seal();
+    }
+}
+
+bool ColdStore::Contains(uint64_t hash) const {
+    if (m_slots.empty()) {
+        return false;
+    }
+    uint32_t fingerprint = Fingerprint(hash);
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = SlotIndex(fingerprint, mask); m_slots[i].fingerprint != 0; i = (i + 1) & mask) {
+        if (m_slots[i].fingerprint == fingerprint) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ColdStore::Take(uint64_t hash, std::string& key, std::vector<std::string>& responses) {
+    std::shared_ptr<const std::string> block;
+    const char* record;
+    size_t slot = FindSlot(hash, block, record);
+    if (slot == NO_SLOT) {
+        return false;
+    }
+
+    std::string_view keyView;
+    std::vector<std::string_view> views;
+    size_t size = static_cast<size_t>(ParseRecord(record, keyView, views) - record);
+    key.assign(keyView);
+    responses.assign(views.begin(), views.end());
+
+    uint32_t location = m_slots[slot].location;
+    RemoveSlot(slot);
+    Forget(location, size);
+    CompactIfNeeded();
+    return true;
+}
+
+bool ColdStore::Erase(uint64_t hash) {
+    std::shared_ptr<const std::string> block;
+    const char* record;
+    size_t slot = FindSlot(hash, block, record);
+    if (slot == NO_SLOT) {
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(RecordEnd(record) - record);
+    uint32_t location = m_slots[slot].location;
+    RemoveSlot(slot);
+    Forget(location, size);
+    CompactIfNeeded();
+    return true;
+}
+
+void ColdStore::ForEach(
+    const std::function<void(std::string_view, const std::vector<std::string_view>&)>& visit) const {
+
+    std::string_view key;
+    std::vector<std::string_view> responses;
+    auto visitBlock = [&](uint32_t index, const std::string& raw) {
+        const char* pos = raw.data();
+        const char* end = raw.data() + raw.size();
+        for (uint32_t record = 0; pos < end; ++record) {
+            responses.clear();
+            pos = ParseRecord(pos, key, responses);
+
+            // Taken and replaced records stay in the block; skip them
+            uint32_t location = (index << RECORD_BITS) | record;
+            if (FindLocation(Fingerprint(LearningMemory::HashKey(key)), location) != NO_SLOT) {
+                visit(key, responses);
+            }
+        }
+    };
+
+    for (uint32_t i = 0; i < m_blocks.size(); ++i) {
+        if (m_blocks[i].liveRecords == 0) {
+            continue;
+        }
+        auto cached = std::find_if(m_cache.begin(), m_cache.end(),
+                                   [i](const auto& item) { return item.first == i; });
+        std::shared_ptr<const std::string> raw =
+            cached != m_cache.end() ? cached->second : Inflate(m_blocks[i]);
+        if (raw) {
+            visitBlock(i, *raw);
+        }
+    }
+    if (m_openLive > 0) {
+        visitBlock(static_cast<uint32_t>(m_blocks.size()), m_open);
+    }
+}
+
+void ColdStore::Clear() {
+    m_blocks.clear();
+    m_emptyBlocks = 0;
+    m_open.clear();
+    m_openRecords = 0;
+    m_openLive = 0;
+    m_slots.clear();
+    m_count = 0;
+    m_dictionary.reset();
+    m_cache.clear();
+    m_liveBytes = 0;
+    m_deadBytes = 0;
+}
+
+size_t ColdStore::GetMemoryBytes() const {
+    size_t bytes = m_blocks.capacity() * sizeof(Block) + m_open.capacity() +
+                   m_slots.capacity() * sizeof(Slot);
+    for (const auto& block : m_blocks) {
+        if (block.data) {
+            bytes += block.data->capacity();
+        }
+    }
+    for (const auto& item : m_cache) {
+        bytes += item.second->capacity();
+    }
+    if (m_dictionary) {
+        bytes += m_dictionary->capacity();
+    }
+    return bytes;
+}
+
+size_t ColdStore::FindSlot(uint64_t hash, std::shared_ptr<const std::string>& block, const char*& record) {
+    if (m_slots.empty()) {
+        return NO_SLOT;
+    }
+    uint32_t fingerprint = Fingerprint(hash);
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = SlotIndex(fingerprint, mask); m_slots[i].fingerprint != 0; i = (i + 1) & mask) {
+        if (m_slots[i].fingerprint != fingerprint) {
+            continue;
+        }
+        // Fingerprints collide; the stored key settles it
+        record = ReadRecord(m_slots[i].location, block);
+        if (record && LearningMemory::HashKey(RecordKey(record)) == hash) {
+            return i;
+        }
+    }
+    return NO_SLOT;
+}
+
+size_t ColdStore::FindLocation(uint32_t fingerprint, uint32_t location) const {
+    if (m_slots.empty()) {
+        return NO_SLOT;
+    }
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = SlotIndex(fingerprint, mask); m_slots[i].fingerprint != 0; i = (i + 1) & mask) {
+        if (m_slots[i].fingerprint == fingerprint && m_slots[i].location == location) {
+            return i;
+        }
+    }
+    return NO_SLOT;
+}
+
+void ColdStore::InsertSlot(uint32_t fingerprint, uint32_t location) {
+    // Grow at three quarters full
+    if ((m_count + 1) * 4 > m_slots.size() * 3) {
+        std::vector<Slot> old(std::max<size_t>(16, m_slots.size() * 2), Slot{0, 0});
+        old.swap(m_slots);
+        size_t mask = m_slots.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.fingerprint != 0) {
+                size_t i = SlotIndex(slot.fingerprint, mask);
+                while (m_slots[i].fingerprint != 0) {
+                    i = (i + 1) & mask;
+                }
+                m_slots[i] = slot;
+            }
+        }
+    }
+
+    size_t mask = m_slots.size() - 1;
+    size_t i = SlotIndex(fingerprint, mask);
+    while (m_slots[i].fingerprint != 0) {
+        i = (i + 1) & mask;
+    }
+    m_slots[i] = Slot{fingerprint, location};
+    ++m_count;
+}
+
+void ColdStore::RemoveSlot(size_t hole) {
+    // Backward-shift deletion keeps every probe sequence unbroken
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = (hole + 1) & mask; m_slots[i].fingerprint != 0; i = (i + 1) & mask) {
+        size_t home = SlotIndex(m_slots[i].fingerprint, mask);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            m_slots[hole] = m_slots[i];
+            hole = i;
+        }
+    }
+    m_slots[hole] = Slot{0, 0};
+    --m_count;
+}
+
+const char* ColdStore::ReadRecord(uint32_t location, std::shared_ptr<const std::string>& block) {
+    uint32_t index = location >> RECORD_BITS;
+    const char* record;
+    if (index == m_blocks.size()) {
+        record = m_open.data();
+    } else {
+        block = ReadBlock(index);
+        if (!block) {
+            return nullptr;
+        }
+        record = block->data();
+    }
+
+    // Records are located by position; skip the ones before
+    for (uint32_t i = location & (MAX_BLOCK_RECORDS - 1); i > 0; --i) {
+        record = RecordEnd(record);
+    }
+    return record;
+}
+
+void ColdStore::Seal() {
+    if (m_openLive == 0) {
+        // Every record was taken again before the block filled
+        m_deadBytes -= m_open.size();
+        m_open.clear();
+        m_openRecords = 0;
+        return;
+    }
+
+    if (!m_dictionary) {
+        TrainDictionary();
+    }
+
+    // Raw deflate: the records carry their own lengths, no header needed
+    z_stream stream = {};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    if (!m_dictionary->empty()) {
+        deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(m_dictionary->data()),
+                             static_cast<uInt>(m_dictionary->size()));
+    }
+
+    auto data = std::make_shared<std::string>();
+    data->resize(deflateBound(&stream, static_cast<uLong>(m_open.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(m_open.data());
+    stream.avail_in = static_cast<uInt>(m_open.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&(*data)[0]);
+    stream.avail_out = static_cast<uInt>(data->size());
+    deflate(&stream, Z_FINISH);
+    data->resize(stream.total_out);
+    data->shrink_to_fit();
+    deflateEnd(&stream);
+
+    m_blocks.push_back(Block{std::move(data), static_cast<uint32_t>(m_open.size()), m_openLive});
+    m_open.clear();
+    m_openRecords = 0;
+    m_openLive = 0;
+}
+
+void ColdStore::TrainDictionary() {
+    // Responses repeat across keys far more than keys do; count them
+    std::unordered_map<std::string_view, size_t> counts;
+    std::string_view key;
+    std::vector<std::string_view> responses;
+    for (const char* pos = m_open.data(); pos < m_open.data() + m_open.size();) {
+        responses.clear();
+        pos = ParseRecord(pos, key, responses);
+        for (std::string_view response : responses) {
+            ++counts[response];
+        }
+    }
+
+    std::vector<std::pair<std::string_view, size_t>> ranked(counts.begin(), counts.end());
+    std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+        return a.second * a.first.size() > b.second * b.first.size();
+    });
+
+    // The most valuable strings go last, closest to the data, where
+    // matches are cheapest to encode
+    std::vector<std::string_view> chosen;
+    size_t bytes = 0;
+    for (const auto& item : ranked) {
+        if (bytes + item.first.size() > DICTIONARY_BYTES) {
+            continue;
+        }
+        chosen.push_back(item.first);
+        bytes += item.first.size();
+    }
+
+    auto dictionary = std::make_shared<std::string>();
+    dictionary->reserve(bytes);
+    for (auto it = chosen.rbegin(); it != chosen.rend(); ++it) {
+        dictionary->append(it->data(), it->size());
+    }
+    m_dictionary = std::move(dictionary);
+}
+
+std::shared_ptr<const std::string> ColdStore::ReadBlock(uint32_t block) {
+    for (size_t i = 0; i < m_cache.size(); ++i) {
+        if (m_cache[i].first == block) {
+            std::rotate(m_cache.begin(), m_cache.begin() + static_cast<std::ptrdiff_t>(i),
+                        m_cache.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+            return m_cache.front().second;
+        }
+    }
+
+    std::shared_ptr<const std::string> raw = Inflate(m_blocks[block]);
+    if (raw) {
+        if (m_cache.size() == CACHE_BLOCKS) {
+            m_cache.pop_back();
+        }
+        m_cache.insert(m_cache.begin(), {block, raw});
+    }
+    return raw;
+}
+
+std::shared_ptr<const std::string> ColdStore::Inflate(const Block& block) const {
+    z_stream stream = {};
+    inflateInit2(&stream, -15);
+    if (m_dictionary && !m_dictionary->empty()) {
+        inflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(m_dictionary->data()),
+                             static_cast<uInt>(m_dictionary->size()));
+    }
+
+    auto raw = std::make_shared<std::string>(block.rawSize, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.data->data()));
+    stream.avail_in = static_cast<uInt>(block.data->size());
+    stream.next_out = reinterpret_cast<Bytef*>(&(*raw)[0]);
+    stream.avail_out = block.rawSize;
+    int result = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+
+    if (result != Z_STREAM_END || stream.total_out != block.rawSize) {
+        LoggingService::GetInstance().Log(
+            LogLevel::ERROR,
+            "Failed to inflate a cold memory block: zlib error " + std::to_string(result));
+        return nullptr;
+    }
+    return raw;
+}
+
+void ColdStore::Forget(uint32_t location, size_t size) {
+    m_liveBytes -= size;
+    m_deadBytes += size;
+
+    uint32_t index = location >> RECORD_BITS;
+    if (index == m_blocks.size()) {
+        if (--m_openLive == 0) {
+            m_deadBytes -= m_open.size();
+            m_open.clear();
+            m_openRecords = 0;
+        }
+        return;
+    }
+
+    Block& block = m_blocks[index];
+    if (--block.liveRecords == 0) {
+        m_deadBytes -= block.rawSize;
+        block.data.reset();
+        ++m_emptyBlocks;
+        m_cache.erase(std::remove_if(m_cache.begin(), m_cache.end(),
+                                     [index](const auto& item) { return item.first == index; }),
+                      m_cache.end());
+    }
+}
+
+void ColdStore::CompactIfNeeded() {
+    bool mostlyDead = m_deadBytes > m_liveBytes && m_deadBytes >= 4 * BLOCK_BYTES;
+    bool mostlyEmpty = m_emptyBlocks >= 64 && m_emptyBlocks * 2 > m_blocks.size();
+    if (!mostlyDead && !mostlyEmpty) {
+        return;
+    }
+
+    // Rewrite the live records, keeping the trained dictionary
+    ColdStore compacted;
+    compacted.m_dictionary = m_dictionary;
+    ForEach([&compacted](std::string_view key, const std::vector<std::string_view>& responses) {
+        compacted.Add(LearningMemory::HashKey(key), key, responses);
+    });
+    *this = std::move(compacted);
+}
+
+const char* ColdStore::ParseRecord(const char* data, std::string_view& key,
+                                   std::vector<std::string_view>& responses) {
+    uint32_t keyLength = GetUint32(data);
+    uint32_t count = GetUint32(data + sizeof(uint32_t));
+    data += 2 * sizeof(uint32_t);
+    key = std::string_view(data, keyLength);
+    data += keyLength;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t length = GetUint32(data);
+        data += sizeof(uint32_t);
+        responses.emplace_back(data, length);
+        data += length;
+    }
+    return data;
+}
+
+const char* ColdStore::RecordEnd(const char* data) {
+    uint32_t count = GetUint32(data + sizeof(uint32_t));
+    data += 2 * sizeof(uint32_t) + GetUint32(data);
+    for (uint32_t i = 0; i < count; ++i) {
+        data += sizeof(uint32_t) + GetUint32(data);
+    }
+    return data;
+}
+
+std::string_view ColdStore::RecordKey(const char* data) {
+    return std::string_view(data + 2 * sizeof(uint32_t), GetUint32(data));
+}
+
+} // namespace ai_framework
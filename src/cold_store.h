@@ -0,0 +1,274 @@
+// cold_store.h
+#ifndef AI_FRAMEWORK_COLD_STORE_H
+#define AI_FRAMEWORK_COLD_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief Compressed storage for rarely used keys and their responses
+ *
+ * Records are appended to an open block and, once it reaches BLOCK_BYTES,
+ * the block is deflated as a whole. All blocks share a preset dictionary
+ * trained on the responses of the first block, so strings repeated across
+ * keys compress even when they do not repeat within a block. Reading a
+ * record inflates its block; the last CACHE_BLOCKS inflated blocks are
+ * kept, so neighbouring records are read without inflating again.
+ *
+ * The index is an open-addressed table of 8-byte slots holding a 32-bit
+ * fingerprint of the key hash and the record's block and position, so a
+ * small record is not outweighed by its index entry. Reads confirm the
+ * full hash against the stored key.
+ *
+ * Records are immutable: Take removes a record and the space it held is
+ * reclaimed when its block empties or the store is compacted. Sealed
+ * blocks are shared between copies. Not thread-safe.
+ */
+class ColdStore {
+public:
+    /** Uncompressed bytes collected before a block is deflated */
+    static constexpr size_t BLOCK_BYTES = 16 * 1024;
+
+    /** Records per block, limited by the slot layout */
+    static constexpr size_t MAX_BLOCK_RECORDS = 4096;
+
+    /** Inflated blocks kept for further reads */
+    static constexpr size_t CACHE_BLOCKS = 2;
+
+    /** Largest preset dictionary, the deflate window */
+    static constexpr size_t DICTIONARY_BYTES = 32 * 1024;
+
+    /**
+     * @brief Store a key with its responses, replacing any stored record
+     *
+     * @param hash Key hash, see LearningMemory::HashKey
+     * @param key Key string
+     * @param responses Responses, oldest first
+     */
+    void Add(uint64_t hash, std::string_view key, const std::vector<std::string_view>& responses);
+
+    /**
+     * @brief Check whether a key may be stored, without reading any block
+     *
+     * Only fingerprints are compared, so a key that is not stored is
+     * reported with a probability of about GetKeyCount() / 2^32; Take
+     * then returns false.
+     *
+     * @param hash Key hash
+     * @return bool False if the key is certainly not stored
+     */
+    bool Contains(uint64_t hash) const;
+
+    /**
+     * @brief Remove a key and return its record
+     *
+     * @param hash Key hash
+     * @param key Receives the key string
+     * @param responses Receives the responses, oldest first
+     * @return bool True if the key was stored
+     */
+    bool Take(uint64_t hash, std::string& key, std::vector<std::string>& responses);
+
+    /**
+     * @brief Remove a key
+     *
+     * @param hash Key hash
+     * @return bool True if the key was stored
+     */
+    bool Erase(uint64_t hash);
+
+    /**
+     * @brief Visit every stored key with its responses
+     *
+     * Each block is inflated once, without touching the cache.
+     *
+     * @param visit Called once per key
+     */
+    void ForEach(const std::function<void(std::string_view key,
+                                          const std::vector<std::string_view>& responses)>& visit) const;
+
+    /**
+     * @brief Remove every key and the dictionary
+     */
+    void Clear();
+
+    /**
+     * @brief Get the number of stored keys
+     *
+     * @return size_t Number of keys
+     */
+    size_t GetKeyCount() const {
+        return m_count;
+    }
+
+    /**
+     * @brief Get the uncompressed size of the stored records
+     *
+     * @return size_t Bytes of live records
+     */
+    size_t GetRawBytes() const {
+        return m_liveBytes;
+    }
+
+    /**
+     * @brief Get the bytes held: compressed blocks, the open block, the
+     *        dictionary, the cache and the index
+     *
+     * @return size_t Allocated bytes
+     */
+    size_t GetMemoryBytes() const;
+
+private:
+    /**
+     * @brief Index slot; fingerprint 0 marks an empty slot
+     *
+     * The location is the block index shifted left by RECORD_BITS plus the
+     * record's position in the block; block m_blocks.size() is the open one.
+     */
+    struct Slot {
+        uint32_t fingerprint;
+        uint32_t location;
+    };
+
+    struct Block {
+        /** Deflated records, released once no record is live */
+        std::shared_ptr<const std::string> data;
+
+        /** Size of the records before deflating */
+        uint32_t rawSize;
+
+        /** Records not yet taken */
+        uint32_t liveRecords;
+    };
+
+    static constexpr unsigned RECORD_BITS = 12;
+    static constexpr size_t NO_SLOT = SIZE_MAX;
+
+    static uint32_t Fingerprint(uint64_t hash) {
+        uint32_t fingerprint = static_cast<uint32_t>(hash);
+        return fingerprint != 0 ? fingerprint : 1;
+    }
+
+    /**
+     * @brief Find the slot of a key, confirming the full hash
+     *
+     * @param block Keeps the record's inflated block alive
+     * @param record Receives the start of the record
+     * @return size_t Slot index, NO_SLOT if the key is not stored
+     */
+    size_t FindSlot(uint64_t hash, std::shared_ptr<const std::string>& block, const char*& record);
+
+    /**
+     * @brief Find the slot pointing at a location
+     *
+     * @return size_t Slot index, NO_SLOT if no key refers to the location
+     */
+    size_t FindLocation(uint32_t fingerprint, uint32_t location) const;
+
+    /**
+     * @brief Index a record
+     */
+    void InsertSlot(uint32_t fingerprint, uint32_t location);
+
+    /**
+     * @brief Unindex the record of a slot, shifting later slots back
+     */
+    void RemoveSlot(size_t slot);
+
+    /**
+     * @brief Get the start of the record at a location
+     *
+     * @param block Keeps an inflated block alive while the record is used
+     * @return const char* Record, null if its block cannot be inflated
+     */
+    const char* ReadRecord(uint32_t location, std::shared_ptr<const std::string>& block);
+
+    /**
+     * @brief Deflate the open block and start a new one
+     */
+    void Seal();
+
+    /**
+     * @brief Choose the preset dictionary from the open block's responses
+     */
+    void TrainDictionary();
+
+    /**
+     * @brief Get the uncompressed records of a block, through the cache
+     */
+    std::shared_ptr<const std::string> ReadBlock(uint32_t block);
+
+    /**
+     * @brief Inflate a sealed block
+     */
+    std::shared_ptr<const std::string> Inflate(const Block& block) const;
+
+    /**
+     * @brief Mark a record of a given size dead
+     */
+    void Forget(uint32_t location, size_t size);
+
+    /**
+     * @brief Rewrite the live records once dead ones or empty blocks dominate
+     */
+    void CompactIfNeeded();
+
+    /**
+     * @brief Parse a record; the views point into data
+     *
+     * @return const char* End of the record
+     */
+    static const char* ParseRecord(const char* data, std::string_view& key,
+                                   std::vector<std::string_view>& responses);
+
+    /**
+     * @brief Get the end of a record without parsing its responses
+     */
+    static const char* RecordEnd(const char* data);
+
+    /**
+     * @brief Get the key of a record
+     */
+    static std::string_view RecordKey(const char* data);
+
+    /** Sealed blocks */
+    std::vector<Block> m_blocks;
+
+    /** Sealed blocks whose records were all taken */
+    size_t m_emptyBlocks = 0;
+
+    /** Records not yet deflated */
+    std::string m_open;
+
+    /** Records in m_open, and how many of them are live */
+    uint32_t m_openRecords = 0;
+    uint32_t m_openLive = 0;
+
+    /** Location of every stored key; a power of two in size */
+    std::vector<Slot> m_slots;
+
+    /** Stored keys */
+    size_t m_count = 0;
+
+    /** Preset dictionary shared by all blocks, null until the first Seal */
+    std::shared_ptr<const std::string> m_dictionary;
+
+    /** Recently inflated blocks, most recent first */
+    std::vector<std::pair<uint32_t, std::shared_ptr<const std::string>>> m_cache;
+
+    /** Uncompressed bytes of live and of taken records in non-empty blocks */
+    size_t m_liveBytes = 0;
+    size_t m_deadBytes = 0;
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_COLD_STORE_H
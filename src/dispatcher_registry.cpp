@@ -0,0 +1,188 @@
+// dispatcher_registry.cpp
+#include "dispatcher_registry.h"
+#include "logging_service.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace ai_framework {
+
+DispatcherRegistry::DispatcherRegistry(so_5::environment_t& env)
+    : m_env(env) {
+    auto binding = std::make_shared<Binding>();
+    binding->name = DEFAULT_NAME;
+    binding->type = DEFAULT_NAME;
+    m_bindings[binding->name] = binding;
+}
+
+bool DispatcherRegistry::Configure(const std::string& config) {
+    try {
+        nlohmann::json configJson = nlohmann::json::parse(config);
+        if (!configJson.contains("dispatchers")) {
+            return true;
+        }
+
+        struct Pending {
+            std::string name;
+            std::string type;
+            size_t threads;
+            bool create;
+            std::vector<std::string> agentTypes;
+        };
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Check every entry before touching the registry, so a bad entry
+        // leaves no dispatcher or type binding from the others behind
+        std::vector<Pending> pending;
+        for (const auto& item : configJson["dispatchers"].items()) {
+            const std::string& name = item.key();
+            const nlohmann::json& dispatcher = item.value();
+            std::string type = dispatcher.value("type", std::string("one_thread"));
+            bool pool = type == "thread_pool" || type == "adv_thread_pool";
+
+            if (!pool && type != "one_thread" && type != "active_obj") {
+                LoggingService::GetInstance().Log(
+                    LogLevel::ERROR,
+                    "Unknown dispatcher type for " + name + ": " + type);
+                return false;
+            }
+            if (!pool && dispatcher.contains("threads")) {
+                LoggingService::GetInstance().Log(
+                    LogLevel::ERROR,
+                    "Dispatcher " + name + " is " + type +
+                    " and does not take a thread count");
+                return false;
+            }
+
+            auto existing = m_bindings.find(name);
+            if (existing != m_bindings.end() && existing->second->type != type) {
+                LoggingService::GetInstance().Log(
+                    LogLevel::ERROR,
+                    "Dispatcher " + name + " already exists as " + existing->second->type);
+                return false;
+            }
+
+            // A running pool cannot be resized
+            if (existing != m_bindings.end() && pool && dispatcher.contains("threads") &&
+                dispatcher["threads"].get<size_t>() != existing->second->threads) {
+                LoggingService::GetInstance().Log(
+                    LogLevel::ERROR,
+                    "Dispatcher " + name + " already runs " +
+                    std::to_string(existing->second->threads) + " threads");
+                return false;
+            }
+
+            // Pools default to one thread per core
+            size_t threads = pool ?
+                dispatcher.value("threads", static_cast<size_t>(
+                    std::max(1u, std::thread::hardware_concurrency()))) : 1;
+            if (threads == 0) {
+                LoggingService::GetInstance().Log(
+                    LogLevel::ERROR,
+                    "Dispatcher " + name + " needs at least one thread");
+                return false;
+            }
+
+            std::vector<std::string> agentTypes;
+            if (dispatcher.contains("agent_types")) {
+                agentTypes = dispatcher["agent_types"].get<std::vector<std::string>>();
+            }
+
+            pending.push_back({name, type, threads, existing == m_bindings.end(),
+                               std::move(agentTypes)});
+        }
+
+        for (const Pending& entry : pending) {
+            if (entry.create) {
+                auto binding = std::make_shared<Binding>();
+                binding->name = entry.name;
+                binding->type = entry.type;
+                binding->threads = entry.threads;
+                binding->binder = MakeBinder(entry.name, entry.type, entry.threads);
+                m_bindings[entry.name] = binding;
+
+                LoggingService::GetInstance().Log(
+                    LogLevel::INFO,
+                    "Started " + entry.type + " dispatcher " + entry.name + " with " +
+                    std::to_string(entry.threads) + " threads");
+            }
+
+            for (const std::string& agentType : entry.agentTypes) {
+                m_typeBindings[agentType] = entry.name;
+            }
+        }
+
+        return true;
+    } catch (const std::exception& e) {
+        LoggingService::GetInstance().Log(
+            LogLevel::ERROR,
+            "Failed to configure dispatchers: " + std::string(e.what()));
+        return false;
+    }
+}
+
+std::shared_ptr<DispatcherRegistry::Binding> DispatcherRegistry::Resolve(
+    const std::string& agentType,
+    const std::string& dispatcher) const {
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // The agent's own choice wins over its type's
+    std::string name = dispatcher;
+    if (name.empty()) {
+        auto type = m_typeBindings.find(agentType);
+        name = type != m_typeBindings.end() ? type->second : DEFAULT_NAME;
+    }
+
+    auto it = m_bindings.find(name);
+    return it != m_bindings.end() ? it->second : nullptr;
+}
+
+std::vector<DispatcherStats> DispatcherRegistry::GetStats() const {
+    std::vector<DispatcherStats> stats;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stats.reserve(m_bindings.size());
+    for (const auto& pair : m_bindings) {
+        const Binding& binding = *pair.second;
+        size_t agents = binding.agents.load(std::memory_order_relaxed);
+        stats.push_back({
+            binding.name,
+            binding.type,
+            binding.type == "active_obj" ? agents : binding.threads,
+            agents,
+            binding.queueDepth.load(std::memory_order_relaxed),
+            binding.delivered.load(std::memory_order_relaxed)
+        });
+    }
+    return stats;
+}
+
+so_5::disp_binder_shptr_t DispatcherRegistry::MakeBinder(
+    const std::string& name,
+    const std::string& type,
+    size_t threads) {
+
+    if (type == "one_thread") {
+        return so_5::disp::one_thread::make_dispatcher(m_env, name).binder();
+    }
+    if (type == "active_obj") {
+        return so_5::disp::active_obj::make_dispatcher(m_env, name).binder();
+    }
+    if (type == "thread_pool") {
+        namespace tp = so_5::disp::thread_pool;
+        return tp::make_dispatcher(m_env, name, threads).binder(
+            tp::bind_params_t{}.fifo(tp::fifo_t::individual));
+    }
+    if (type == "adv_thread_pool") {
+        namespace atp = so_5::disp::adv_thread_pool;
+        return atp::make_dispatcher(m_env, name, threads).binder(
+            atp::bind_params_t{}.fifo(atp::fifo_t::individual));
+    }
+    return nullptr;
+}
+
+} // namespace ai_framework
@@ -0,0 +1,143 @@
+// dispatcher_registry.h
+#ifndef AI_FRAMEWORK_DISPATCHER_REGISTRY_H
+#define AI_FRAMEWORK_DISPATCHER_REGISTRY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <so_5/all.hpp>
+
+namespace ai_framework {
+
+/**
+ * @brief Counters of one dispatcher binding
+ */
+struct DispatcherStats {
+    /** Name of the binding */
+    std::string name;
+
+    /** Dispatcher type: default, one_thread, active_obj, thread_pool or adv_thread_pool */
+    std::string type;
+
+    /** Worker threads; for active_obj, one per agent */
+    size_t threads;
+
+    /** Agents bound to the dispatcher */
+    size_t agents;
+
+    /** Messages posted to those agents and not yet answered */
+    size_t queueDepth;
+
+    /** Messages answered */
+    uint64_t delivered;
+};
+
+/**
+ * @brief Named SObjectizer dispatchers that agents are bound to
+ *
+ * The configuration names dispatchers and the agent types each one serves:
+ *
+ *     "dispatchers": {
+ *         "learners": {"type": "thread_pool", "threads": 8, "agent_types": ["learning"]},
+ *         "rules": {"type": "one_thread", "agent_types": ["rule_based"]}
+ *     }
+ *
+ * An agent whose own configuration has "dispatcher": "<name>" is bound to
+ * that dispatcher instead. Everything else runs on the environment's default
+ * dispatcher, under the name "default".
+ *
+ * one_thread runs all its agents on one thread; active_obj gives each agent
+ * a thread of its own; thread_pool shares its threads between agents, each
+ * handling one message at a time; adv_thread_pool also runs thread-safe
+ * handlers of one agent on several threads at once.
+ */
+class DispatcherRegistry {
+public:
+    /**
+     * @brief A dispatcher with the counters of the agents bound to it
+     */
+    struct Binding {
+        std::string name;
+        std::string type;
+        size_t threads = 1;
+
+        /** Binds a coop's agents; null for the default dispatcher */
+        so_5::disp_binder_shptr_t binder;
+
+        std::atomic<size_t> agents{0};
+        std::atomic<size_t> queueDepth{0};
+        std::atomic<uint64_t> delivered{0};
+    };
+
+    /** Name of the environment's default dispatcher */
+    static constexpr const char* DEFAULT_NAME = "default";
+
+    /**
+     * @brief Constructor for DispatcherRegistry
+     *
+     * @param env Environment the dispatchers are created in
+     */
+    explicit DispatcherRegistry(so_5::environment_t& env);
+
+    /**
+     * @brief Create the dispatchers listed under "dispatchers"
+     *
+     * Dispatchers that already exist keep running; a name configured again
+     * must have the same type, and a pool the same "threads" count if one
+     * is given, as running pools cannot be resized. Only pools take a
+     * "threads" count. Every entry is checked first, so an invalid one
+     * leaves the registry as it was.
+     *
+     * @param config JSON configuration
+     * @return bool True if every dispatcher was valid and created
+     */
+    bool Configure(const std::string& config);
+
+    /**
+     * @brief Find the binding of an agent
+     *
+     * @param agentType Type of the agent
+     * @param dispatcher Dispatcher named in the agent's configuration, or empty
+     * @return std::shared_ptr<Binding> The binding, or null if the named
+     *         dispatcher does not exist
+     */
+    std::shared_ptr<Binding> Resolve(const std::string& agentType,
+                                     const std::string& dispatcher) const;
+
+    /**
+     * @brief Get the counters of every binding
+     *
+     * @return std::vector<DispatcherStats> One entry per binding, by name
+     */
+    std::vector<DispatcherStats> GetStats() const;
+
+private:
+    /**
+     * @brief Start a dispatcher
+     *
+     * @return so_5::disp_binder_shptr_t Its binder, or null if the type is unknown
+     */
+    so_5::disp_binder_shptr_t MakeBinder(const std::string& name, const std::string& type,
+                                         size_t threads);
+
+    /** Environment the dispatchers run in */
+    so_5::environment_t& m_env;
+
+    /** Mutex guarding the maps */
+    mutable std::mutex m_mutex;
+
+    /** Bindings by name */
+    std::map<std::string, std::shared_ptr<Binding>> m_bindings;
+
+    /** Binding name by agent type */
+    std::map<std::string, std::string> m_typeBindings;
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_DISPATCHER_REGISTRY_H
@@ -0,0 +1,345 @@
+// feature_index.cpp
+#include "feature_index.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define AI_FRAMEWORK_FEATURE_INDEX_SSE2 1
+#endif
+
+namespace ai_framework {
+
+void FeatureIndex::PostingList::Append(uint32_t id) {
+    if (count % BLOCK_SIZE == 0) {
+        blockFirst.push_back(id);
+        blockOffset.push_back(static_cast<uint32_t>(bytes.size()));
+    }
+    else {
+        // Varint delta, seven bits per byte
+        uint32_t delta = id - last;
+        while (delta >= 0x80) {
+            bytes.push_back(static_cast<uint8_t>(delta | 0x80));
+            delta >>= 7;
+        }
+        bytes.push_back(static_cast<uint8_t>(delta));
+    }
+    last = id;
+    ++count;
+}
+
+size_t FeatureIndex::PostingList::DecodeBlock(size_t block, uint32_t* out) const {
+    size_t n = std::min<size_t>(BLOCK_SIZE, count - block * BLOCK_SIZE);
+    const uint8_t* p = bytes.data() + blockOffset[block];
+    uint32_t id = blockFirst[block];
+    out[0] = id;
+    for (size_t i = 1; i < n; ++i) {
+        uint32_t delta = 0;
+        unsigned shift = 0;
+        uint8_t byte;
+        do {
+            byte = *p++;
+            delta |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        id += delta;
+        out[i] = id;
+    }
+    return n;
+}
+
+namespace {
+
+/** Bytes of an entry of a node-based hash map, beyond the value */
+constexpr size_t MAP_NODE_BYTES = 2 * sizeof(void*);
+
+} // namespace
+
+bool FeatureIndex::AddKey(uint64_t hash, std::string_view key) {
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        if (m_docIds.count(hash) != 0) {
+            return false;
+        }
+    }
+
+    // A token repeated within the key is indexed once
+    TokenDictionary& dictionary = TokenDictionary::GetInstance();
+    std::vector<TokenDictionary::Id> tokens;
+    size_t start = 0;
+    while (start <= key.size()) {
+        size_t end = std::min(key.find('_', start), key.size());
+        if (end > start) {
+            tokens.push_back(dictionary.Intern(key.substr(start, end - start)));
+        }
+        start = end + 1;
+    }
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    uint32_t id = static_cast<uint32_t>(m_keyHashes.size());
+    if (!m_docIds.emplace(hash, id).second) {
+        return false;
+    }
+    m_keyHashes.push_back(hash);
+    m_removed.push_back(false);
+    m_memoryBytes += sizeof(uint64_t) + sizeof(std::pair<const uint64_t, uint32_t>) + MAP_NODE_BYTES;
+    for (TokenDictionary::Id token : tokens) {
+        auto inserted = m_postings.try_emplace(token);
+        PostingList& list = inserted.first->second;
+        size_t before = ListBytes(list);
+        list.Append(id);
+        m_memoryBytes += ListBytes(list) - before;
+        if (inserted.second) {
+            m_memoryBytes += sizeof(*inserted.first) + MAP_NODE_BYTES;
+        }
+    }
+    return true;
+}
+
+bool FeatureIndex::RemoveKey(uint64_t hash) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_docIds.find(hash);
+    if (it == m_docIds.end()) {
+        return false;
+    }
+    m_removed[it->second] = true;
+    m_docIds.erase(it);
+    m_memoryBytes -= sizeof(std::pair<const uint64_t, uint32_t>) + MAP_NODE_BYTES;
+
+    // Rebuilding costs a pass over every list; wait until it halves them
+    size_t dead = m_keyHashes.size() - m_docIds.size();
+    if (dead >= BLOCK_SIZE && dead > m_docIds.size()) {
+        Compact();
+    }
+    return true;
+}
+
+void FeatureIndex::Compact() {
+    // Live ids keep their order, so newer keys still have higher ids
+    std::vector<uint32_t> newIds(m_keyHashes.size());
+    std::vector<uint64_t> keyHashes;
+    keyHashes.reserve(m_docIds.size());
+    for (size_t id = 0; id < m_keyHashes.size(); ++id) {
+        if (!m_removed[id]) {
+            newIds[id] = static_cast<uint32_t>(keyHashes.size());
+            m_docIds[m_keyHashes[id]] = newIds[id];
+            keyHashes.push_back(m_keyHashes[id]);
+        }
+    }
+
+    std::unordered_map<TokenDictionary::Id, PostingList> postings;
+    size_t bytes = keyHashes.size() *
+        (sizeof(uint64_t) + sizeof(std::pair<const uint64_t, uint32_t>) + MAP_NODE_BYTES);
+    uint32_t block[BLOCK_SIZE];
+    for (const auto& item : m_postings) {
+        const PostingList& list = item.second;
+        PostingList live;
+        for (size_t b = 0; b < list.blockFirst.size(); ++b) {
+            size_t n = list.DecodeBlock(b, block);
+            for (size_t i = 0; i < n; ++i) {
+                if (!m_removed[block[i]]) {
+                    live.Append(newIds[block[i]]);
+                }
+            }
+        }
+        if (live.count > 0) {
+            bytes += ListBytes(live) + sizeof(item) + MAP_NODE_BYTES;
+            postings.emplace(item.first, std::move(live));
+        }
+    }
+
+    m_postings.swap(postings);
+    m_keyHashes.swap(keyHashes);
+    m_removed.assign(m_keyHashes.size(), false);
+    m_memoryBytes = bytes;
+}
+
+std::vector<ScoredKey> FeatureIndex::Search(const std::vector<std::string_view>& tokens, size_t k) const {
+    // A token the dictionary does not know is in no key
+    TokenDictionary& dictionary = TokenDictionary::GetInstance();
+    std::vector<TokenDictionary::Id> ids;
+    ids.reserve(tokens.size());
+    for (std::string_view token : tokens) {
+        ids.push_back(dictionary.Find(token));
+    }
+    return SearchIds(std::move(ids), k);
+}
+
+std::vector<ScoredKey> FeatureIndex::SearchIds(std::vector<TokenDictionary::Id> tokens, size_t k) const {
+    std::vector<ScoredKey> results;
+    if (k == 0) {
+        return results;
+    }
+
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+    // Rarest, most informative tokens first
+    std::vector<const PostingList*> lists;
+    for (TokenDictionary::Id token : tokens) {
+        auto it = m_postings.find(token);
+        if (it != m_postings.end()) {
+            lists.push_back(&it->second);
+        }
+    }
+    if (lists.empty()) {
+        return results;
+    }
+    std::sort(lists.begin(), lists.end(), [](const PostingList* a, const PostingList* b) {
+        return a->count < b->count;
+    });
+
+    // Candidates come from the rarest lists; a list too long to take whole
+    // contributes its newest keys
+    std::vector<uint32_t> candidates;
+    uint32_t block[BLOCK_SIZE];
+    for (const PostingList* list : lists) {
+        if (candidates.size() + list->count <= MAX_CANDIDATES) {
+            for (size_t b = 0; b < list->blockFirst.size(); ++b) {
+                size_t n = list->DecodeBlock(b, block);
+                candidates.insert(candidates.end(), block, block + n);
+            }
+            continue;
+        }
+        if (candidates.empty()) {
+            size_t blocks = MAX_CANDIDATES / BLOCK_SIZE;
+            for (size_t b = list->blockFirst.size() - std::min(blocks, list->blockFirst.size());
+                 b < list->blockFirst.size(); ++b) {
+                size_t n = list->DecodeBlock(b, block);
+                candidates.insert(candidates.end(), block, block + n);
+            }
+        }
+        break;
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                    [this](uint32_t id) { return m_removed[id]; }),
+                     candidates.end());
+
+    // Score every candidate against every query token
+    std::vector<float> scores(candidates.size(), 0.0f);
+    double keyCount = static_cast<double>(m_docIds.size());
+    for (const PostingList* list : lists) {
+        float weight = static_cast<float>(std::log(1.0 + keyCount / list->count));
+        ScoreList(candidates, *list, weight, scores);
+    }
+
+    std::vector<size_t> order(candidates.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    size_t count = std::min(k, order.size());
+    std::partial_sort(order.begin(), order.begin() + count, order.end(),
+                      [&scores, &candidates](size_t a, size_t b) {
+                          return scores[a] != scores[b] ? scores[a] > scores[b] :
+                                                          candidates[a] > candidates[b];
+                      });
+
+    results.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        results.push_back(ScoredKey{m_keyHashes[candidates[order[i]]], scores[order[i]]});
+    }
+    return results;
+}
+
+void FeatureIndex::ScoreList(const std::vector<uint32_t>& candidates, const PostingList& list,
+                             float weight, std::vector<float>& scores) {
+    uint32_t ids[BLOCK_SIZE];
+    size_t pos = 0;
+    while (pos < candidates.size()) {
+        // Block that could hold the next candidate, found in the skip table
+        auto next = std::upper_bound(list.blockFirst.begin(), list.blockFirst.end(), candidates[pos]);
+        if (next == list.blockFirst.begin()) {
+            pos = static_cast<size_t>(
+                std::lower_bound(candidates.begin() + pos, candidates.end(), list.blockFirst.front()) -
+                candidates.begin());
+            continue;
+        }
+        size_t b = static_cast<size_t>(next - list.blockFirst.begin()) - 1;
+
+        // Candidates below the next block's first id
+        size_t end = next == list.blockFirst.end() ? candidates.size() :
+            static_cast<size_t>(std::lower_bound(candidates.begin() + pos, candidates.end(), *next) -
+                                candidates.begin());
+
+        size_t n = list.DecodeBlock(b, ids);
+        ScoreBlock(candidates.data() + pos, end - pos, ids, n, weight, scores.data() + pos);
+        pos = end;
+    }
+}
+
+void FeatureIndex::ScoreBlock(const uint32_t* candidates, size_t candidateCount,
+                              const uint32_t* ids, size_t idCount,
+                              float weight, float* scores) {
+    size_t i = 0;
+    size_t j = 0;
+
+#ifdef AI_FRAMEWORK_FEATURE_INDEX_SSE2
+    // Compare four candidates with four ids in every rotation; ids are
+    // unique, so each candidate matches at most once
+    while (i + 4 <= candidateCount && j + 4 <= idCount) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(candidates + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ids + j));
+        __m128i match = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(a, b),
+                         _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(1, 0, 3, 2))),
+                         _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 1, 0, 3)))));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(match));
+        while (mask != 0) {
+            scores[i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)))] += weight;
+            mask &= mask - 1;
+        }
+
+        uint32_t lastCandidate = candidates[i + 3];
+        uint32_t lastId = ids[j + 3];
+        if (lastCandidate <= lastId) {
+            i += 4;
+        }
+        if (lastId <= lastCandidate) {
+            j += 4;
+        }
+    }
+#endif
+
+    while (i < candidateCount && j < idCount) {
+        if (candidates[i] < ids[j]) {
+            ++i;
+        }
+        else if (ids[j] < candidates[i]) {
+            ++j;
+        }
+        else {
+            scores[i] += weight;
+            ++i;
+            ++j;
+        }
+    }
+}
+
+void FeatureIndex::Clear() {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_postings.clear();
+    m_keyHashes.clear();
+    m_removed.clear();
+    m_docIds.clear();
+    m_memoryBytes = 0;
+}
+
+size_t FeatureIndex::GetKeyCount() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_docIds.size();
+}
+
+size_t FeatureIndex::GetMemoryBytes() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_memoryBytes;
+}
+
+} // namespace ai_framework
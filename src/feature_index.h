@@ -0,0 +1,200 @@
+// feature_index.h
+#ifndef AI_FRAMEWORK_FEATURE_INDEX_H
+#define AI_FRAMEWORK_FEATURE_INDEX_H
+
+#include "token_dictionary.h"
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief Key found by FeatureIndex::Search
+ */
+struct ScoredKey {
+    /** Hash of the memory key */
+    uint64_t hash;
+
+    /** Sum of the IDF weights of the query tokens the key contains */
+    float score;
+};
+
+/**
+ * @brief Inverted index from tokens to LearningMemory keys
+ *
+ * Each key gets a document id in insertion order, and each token a posting
+ * list of the ids of the keys containing it, found by the token's
+ * TokenDictionary id. Posting lists are split into
+ * blocks of BLOCK_SIZE ids; a block stores its first id in a skip table and
+ * the rest as varint deltas, so a list costs about one byte per id and a
+ * search decodes only the blocks its candidates fall into.
+ *
+ * A search takes candidates from the rarest query tokens, at most
+ * MAX_CANDIDATES of them, and scores them by intersecting with the posting
+ * list of every query token (four ids at a time where SSE2 is available).
+ * Work per search is therefore bounded by the candidate limit, not by the
+ * number of keys. Thread-safe; searches run in parallel.
+ *
+ * A key is indexed once however often it is added. A removed key keeps its
+ * ids in the posting lists until the dead ids outnumber the live ones; the
+ * lists are then rebuilt without them, so they stay within twice the size
+ * the live keys need. Its tokens stay in the TokenDictionary, which never
+ * gives ids back and charges its own growth to the MemoryBudget.
+ */
+class FeatureIndex {
+public:
+    /** Ids per posting block */
+    static constexpr size_t BLOCK_SIZE = 128;
+
+    /** Candidates scored per search */
+    static constexpr size_t MAX_CANDIDATES = 4096;
+
+    /**
+     * @brief Index a key
+     *
+     * @param hash Hash of the key
+     * @param key Key string, tokens joined by '_'
+     * @return bool True if the key was added, false if it was already indexed
+     */
+    bool AddKey(uint64_t hash, std::string_view key);
+
+    /**
+     * @brief Stop finding a key
+     *
+     * @param hash Hash of the key
+     * @return bool True if the key was indexed
+     */
+    bool RemoveKey(uint64_t hash);
+
+    /**
+     * @brief Find the keys sharing the most informative tokens with a message
+     *
+     * @param tokens Tokens of the message
+     * @param k Maximum number of keys to return
+     * @return std::vector<ScoredKey> Best keys, highest score first; newer
+     *         keys first among equal scores
+     */
+    std::vector<ScoredKey> Search(const std::vector<std::string_view>& tokens, size_t k) const;
+
+    /**
+     * @brief Find the keys sharing the most informative tokens with a message
+     *
+     * @param tokens TokenDictionary ids of the message's tokens; NOT_FOUND
+     *               ids are ignored
+     * @param k Maximum number of keys to return
+     * @return std::vector<ScoredKey> Best keys, as for the token overload
+     */
+    std::vector<ScoredKey> SearchIds(std::vector<TokenDictionary::Id> tokens, size_t k) const;
+
+    /**
+     * @brief Remove every key
+     */
+    void Clear();
+
+    /**
+     * @brief Get the number of indexed keys
+     *
+     * @return size_t Number of keys
+     */
+    size_t GetKeyCount() const;
+
+    /**
+     * @brief Get the bytes used by the posting lists and key table
+     *
+     * @return size_t Approximate bytes, kept up to date as keys are added
+     */
+    size_t GetMemoryBytes() const;
+
+private:
+    /**
+     * @brief Block-compressed ascending list of document ids
+     */
+    struct PostingList {
+        /** First id of each block */
+        std::vector<uint32_t> blockFirst;
+
+        /** Offset of each block's deltas in bytes */
+        std::vector<uint32_t> blockOffset;
+
+        /** Varint deltas */
+        std::vector<uint8_t> bytes;
+
+        /** Number of ids */
+        uint32_t count = 0;
+
+        /** Last id appended */
+        uint32_t last = 0;
+
+        /**
+         * @brief Append an id greater than every id in the list
+         */
+        void Append(uint32_t id);
+
+        /**
+         * @brief Decode one block
+         *
+         * @param block Block index
+         * @param out Receives up to BLOCK_SIZE ids
+         * @return size_t Number of ids decoded
+         */
+        size_t DecodeBlock(size_t block, uint32_t* out) const;
+    };
+
+    /**
+     * @brief Rebuild the posting lists without the ids of removed keys
+     *
+     * Needs the exclusive lock.
+     */
+    void Compact();
+
+    /**
+     * @brief Get the bytes of a posting list, without its map entry
+     */
+    static size_t ListBytes(const PostingList& list) {
+        return list.bytes.size() + (list.blockFirst.size() + list.blockOffset.size()) * sizeof(uint32_t);
+    }
+
+    /**
+     * @brief Add a weight to the score of every candidate present in a list
+     *
+     * @param candidates Ascending candidate ids
+     * @param list Posting list of a query token
+     * @param weight Weight of the token
+     * @param scores Scores parallel to candidates
+     */
+    static void ScoreList(const std::vector<uint32_t>& candidates, const PostingList& list,
+                          float weight, std::vector<float>& scores);
+
+    /**
+     * @brief Add a weight to the candidates present in one decoded block
+     */
+    static void ScoreBlock(const uint32_t* candidates, size_t candidateCount,
+                           const uint32_t* ids, size_t idCount,
+                           float weight, float* scores);
+
+    /** Mutex guarding the index */
+    mutable std::shared_mutex m_mutex;
+
+    /** Posting lists by token id */
+    std::unordered_map<TokenDictionary::Id, PostingList> m_postings;
+
+    /** Key hash of each document id */
+    std::vector<uint64_t> m_keyHashes;
+
+    /** Whether each document id belongs to a removed key */
+    std::vector<bool> m_removed;
+
+    /** Document id of each indexed key by hash */
+    std::unordered_map<uint64_t, uint32_t> m_docIds;
+
+    /** Bytes reported by GetMemoryBytes */
+    size_t m_memoryBytes = 0;
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_FEATURE_INDEX_H
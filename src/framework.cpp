@@ -1,5 +1,9 @@
 // framework.cpp
 #include "framework.h"
+#include "learning_agent.h"
+#include "memory_budget.h"
+#include "string_pool.h"
+#include "token_dictionary.h"
 #include <uwebsockets/App.h>
 #include <nlohmann/json.hpp>
 #include <iostream>
@@ -102,6 +106,15 @@ void Framework::RunWebServer(int port) {
         res->end(responseStr);
     });
     
+    app.get("/dispatchers", [this](auto* res, auto* req) {
+        // Agents, threads and queue depth of each dispatcher binding
+        std::string responseStr = m_agentManager->GetDispatcherStats();
+        
+        // Send response
+        res->writeHeader("Content-Type", "application/json");
+        res->end(responseStr);
+    });
+    
     app.post("/agents", [this](auto* res, auto* req) {
         // Create agent from POST data
         res->onData([this, res](std::string_view data, bool last) {
@@ -166,8 +179,16 @@ void Framework::RunWebServer(int port) {
         // Get agent ID from path parameter
         std::string id = std::string(req->getParameter(0));
         
+        // Set if the client goes away before the agent has answered; only
+        // read and written on this loop's thread
+        auto aborted = std::make_shared<bool>(false);
+        res->onAborted([aborted]() {
+            *aborted = true;
+        });
+        uWS::Loop* loop = uWS::Loop::get();
+        
         // Send message to agent
-        res->onData([this, res, id](std::string_view data, bool last) {
+        res->onData([this, res, id, aborted, loop](std::string_view data, bool last) {
             if (last) {
                 try {
                     // Parse JSON request
@@ -176,18 +197,31 @@ void Framework::RunWebServer(int port) {
                     // Extract message
                     std::string message = request["message"];
                     
-                    // Send message to agent
-                    std::string response = m_agentManager->SendMessage(id, message);
-                    
-                    // Create JSON response
-                    json responseJson = {
-                        {"response", response}
-                    };
-                    std::string responseStr = responseJson.dump();
-                    
-                    // Send response
-                    res->writeHeader("Content-Type", "application/json");
-                    res->end(responseStr);
+                    // The agent answers on its dispatcher thread; the
+                    // response is written back from this loop's thread
+                    m_agentManager->SendMessageAsync(id, message,
+                        [res, aborted, loop](bool success, const std::string& content) {
+                            loop->defer([res, aborted, success, content]() {
+                                if (*aborted) {
+                                    return;
+                                }
+                                
+                                // Create JSON response
+                                json responseJson = success ?
+                                    json{{"response", content}} :
+                                    json{{"success", false}, {"error", content}};
+                                std::string responseStr = responseJson.dump();
+                                
+                                // Send response
+                                res->cork([res, success, &responseStr]() {
+                                    if (!success) {
+                                        res->writeStatus("500 Internal Server Error");
+                                    }
+                                    res->writeHeader("Content-Type", "application/json");
+                                    res->end(responseStr);
+                                });
+                            });
+                        });
                 } catch (const std::exception& e) {
                     // Handle error
                     json response = {
@@ -204,6 +238,240 @@ void Framework::RunWebServer(int port) {
         });
     });
     
+    app.post("/agents/:id/ingest", [this](auto* res, auto* req) {
+        // Get agent ID from path parameter
+        std::string id = std::string(req->getParameter(0));
+        
+        // Stream newline-delimited {"message": ..., "response": ...} objects;
+        // pairs are ingested batch by batch off this loop while the body is
+        // still arriving. Only this loop's thread touches the state.
+        struct IngestState {
+            std::string pending;
+            std::vector<std::pair<std::string, std::string>> pairs;
+            size_t ingested = 0;
+            size_t batchesInFlight = 0;
+            bool finished = false;
+            bool aborted = false;
+            std::string error;
+        };
+        auto state = std::make_shared<IngestState>();
+        uWS::Loop* loop = uWS::Loop::get();
+        
+        res->onAborted([state]() {
+            state->aborted = true;
+        });
+        
+        // Answer once the body is read and every batch has been learned;
+        // pairs ingested before an error stay learned
+        auto respond = [res, state]() {
+            if (state->aborted || !state->finished || state->batchesInFlight > 0) {
+                return;
+            }
+            json response = {
+                {"success", state->error.empty()},
+                {"ingested", state->ingested}
+            };
+            if (!state->error.empty()) {
+                response["error"] = state->error;
+            }
+            std::string responseStr = response.dump();
+            
+            res->cork([res, state, &responseStr]() {
+                res->writeHeader("Content-Type", "application/json");
+                if (!state->error.empty()) {
+                    res->writeStatus("400 Bad Request");
+                }
+                res->end(responseStr);
+            });
+        };
+        
+        auto ingest = [this, id, state, loop, respond]() {
+            m_agentManager->IngestAgentMemoryAsync(id, std::move(state->pairs),
+                [state, loop, respond](bool success, size_t ingested, const std::string& error) {
+                    loop->defer([state, respond, success, ingested, error]() {
+                        --state->batchesInFlight;
+                        state->ingested += ingested;
+                        if (!success && state->error.empty()) {
+                            state->error = error;
+                        }
+                        respond();
+                    });
+                });
+            
+            // The callback runs on this thread, so it cannot come first
+            ++state->batchesInFlight;
+            state->pairs.clear();
+        };
+        
+        res->onData([state, ingest, respond](std::string_view data, bool last) {
+            if (state->finished) {
+                return;
+            }
+            
+            try {
+                state->pending.append(data);
+                size_t start = 0;
+                size_t end;
+                while ((end = state->pending.find('\n', start)) != std::string::npos ||
+                       (last && start < state->pending.size())) {
+                    if (end == std::string::npos) {
+                        end = state->pending.size();
+                    }
+                    std::string_view line(state->pending.data() + start, end - start);
+                    start = end + 1;
+                    if (line.find_first_not_of(" \t\r") == std::string_view::npos) {
+                        continue;
+                    }
+                    
+                    json pair = json::parse(line.begin(), line.end());
+                    state->pairs.emplace_back(pair["message"].get<std::string>(),
+                                              pair["response"].get<std::string>());
+                    if (state->pairs.size() == LearningAgent::INGEST_BATCH) {
+                        ingest();
+                    }
+                }
+                state->pending.erase(0, std::min(start, state->pending.size()));
+                
+                if (!last) {
+                    return;
+                }
+                if (!state->pairs.empty()) {
+                    ingest();
+                }
+            } catch (const std::exception& e) {
+                // Handle error; the rest of the body is ignored
+                state->error = e.what();
+            }
+            
+            state->finished = true;
+            respond();
+        });
+    });
+    
+    app.put("/agents/:id/rules", [this](auto* res, auto* req) {
+        // Get agent ID from path parameter
+        std::string id = std::string(req->getParameter(0));
+        
+        // Rule files can be large: collect the whole body, then compile it
+        // off this loop. Only this loop's thread touches the state.
+        struct ReloadState {
+            std::string body;
+            bool aborted = false;
+        };
+        auto state = std::make_shared<ReloadState>();
+        uWS::Loop* loop = uWS::Loop::get();
+        
+        res->onAborted([state]() {
+            state->aborted = true;
+        });
+        
+        // Replace the agent's rules
+        res->onData([this, res, id, state, loop](std::string_view data, bool last) {
+            state->body.append(data);
+            if (!last) {
+                return;
+            }
+            
+            try {
+                // Validate the JSON before handing it to the agent
+                json request = json::parse(state->body);
+                state->body.clear();
+                
+                m_agentManager->ReloadAgentRulesAsync(id, request.dump(),
+                    [res, id, state, loop](bool success) {
+                        loop->defer([res, id, state, success]() {
+                            if (state->aborted) {
+                                return;
+                            }
+                            
+                            // Create JSON response
+                            json response = {
+                                {"success", success},
+                                {"id", id}
+                            };
+                            std::string responseStr = response.dump();
+                            
+                            // Send response
+                            res->cork([res, &responseStr]() {
+                                res->writeHeader("Content-Type", "application/json");
+                                res->end(responseStr);
+                            });
+                        });
+                    });
+            } catch (const std::exception& e) {
+                // Handle error
+                json response = {
+                    {"success", false},
+                    {"error", e.what()}
+                };
+                std::string responseStr = response.dump();
+                
+                res->writeHeader("Content-Type", "application/json");
+                res->writeStatus("400 Bad Request");
+                res->end(responseStr);
+            }
+        });
+    });
+    
+    app.get("/agents/:id/rules/profile", [this](auto* res, auto* req) {
+        // Get agent ID from path parameter
+        std::string id = std::string(req->getParameter(0));
+        
+        try {
+            // Dump the agent's per-rule counters
+            std::string responseStr = m_agentManager->GetAgentRuleProfile(id);
+            
+            // Send response
+            res->writeHeader("Content-Type", "application/json");
+            res->end(responseStr);
+        } catch (const std::exception& e) {
+            // Handle error
+            json response = {
+                {"success", false},
+                {"error", e.what()}
+            };
+            std::string responseStr = response.dump();
+            
+            res->writeHeader("Content-Type", "application/json");
+            res->writeStatus("400 Bad Request");
+            res->end(responseStr);
+        }
+    });
+    
+    app.get("/memory/stats", [](auto* res, auto* req) {
+        // Report how much the shared response pool deduplicates
+        StringPoolStats stats = StringPool::GetInstance().GetStats();
+        json response = {
+            {"unique_strings", stats.uniqueStrings},
+            {"unique_bytes", stats.uniqueBytes},
+            {"references", stats.references},
+            {"referenced_bytes", stats.referencedBytes},
+            {"dedup_ratio", stats.GetDedupRatio()}
+        };
+        
+        // And how close the learning agents are to the memory budget
+        MemoryBudgetStats budget = MemoryBudget::GetInstance().GetStats();
+        response["budget"] = {
+            {"limit_bytes", budget.limitBytes},
+            {"used_bytes", budget.usedBytes},
+            {"evictions", budget.evictions},
+            {"evicted_bytes", budget.evictedBytes}
+        };
+        
+        // The shared token dictionary is charged to the budget too; evicted
+        // keys do not give its tokens back
+        TokenDictionary& dictionary = TokenDictionary::GetInstance();
+        response["token_dictionary"] = {
+            {"tokens", dictionary.GetTokenCount()},
+            {"bytes", dictionary.GetMemoryBytes()}
+        };
+        std::string responseStr = response.dump();
+        
+        // Send response
+        res->writeHeader("Content-Type", "application/json");
+        res->end(responseStr);
+    });
+    
     // Start the server
     app.listen(port, [port](auto* listen_socket) {
         if (listen_socket) {
@@ -1,8 +1,8 @@
 // learning_agent.cpp
 #include "learning_agent.h"
 #include "logging_service.h"
+#include "tokenizer.h"
 #include <nlohmann/json.hpp>
-#include <sstream>
 #include <algorithm>
 #include <fstream>
 #include <regex>
@@ -10,7 +10,17 @@
 namespace ai_framework {
 
 LearningAgent::LearningAgent(so_5::environment_t& env, std::string id)
-    : Agent(env, std::move(id)), m_learningRate(0.1), m_mbox(so_direct_mbox()) {
+    : Agent(env, std::move(id)), m_learningRate(0.1), m_memory(10),
+      m_flushInterval(10), m_checkpointInterval(60000), m_stopPersistence(false),
+      m_indexEvicted(false), m_retrievalTopK(5), m_asyncLearning(false), m_queuedCount(0),
+      m_pendingCount(0), m_learnedCount(0),
+      m_learnerRunning(false), m_stopLearning(false) {
+}
+
+LearningAgent::~LearningAgent() {
+    // The learner appends to the log, so it stops first
+    StopLearning();
+    StopPersistence();
 }
 
 bool LearningAgent::Initialize(const std::string& config) {
@@ -23,19 +33,77 @@ bool LearningAgent::Initialize(const std::string& config) {
             m_learningRate = configJson["learning_rate"].get<double>();
         }
         
+        // Extract the number of responses kept per key if provided
+        if (configJson.contains("max_responses")) {
+            m_memory.SetMaxResponses(configJson["max_responses"].get<size_t>());
+        }
+        
+        // Extract the memory budget if provided
+        if (configJson.contains("max_memory_bytes")) {
+            m_memory.SetByteBudget(configJson["max_memory_bytes"].get<size_t>());
+        }
+        
+        // Keep evicted keys compressed if requested
+        if (configJson.contains("cold_tier")) {
+            m_memory.SetColdTier(configJson["cold_tier"].get<bool>());
+        }
+        
+        // Write evicted keys to disk if a storage backend is configured
+        if (configJson.contains("storage") && !m_memory.HasStorageBackend()) {
+            std::string path = configJson.value("storage_path", "memory_" + m_id + ".lsm");
+            auto backend = StorageBackend::Create(configJson["storage"].get<std::string>(), path);
+            if (!backend) {
+                LoggingService::GetInstance().Log(
+                    LogLevel::ERROR, 
+                    "Failed to open storage for LearningAgent " + m_id + " at " + path);
+                return false;
+            }
+            m_memory.SetStorageBackend(std::move(backend));
+        }
+        
+        // Extract write-ahead log settings if provided
+        if (configJson.value("wal", false) && !m_wal) {
+            m_wal = std::make_unique<WriteAheadLog>("memory_" + m_id + ".wal");
+        }
+        if (configJson.contains("wal_flush_interval_ms")) {
+            m_flushInterval = std::chrono::milliseconds(
+                std::max<int64_t>(1, configJson["wal_flush_interval_ms"].get<int64_t>()));
+        }
+        if (configJson.contains("checkpoint_interval_ms")) {
+            m_checkpointInterval = std::chrono::milliseconds(
+                std::max<int64_t>(1, configJson["checkpoint_interval_ms"].get<int64_t>()));
+        }
+        
+        // Extract retrieval settings if provided
+        if (configJson.value("retrieval", false) && !m_index) {
+            m_index = std::make_unique<FeatureIndex>();
+            
+            // Keys evicted for good must not be found again; the index is
+            // charged to the memory budget after the evicting write
+            m_memory.SetEvictionListener([this](uint64_t hash) {
+                if (m_index->RemoveKey(hash)) {
+                    m_indexEvicted.store(true, std::memory_order_relaxed);
+                }
+            });
+        }
+        if (configJson.contains("retrieval_top_k")) {
+            m_retrievalTopK = configJson["retrieval_top_k"].get<size_t>();
+        }
+        
+        // Extract asynchronous learning setting if provided
+        bool asyncLearning = configJson.value("async_learning", false);
+        
         // Initialize memory if provided
         if (configJson.contains("initial_memory")) {
-            std::lock_guard<std::mutex> lock(m_memoryMutex);
             auto memoryJson = configJson["initial_memory"];
             for (auto it = memoryJson.begin(); it != memoryJson.end(); ++it) {
-                std::string key = it.key();
                 std::vector<std::string> responses;
                 
                 for (const auto& value : it.value()) {
                     responses.push_back(value.get<std::string>());
                 }
                 
-                m_memory[key] = responses;
+                m_memory.SetResponses(it.key(), responses);
             }
         }
         else {
@@ -43,6 +111,34 @@ bool LearningAgent::Initialize(const std::string& config) {
             LoadMemory();
         }
         
+        if (m_index) {
+            RebuildIndex();
+        }
+        
+        if (m_wal && !m_persistenceThread.joinable()) {
+            // The configured memory replaces whatever the log holds
+            if (configJson.contains("initial_memory") && m_wal->Open()) {
+                Checkpoint();
+            }
+            if (m_wal->GetGeneration() == 0) {
+                LoggingService::GetInstance().Log(
+                    LogLevel::ERROR, 
+                    "Failed to open write-ahead log for LearningAgent " + m_id);
+                return false;
+            }
+            m_persistenceThread = std::thread(&LearningAgent::RunPersistence, this);
+        }
+        
+        if (asyncLearning && !m_learningThread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(m_learningMutex);
+                m_learnerRunning = true;
+                m_stopLearning = false;
+            }
+            m_learningThread = std::thread(&LearningAgent::RunLearning, this);
+            m_asyncLearning.store(true, std::memory_order_release);
+        }
+        
         LoggingService::GetInstance().Log(
             LogLevel::INFO, 
             "LearningAgent " + m_id + " initialized with learning rate " + 
@@ -59,14 +155,15 @@ bool LearningAgent::Initialize(const std::string& config) {
 }
 
 std::string LearningAgent::ProcessMessage(const std::string& message) {
-    // Extract features from the message
-    auto features = ExtractFeatures(message);
+    // Extract features once; the views stay valid until this thread's next message
+    const auto& features = Tokenizer::Local().Tokenize(message);
     
     // Generate a response based on the features
     std::string response = GenerateResponse(features);
     
     // Update the agent's knowledge
-    UpdateKnowledge(message, response);
+    UpdateKnowledge(features, response);
+    ChargeEvictedIndex();
     
     LoggingService::GetInstance().Log(
         LogLevel::DEBUG, 
@@ -76,10 +173,8 @@ std::string LearningAgent::ProcessMessage(const std::string& message) {
 }
 
 void LearningAgent::so_define_agent() {
-    // Subscribe to agent messages
-    so_subscribe(m_mbox).event([this](const messages::AgentMessage& msg) {
-        this->HandleMessage(msg);
-    });
+    // Agent messages are answered by the base class
+    Agent::so_define_agent();
 }
 
 void LearningAgent::so_evt_start() {
@@ -90,6 +185,8 @@ void LearningAgent::so_evt_start() {
 
 void LearningAgent::so_evt_finish() {
     // Save memory before shutting down
+    StopLearning();
+    StopPersistence();
     SaveMemory();
     
     LoggingService::GetInstance().Log(
@@ -97,101 +194,346 @@ void LearningAgent::so_evt_finish() {
         "LearningAgent " + m_id + " finished");
 }
 
-std::vector<std::string> LearningAgent::ExtractFeatures(const std::string& message) {
-    std::vector<std::string> features;
-    
-    // Simple feature extraction: tokenize by spaces and remove punctuation
-    std::string normalized = message;
+std::string LearningAgent::GenerateResponse(const std::vector<std::string_view>& features) {
+    if (features.empty()) {
+        return "I don't understand your message.";
+    }
     
-    // Convert to lowercase
-    std::transform(normalized.begin(), normalized.end(), normalized.begin(),
-                   [](char c) { return static_cast<char>(std::tolower(c)); });
+    // Look the key up by hash, without building the key string
+    uint64_t hash = LearningMemory::HashKey(features);
     
-    // Remove punctuation
-    normalized.erase(
-        std::remove_if(normalized.begin(), normalized.end(),
-                      [](char c) { return std::ispunct(static_cast<unsigned char>(c)); }),
-        normalized.end());
+    // Return a random response from our memory if we have one
+    std::string response;
+    if (m_memory.GetRandomResponse(hash, response)) {
+        return response;
+    }
     
-    // Split by spaces
-    std::istringstream iss(normalized);
-    std::string token;
-    while (std::getline(iss, token, ' ')) {
-        if (!token.empty()) {
-            features.push_back(token);
+    // Otherwise answer like the known keys closest to the message
+    if (m_index) {
+        for (const ScoredKey& key : m_index->Search(features, m_retrievalTopK)) {
+            if (m_memory.GetRandomResponse(key.hash, response)) {
+                return response;
+            }
         }
     }
     
-    return features;
+    // Fallback to a default response
+    return "I'm still learning how to respond to that.";
 }
 
-std::string LearningAgent::GenerateResponse(const std::vector<std::string>& features) {
+void LearningAgent::UpdateKnowledge(
+    const std::vector<std::string_view>& features,
+    const std::string& response) {
+    
     if (features.empty()) {
-        return "I don't understand your message.";
+        return;
     }
     
-    // Create a key from the features
-    std::string key = features.front();
-    for (size_t i = 1; i < std::min(features.size(), static_cast<size_t>(3)); ++i) {
-        key += "_" + features[i];
+    // Leave the write to the learner thread; the response is already answered
+    if (m_asyncLearning.load(std::memory_order_acquire)) {
+        // Counted before it is queued: whatever the learner has taken is
+        // already in the count FlushLearning waits for
+        m_queuedCount.fetch_add(1, std::memory_order_release);
+        size_t pending = m_pendingCount.fetch_add(1, std::memory_order_relaxed) + 1;
+        bool wasEmpty = m_learningQueue.Push(LearnedResponse{LearningMemory::JoinKey(features), response});
+        
+        // Pairs with the fence in StopLearning: if learning stopped before
+        // this push was seen, this thread sees it stopped and learns it here
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!m_asyncLearning.load(std::memory_order_relaxed) || pending > MAX_QUEUED_RESPONSES) {
+            std::vector<LearnedResponse> batch;
+            std::vector<size_t> newKeys;
+            ApplyQueued(batch, newKeys);
+            return;
+        }
+        if (wasEmpty) {
+            // Taking the mutex orders this wakeup after the learner's emptiness check
+            { std::lock_guard<std::mutex> lock(m_learningMutex); }
+            m_learningCondition.notify_one();
+        }
+        return;
     }
     
-    std::lock_guard<std::mutex> lock(m_memoryMutex);
+    // Only the key's shard is locked, and the log record is appended under it
+    if (m_memory.Learn(features, response, m_wal.get()) && m_index) {
+        IndexKey(LearningMemory::JoinKey(features));
+    }
+}
+
+size_t LearningAgent::Ingest(const std::vector<std::pair<std::string, std::string>>& pairs) {
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    size_t learned = 0;
+    std::vector<LearnedResponse> batch;
+    std::vector<size_t> newKeys;
     
-    // Check if we have responses for this key
-    auto it = m_memory.find(key);
-    if (it != m_memory.end() && !it->second.empty()) {
-        // Return a random response from our memory
-        size_t index = static_cast<size_t>(
-            std::rand() % static_cast<int>(it->second.size()));
-        return it->second[index];
+    for (size_t begin = 0; begin < pairs.size(); begin += INGEST_BATCH) {
+        size_t count = std::min(INGEST_BATCH, pairs.size() - begin);
+        batch.assign(count, LearnedResponse());
+        
+        // Each thread tokenizes its own slice with its own tokenizer
+        auto tokenize = [&pairs, &batch, begin](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                const auto& features = Tokenizer::Local().Tokenize(pairs[begin + i].first);
+                if (!features.empty()) {
+                    batch[i].key = LearningMemory::JoinKey(features);
+                    batch[i].response = pairs[begin + i].second;
+                }
+            }
+        };
+        size_t threads = std::clamp<size_t>(count / INGEST_PAIRS_PER_THREAD, 1, cores);
+        size_t slice = (count + threads - 1) / threads;
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < threads; ++t) {
+            workers.emplace_back(tokenize, t * slice, std::min(count, (t + 1) * slice));
+        }
+        tokenize(0, std::min(count, slice));
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        
+        // Messages without features teach nothing
+        batch.erase(std::remove_if(batch.begin(), batch.end(),
+                                   [](const LearnedResponse& pair) { return pair.key.empty(); }),
+                    batch.end());
+        
+        newKeys.clear();
+        m_memory.LearnBatch(batch, m_wal.get(), m_index ? &newKeys : nullptr);
+        for (size_t i : newKeys) {
+            IndexKey(batch[i].key);
+        }
+        ChargeEvictedIndex();
+        learned += batch.size();
     }
     
-    // Fallback to a default response
-    return "I'm still learning how to respond to that.";
+    LoggingService::GetInstance().Log(
+        LogLevel::INFO, 
+        "LearningAgent " + m_id + " ingested " + std::to_string(learned) + " of " +
+        std::to_string(pairs.size()) + " pairs");
+    
+    return learned;
 }
 
-void LearningAgent::UpdateKnowledge(const std::string& message, const std::string& response) {
-    auto features = ExtractFeatures(message);
-    if (features.empty()) {
-        return;
+void LearningAgent::IndexKey(std::string_view key) {
+    if (m_index->AddKey(LearningMemory::HashKey(key), key)) {
+        m_memory.SetExternalBytes(m_index->GetMemoryBytes());
+    }
+}
+
+void LearningAgent::ChargeEvictedIndex() {
+    if (m_index && m_indexEvicted.exchange(false, std::memory_order_relaxed)) {
+        m_memory.SetExternalBytes(m_index->GetMemoryBytes());
+    }
+}
+
+void LearningAgent::RebuildIndex() {
+    m_index->Clear();
+    m_memory.ForEach([this](std::string_view key, const std::vector<std::string_view>&) {
+        m_index->AddKey(LearningMemory::HashKey(key), key);
+    });
+    m_memory.SetExternalBytes(m_index->GetMemoryBytes());
+}
+
+bool LearningAgent::SaveMemory()  {
+    std::string filename = "memory_" + m_id + ".bin";
+    
+    std::lock_guard<std::mutex> checkpointLock(m_checkpointMutex);
+    
+    // Writers wait only while the tables are copied; later responses go to
+    // the next log segment, so the snapshot covers exactly the closed ones
+    if (!m_memory.SaveSnapshot(filename, m_wal.get())) {
+        LoggingService::GetInstance().Log(
+            LogLevel::ERROR, 
+            "Failed to write memory snapshot: " + filename);
+        return false;
     }
     
-    // Create a key from the features
-    std::string key = features.front();
-    for (size_t i = 1; i < std::min(features.size(), static_cast<size_t>(3)); ++i) {
-        key += "_" + features[i];
+    return true;
+}
+
+bool LearningAgent::Checkpoint() {
+    FlushLearning();
+    return SaveMemory();
+}
+
+void LearningAgent::FlushLearning() {
+    uint64_t target = m_queuedCount.load(std::memory_order_acquire);
+    
+    std::unique_lock<std::mutex> lock(m_learningMutex);
+    m_learnedCondition.wait(lock, [this, target] {
+        return m_learnedCount >= target || !m_learnerRunning;
+    });
+}
+
+void LearningAgent::RunLearning() {
+    std::vector<LearnedResponse> batch;
+    std::vector<size_t> newKeys;
+    
+    std::unique_lock<std::mutex> lock(m_learningMutex);
+    while (true) {
+        m_learningCondition.wait(lock, [this] {
+            return m_stopLearning || !m_learningQueue.IsEmpty();
+        });
+        if (m_stopLearning && m_learningQueue.IsEmpty()) {
+            break;
+        }
+        lock.unlock();
+        
+        // Everything queued while the last batch was applied forms the next one
+        ApplyQueued(batch, newKeys);
+        lock.lock();
     }
     
-    std::lock_guard<std::mutex> lock(m_memoryMutex);
+    m_learnerRunning = false;
+    m_learnedCondition.notify_all();
+}
+
+size_t LearningAgent::ApplyQueued(
+    std::vector<LearnedResponse>& batch,
+    std::vector<size_t>& newKeys) {
     
-    // Add the response to memory
-    m_memory[key].push_back(response);
+    // Each PopAll detaches its own responses, so callers never share one
+    batch.clear();
+    newKeys.clear();
+    if (m_learningQueue.PopAll(batch) == 0) {
+        return 0;
+    }
+    m_memory.LearnBatch(batch, m_wal.get(), m_index ? &newKeys : nullptr);
+    for (size_t i : newKeys) {
+        IndexKey(batch[i].key);
+    }
+    ChargeEvictedIndex();
+    m_pendingCount.fetch_sub(batch.size(), std::memory_order_relaxed);
+    
+    std::lock_guard<std::mutex> lock(m_learningMutex);
+    m_learnedCount += batch.size();
+    m_learnedCondition.notify_all();
+    return batch.size();
+}
+
+void LearningAgent::StopLearning() {
+    // Later responses are learned synchronously again
+    m_asyncLearning.store(false, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+        std::lock_guard<std::mutex> lock(m_learningMutex);
+        m_stopLearning = true;
+    }
+    m_learningCondition.notify_all();
     
-    // Limit the number of responses per key to prevent memory explosion
-    constexpr size_t MAX_RESPONSES = 10;
-    if (m_memory[key].size() > MAX_RESPONSES) {
-        m_memory[key].erase(m_memory[key].begin());
+    if (m_learningThread.joinable()) {
+        m_learningThread.join();
     }
+    
+    // A response pushed as the learner left is learned here; one pushed
+    // later is learned by its caller
+    std::vector<LearnedResponse> batch;
+    std::vector<size_t> newKeys;
+    ApplyQueued(batch, newKeys);
 }
 
-bool LearningAgent::SaveMemory()  {
-    try {
-        std::lock_guard<std::mutex> lock(m_memoryMutex);
+bool LearningAgent::RecoverWriteAheadLog(uint64_t logPosition) {
+    uint64_t applied = m_wal->Replay(logPosition, [this](std::string_view key, std::string_view response) {
+        m_memory.AddResponse(key, response);
+    });
+    
+    if (applied > 0) {
+        LoggingService::GetInstance().Log(
+            LogLevel::INFO, 
+            "Replayed " + std::to_string(applied) + " logged responses for agent " + m_id);
+    }
+    
+    // Segments the snapshot covers may outlive a crash during a checkpoint
+    m_wal->RemoveSegmentsUpTo(logPosition);
+    return m_wal->Open(logPosition);
+}
+
+void LearningAgent::RunPersistence() {
+    auto lastCheckpoint = std::chrono::steady_clock::now();
+    
+    std::unique_lock<std::mutex> lock(m_persistenceMutex);
+    while (!m_stopPersistence) {
+        m_persistenceCondition.wait_for(lock, m_flushInterval);
+        lock.unlock();
+        
+        // Every response appended since the last pass shares this sync
+        m_wal->Flush();
         
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastCheckpoint >= m_checkpointInterval) {
+            SaveMemory();
+            lastCheckpoint = now;
+        }
+        
+        lock.lock();
+    }
+}
+
+void LearningAgent::StopPersistence() {
+    {
+        std::lock_guard<std::mutex> lock(m_persistenceMutex);
+        m_stopPersistence = true;
+    }
+    m_persistenceCondition.notify_all();
+    
+    if (m_persistenceThread.joinable()) {
+        m_persistenceThread.join();
+    }
+    if (m_wal) {
+        m_wal->Flush();
+    }
+}
+
+bool LearningAgent::LoadMemory() {
+    std::string filename = "memory_" + m_id + ".bin";
+    
+    bool loaded = false;
+    uint64_t logPosition = 0;
+    
+    // The snapshot is mapped, not parsed; keep the configured capacity
+    size_t maxResponses = m_memory.GetMaxResponses();
+    if (m_memory.LoadSnapshot(filename, &logPosition)) {
+        m_memory.SetMaxResponses(maxResponses);
+        loaded = true;
+        
+        LoggingService::GetInstance().Log(
+            LogLevel::INFO, 
+            "Loaded memory for agent " + m_id + " with " + 
+            std::to_string(m_memory.GetKeyCount()) + " entries");
+    }
+    
+    if (!loaded) {
+        // Fall back to memory saved by earlier versions
+        loaded = ImportMemoryJson("memory_" + m_id + ".json");
+    }
+    
+    // Responses learned after the snapshot are in the log
+    if (m_wal && !RecoverWriteAheadLog(logPosition)) {
+        return false;
+    }
+    
+    return loaded;
+}
+
+bool LearningAgent::ExportMemoryJson(const std::string& path) {
+    FlushLearning();
+    
+    try {
         // Convert memory to JSON
         nlohmann::json memoryJson = nlohmann::json::object();
-        for (const auto& pair : m_memory) {
-            memoryJson[pair.first] = pair.second;
-        }
+        m_memory.ForEach([&memoryJson](std::string_view key, const std::vector<std::string_view>& responses) {
+            nlohmann::json values = nlohmann::json::array();
+            for (std::string_view response : responses) {
+                values.push_back(std::string(response));
+            }
+            memoryJson[std::string(key)] = std::move(values);
+        });
         
         // Save to file
-        std::string filename = "memory_" + m_id + ".json";
-        std::ofstream file(filename);
+        std::ofstream file(path);
         if (!file.is_open()) {
             LoggingService::GetInstance().Log(
                 LogLevel::ERROR, 
-                "Failed to open memory file for writing: " + filename);
+                "Failed to open memory file for writing: " + path);
             return false;
         }
         
@@ -206,36 +548,37 @@ bool LearningAgent::SaveMemory()  {
     }
 }
 
-bool LearningAgent::LoadMemory() {
+bool LearningAgent::ImportMemoryJson(const std::string& path) {
     try {
-        std::string filename = "memory_" + m_id + ".json";
-        std::ifstream file(filename);
+        std::ifstream file(path);
         if (!file.is_open()) {
             LoggingService::GetInstance().Log(
                 LogLevel::WARNING, 
-                "Failed to open memory file for reading: " + filename);
+                "Failed to open memory file for reading: " + path);
             return false;
         }
         
         nlohmann::json memoryJson;
         file >> memoryJson;
         
-        std::lock_guard<std::mutex> lock(m_memoryMutex);
         for (auto it = memoryJson.begin(); it != memoryJson.end(); ++it) {
-            std::string key = it.key();
             std::vector<std::string> responses;
             
             for (const auto& value : it.value()) {
                 responses.push_back(value.get<std::string>());
             }
             
-            m_memory[key] = responses;
+            m_memory.SetResponses(it.key(), responses);
+        }
+        
+        if (m_index) {
+            RebuildIndex();
         }
         
         LoggingService::GetInstance().Log(
             LogLevel::INFO, 
             "Loaded memory for agent " + m_id + " with " + 
-            std::to_string(m_memory.size()) + " entries");
+            std::to_string(m_memory.GetKeyCount()) + " entries");
         
         return true;
     }
@@ -247,8 +590,4 @@ bool LearningAgent::LoadMemory() {
     }
 }
 
-void LearningAgent::HandleMessage(const messages::AgentMessage& msg){
-
-}
-
 } // namespace ai_framework
\ No newline at end of file
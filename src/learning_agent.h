@@ -3,9 +3,20 @@
 #define AI_FRAMEWORK_LEARNING_AGENT_H
 
 #include "agent.h"
+#include "feature_index.h"
+#include "learning_queue.h"
+#include "sharded_learning_memory.h"
 #include "messages.h"
-#include <map>
+#include "write_ahead_log.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace ai_framework {
@@ -15,9 +26,42 @@ namespace ai_framework {
  * 
  * This agent implements a simple learning algorithm that improves
  * its responses based on past interactions.
+ *
+ * With "wal" enabled in the configuration, every learned response is
+ * appended to a write-ahead log that a background thread syncs every
+ * "wal_flush_interval_ms" (one fdatasync per batch), and a checkpoint
+ * snapshot is written every "checkpoint_interval_ms", after which the
+ * log segments it covers are deleted.
+ *
+ * With "retrieval" enabled, a message whose key is unknown is answered
+ * with a response of the best matching known keys, found through an
+ * inverted index of key tokens ("retrieval_top_k" keys are considered).
+ *
+ * "max_memory_bytes" bounds the memory; keys beyond it are evicted least
+ * recently used first, or with "cold_tier" enabled moved into compressed
+ * storage from which they return when used again. With "storage": "lsm"
+ * they are written to an on-disk store under "storage_path" instead, so
+ * the memory can grow beyond RAM.
+ *
+ * With "async_learning" enabled, ProcessMessage only queues what it learned
+ * on a lock-free queue; a learner thread applies the queue in batches,
+ * locking each memory shard once per batch. FlushLearning waits for the
+ * queued responses, and checkpoints and exports wait implicitly. Once
+ * MAX_QUEUED_RESPONSES are waiting, ProcessMessage applies the queue
+ * itself, so a learner that falls behind slows callers down instead of
+ * growing the queue without bound.
  */
 class LearningAgent : public Agent {
 public:
+    /** Pairs tokenized and merged into memory as one batch by Ingest */
+    static constexpr size_t INGEST_BATCH = 64 * 1024;
+    
+    /** Fewest pairs worth a tokenizer thread of their own */
+    static constexpr size_t INGEST_PAIRS_PER_THREAD = 4 * 1024;
+    
+    /** Responses queued for the learner before callers apply the queue themselves */
+    static constexpr size_t MAX_QUEUED_RESPONSES = 64 * 1024;
+    
     /**
      * @brief Constructor for LearningAgent
      * 
@@ -27,9 +71,9 @@ public:
     LearningAgent(so_5::environment_t& env, std::string id);
     
     /**
-     * @brief Destructor for LearningAgent
+     * @brief Destructor for LearningAgent; stops the learner and persistence threads
      */
-    virtual ~LearningAgent() = default;
+    virtual ~LearningAgent();
     
     /**
      * @brief Initialize the agent with configuration parameters
@@ -46,6 +90,62 @@ public:
      * @return std::string Response to the message
      */
     virtual std::string ProcessMessage(const std::string& message) override;
+    
+    /**
+     * @brief Learn (message, response) pairs in bulk
+     * 
+     * Messages are tokenized in parallel on up to one thread per core,
+     * then each batch of INGEST_BATCH pairs is merged into memory locking
+     * every shard once, and logged like learned responses. Nothing is
+     * generated or logged per pair. Pairs for the same key are learned in
+     * order.
+     * 
+     * @param pairs Messages with the response to learn for each
+     * @return size_t Number of pairs learned; messages without features are skipped
+     */
+    size_t Ingest(const std::vector<std::pair<std::string, std::string>>& pairs);
+    
+    /**
+     * @brief Write the agent's memory as JSON, for inspection and tooling
+     * 
+     * @param path Path of the JSON file
+     * @return bool True if the file was written, false otherwise
+     */
+    bool ExportMemoryJson(const std::string& path);
+    
+    /**
+     * @brief Merge memory from a JSON file of key to response arrays
+     * 
+     * @param path Path of the JSON file
+     * @return bool True if the file was imported, false otherwise
+     */
+    bool ImportMemoryJson(const std::string& path);
+    
+    /**
+     * @brief Write a snapshot of the memory and drop the log it covers
+     * 
+     * Learning pauses only while the shard tables are copied; the snapshot
+     * is written from the copies while messages keep being processed.
+     * 
+     * @return bool True if the snapshot was written, false otherwise
+     */
+    bool Checkpoint();
+    
+    /**
+     * @brief Wait until every response queued so far has been learned
+     * 
+     * Returns at once unless "async_learning" is enabled.
+     */
+    void FlushLearning();
+    
+    /**
+     * @brief Get the size and eviction counters of the memory
+     * 
+     * @return LearningMemoryStats Current counters
+     */
+    LearningMemoryStats GetMemoryStats() const {
+        return m_memory.GetStats();
+    }
 
 protected:
     /**
@@ -67,16 +167,8 @@ private:
     /** Learning rate parameter */
     double m_learningRate;
     
-    /** Memory of past interactions */
-    std::map<std::string, std::vector<std::string>> m_memory;
-    
-    /**
-     * @brief Extract features from a message
-     * 
-     * @param message The message to analyze
-     * @return std::vector<std::string> Features extracted from the message
-     */
-    std::vector<std::string> ExtractFeatures(const std::string& message);
+    /** Memory of past interactions, locked per shard */
+    ShardedLearningMemory m_memory;
     
     /**
      * @brief Generate a response based on current knowledge
@@ -84,21 +176,131 @@ private:
      * @param features Features of the input message
      * @return std::string Generated response
      */
-    std::string GenerateResponse(const std::vector<std::string>& features);
+    std::string GenerateResponse(const std::vector<std::string_view>& features);
     
     /**
      * @brief Update the agent's knowledge based on an interaction
      * 
-     * @param message The input message
+     * @param features Features of the input message
      * @param response The generated response
      */
-    void UpdateKnowledge(const std::string& message, const std::string& response);
+    void UpdateKnowledge(const std::vector<std::string_view>& features, const std::string& response);
 
+    /**
+     * @brief Index a key and charge the index's growth to the memory
+     */
+    void IndexKey(std::string_view key);
+    
+    /**
+     * @brief Charge the index again if evictions removed keys from it
+     * 
+     * The eviction listener runs under a shard's lock and must not use the
+     * memory, so it only marks the index; this runs once the write is done.
+     */
+    void ChargeEvictedIndex();
+    
+    /**
+     * @brief Index every key in memory from scratch
+     */
+    void RebuildIndex();
+    
+    /**
+     * @brief Load memory from memory_<id>.bin, or import memory_<id>.json
+     */
     bool LoadMemory();
+    
+    /**
+     * @brief Save memory to the binary snapshot memory_<id>.bin
+     */
     bool SaveMemory();
-    void HandleMessage(const messages::AgentMessage& msg);
-    std::mutex m_memoryMutex;
-    so_5::mbox_t m_mbox;
+    
+    /**
+     * @brief Replay the log after the loaded snapshot and start a new segment
+     */
+    bool RecoverWriteAheadLog(uint64_t logPosition);
+    
+    /**
+     * @brief Background loop flushing the log and taking checkpoints
+     */
+    void RunPersistence();
+    
+    /**
+     * @brief Stop and join the persistence thread
+     */
+    void StopPersistence();
+    
+    /**
+     * @brief Background loop applying queued responses in batches
+     */
+    void RunLearning();
+    
+    /**
+     * @brief Learn what is still queued, then stop and join the learner thread
+     */
+    void StopLearning();
+    
+    /**
+     * @brief Take every queued response and learn it on the calling thread
+     * 
+     * @param batch Scratch space for the responses
+     * @param newKeys Scratch space for the keys the batch added
+     * @return size_t Number of responses learned
+     */
+    size_t ApplyQueued(std::vector<LearnedResponse>& batch, std::vector<size_t>& newKeys);
+    
+    /** Log of learned responses, null unless "wal" is enabled */
+    std::unique_ptr<WriteAheadLog> m_wal;
+    
+    /** Serializes checkpoints */
+    std::mutex m_checkpointMutex;
+    
+    /** Interval between log flushes */
+    std::chrono::milliseconds m_flushInterval;
+    
+    /** Interval between checkpoints */
+    std::chrono::milliseconds m_checkpointInterval;
+    
+    /** Flushes the log and takes checkpoints while the WAL is enabled */
+    std::thread m_persistenceThread;
+    std::mutex m_persistenceMutex;
+    std::condition_variable m_persistenceCondition;
+    bool m_stopPersistence;
+    
+    /** Index of key tokens, null unless "retrieval" is enabled */
+    std::unique_ptr<FeatureIndex> m_index;
+    
+    /** Whether evictions removed keys from the index since it was charged */
+    std::atomic<bool> m_indexEvicted;
+    
+    /** Keys considered when retrieving a response */
+    size_t m_retrievalTopK;
+    
+    /** Whether responses are queued for the learner thread */
+    std::atomic<bool> m_asyncLearning;
+    
+    /** Responses waiting for the learner thread */
+    LearningQueue m_learningQueue;
+    
+    /** Responses queued so far, counted before each is pushed */
+    std::atomic<uint64_t> m_queuedCount;
+    
+    /** Responses queued and not yet learned */
+    std::atomic<size_t> m_pendingCount;
+    
+    /** Applies queued responses while "async_learning" is enabled */
+    std::thread m_learningThread;
+    std::mutex m_learningMutex;
+    std::condition_variable m_learningCondition;
+    
+    /** Signalled after each batch, for FlushLearning */
+    std::condition_variable m_learnedCondition;
+    
+    /** Responses learned so far; guarded by m_learningMutex */
+    uint64_t m_learnedCount;
+    
+    /** Whether the learner thread runs; guarded by m_learningMutex */
+    bool m_learnerRunning;
+    bool m_stopLearning;
 };
 
 } // namespace ai_framework
@@ -0,0 +1,755 @@
+// learning_memory.cpp
+#include "learning_memory.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <unordered_map>
+#include <unistd.h>
+
+namespace ai_framework {
+
+namespace {
+
+constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+constexpr char SNAPSHOT_MAGIC[8] = {'A', 'I', 'F', 'M', 'E', 'M', 'S', 'N'};
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+uint64_t HashBytes(uint64_t hash, std::string_view bytes) {
+    for (unsigned char c : bytes) {
+        hash ^= c;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief Spread FNV's weak low bits before masking to a slot index
+ */
+size_t SlotIndex(uint64_t hash, size_t mask) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return static_cast<size_t>(hash) & mask;
+}
+
+/** Fill a vector from a snapshot section; memcpy must not see the null data() of an empty vector */
+template <typename T>
+void CopySection(std::vector<T>& out, const char* source) {
+    if (!out.empty()) {
+        std::memcpy(out.data(), source, out.size() * sizeof(T));
+    }
+}
+
+} // namespace
+
+StringArena::StringArena(const StringArena& other)
+    : m_chunks(other.m_chunks), m_usedBytes(other.m_usedBytes), m_files(other.m_files) {
+    // Bytes past each chunk's used mark still belong to the original
+    for (auto& chunk : m_chunks) {
+        chunk.writable = false;
+    }
+}
+
+StringArena& StringArena::operator=(const StringArena& other) {
+    if (this != &other) {
+        *this = StringArena(other);
+    }
+    return *this;
+}
+
+StringRef StringArena::Append(std::string_view text) {
+    if (m_chunks.empty() || !m_chunks.back().writable ||
+        m_chunks.back().size - m_chunks.back().used < text.size()) {
+        size_t size = std::max(CHUNK_SIZE, text.size());
+        std::shared_ptr<char[]> storage(new char[size]);
+        const char* data = storage.get();
+        m_chunks.push_back(Chunk{std::move(storage), data, size, 0, true});
+    }
+
+    Chunk& chunk = m_chunks.back();
+    StringRef ref{
+        static_cast<uint32_t>(m_chunks.size() - 1),
+        static_cast<uint32_t>(chunk.used),
+        static_cast<uint32_t>(text.size())};
+    if (!text.empty()) {
+        std::memcpy(chunk.storage.get() + chunk.used, text.data(), text.size());
+    }
+    chunk.used += text.size();
+    m_usedBytes += text.size();
+    return ref;
+}
+
+void StringArena::AdoptChunk(const char* data, size_t size, std::shared_ptr<const MappedFile> file) {
+    m_chunks.push_back(Chunk{nullptr, data, size, size, false});
+    m_usedBytes += size;
+    if (m_files.empty() || m_files.back() != file) {
+        m_files.push_back(std::move(file));
+    }
+}
+
+size_t StringArena::GetCapacityBytes() const {
+    size_t bytes = 0;
+    for (const auto& chunk : m_chunks) {
+        if (chunk.storage) {
+            bytes += chunk.size;
+        }
+    }
+    return bytes;
+}
+
+void StringArena::Clear() {
+    m_chunks.clear();
+    m_files.clear();
+    m_usedBytes = 0;
+}
+
+LearningMemory::LearningMemory(size_t maxResponses)
+    : m_maxResponses(std::max<size_t>(maxResponses, 1)), m_slots(16, Slot{0, 0, 0}) {
+}
+
+LearningMemory::LearningMemory(const LearningMemory& other)
+    : m_maxResponses(other.m_maxResponses), m_slots(other.m_slots), m_entries(other.m_entries),
+      m_ring(other.m_ring), m_arena(other.m_arena), m_clock(other.m_clock),
+      m_keyBytes(other.m_keyBytes), m_responseBytes(other.m_responseBytes),
+      m_garbageBytes(other.m_garbageBytes), m_evictionRandom(other.m_evictionRandom) {
+    for (const auto& lastUsed : other.m_lastUsed) {
+        m_lastUsed.emplace_back(lastUsed.load(std::memory_order_relaxed));
+    }
+    ForEachResponse([](StringPool::Handle handle) {
+        StringPool::GetInstance().Retain(handle);
+    });
+}
+
+LearningMemory::LearningMemory(LearningMemory&& other) noexcept
+    : m_maxResponses(other.m_maxResponses), m_slots(std::move(other.m_slots)),
+      m_entries(std::move(other.m_entries)), m_ring(std::move(other.m_ring)),
+      m_arena(std::move(other.m_arena)), m_clock(other.m_clock),
+      m_lastUsed(std::move(other.m_lastUsed)), m_keyBytes(other.m_keyBytes),
+      m_responseBytes(other.m_responseBytes), m_garbageBytes(other.m_garbageBytes),
+      m_evictionRandom(other.m_evictionRandom) {
+    other.Clear();
+}
+
+LearningMemory& LearningMemory::operator=(LearningMemory other) noexcept {
+    std::swap(m_maxResponses, other.m_maxResponses);
+    m_slots.swap(other.m_slots);
+    m_entries.swap(other.m_entries);
+    m_ring.swap(other.m_ring);
+    std::swap(m_arena, other.m_arena);
+    std::swap(m_clock, other.m_clock);
+    m_lastUsed.swap(other.m_lastUsed);
+    std::swap(m_keyBytes, other.m_keyBytes);
+    std::swap(m_responseBytes, other.m_responseBytes);
+    std::swap(m_garbageBytes, other.m_garbageBytes);
+    std::swap(m_evictionRandom, other.m_evictionRandom);
+    return *this;
+}
+
+LearningMemory::~LearningMemory() {
+    ReleaseAll();
+}
+
+uint64_t LearningMemory::HashKey(const std::vector<std::string_view>& features) {
+    // Hash the joined key without building it
+    uint64_t hash = HashBytes(FNV_OFFSET, features.front());
+    for (size_t i = 1; i < std::min(features.size(), KEY_FEATURES); ++i) {
+        hash = HashBytes(hash, "_");
+        hash = HashBytes(hash, features[i]);
+    }
+    return NonZero(hash);
+}
+
+uint64_t LearningMemory::HashKey(std::string_view key) {
+    return NonZero(HashBytes(FNV_OFFSET, key));
+}
+
+std::string LearningMemory::JoinKey(const std::vector<std::string_view>& features) {
+    std::string key(features.front());
+    for (size_t i = 1; i < std::min(features.size(), KEY_FEATURES); ++i) {
+        key += '_';
+        key += features[i];
+    }
+    return key;
+}
+
+uint32_t LearningMemory::Find(uint64_t hash) const {
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = SlotIndex(hash, mask); ; i = (i + 1) & mask) {
+        const Slot& slot = m_slots[i];
+        if (slot.hash == hash) {
+            return slot.entry;
+        }
+        if (slot.hash == 0) {
+            return NOT_FOUND;
+        }
+    }
+}
+
+void LearningMemory::SetMaxResponses(size_t maxResponses) {
+    maxResponses = std::max<size_t>(maxResponses, 1);
+    if (maxResponses == m_maxResponses) {
+        return;
+    }
+
+    // Lay the rings out again at the new capacity, keeping the newest responses
+    std::vector<StringPool::Handle> ring(m_entries.size() * maxResponses, 0);
+    for (uint32_t i = 0; i < m_entries.size(); ++i) {
+        Entry& entry = m_entries[i];
+        size_t keep = std::min<size_t>(entry.count, maxResponses);
+        for (size_t j = 0; j < entry.count - keep; ++j) {
+            StringPool::Handle dropped = m_ring[RingSlot(i, j)];
+            m_responseBytes -= StringPool::GetInstance().Get(dropped).size();
+            StringPool::GetInstance().Release(dropped);
+        }
+        for (size_t j = 0; j < keep; ++j) {
+            ring[i * maxResponses + j] = m_ring[RingSlot(i, entry.count - keep + j)];
+        }
+        entry.head = 0;
+        entry.count = static_cast<uint32_t>(keep);
+    }
+    m_ring.swap(ring);
+    m_maxResponses = maxResponses;
+}
+
+uint32_t LearningMemory::AddResponse(uint64_t hash, std::string_view key, std::string_view response) {
+    uint32_t index = FindOrInsert(hash, key);
+    Entry& entry = m_entries[index];
+
+    // A full ring overwrites its oldest response
+    StringPool& pool = StringPool::GetInstance();
+    if (entry.count < m_maxResponses) {
+        m_ring[RingSlot(index, entry.count)] = pool.Intern(response);
+        ++entry.count;
+    }
+    else {
+        StringPool::Handle& oldest = m_ring[RingSlot(index, 0)];
+        StringPool::Handle dropped = oldest;
+        oldest = pool.Intern(response);
+        m_responseBytes -= pool.Get(dropped).size();
+        pool.Release(dropped);
+        entry.head = static_cast<uint32_t>((entry.head + 1) % m_maxResponses);
+    }
+    m_responseBytes += response.size();
+
+    ++m_clock;
+    Touch(index);
+    return index;
+}
+
+void LearningMemory::SetResponses(std::string_view key, const std::vector<std::string>& responses) {
+    uint32_t index = FindOrInsert(HashKey(key), key);
+    Entry& entry = m_entries[index];
+    StringPool& pool = StringPool::GetInstance();
+    std::vector<StringPool::Handle> dropped;
+    for (size_t i = 0; i < entry.count; ++i) {
+        dropped.push_back(m_ring[RingSlot(index, i)]);
+    }
+
+    // Intern before releasing so responses that stay are never freed
+    size_t first = responses.size() > m_maxResponses ? responses.size() - m_maxResponses : 0;
+    entry.head = 0;
+    entry.count = static_cast<uint32_t>(responses.size() - first);
+    for (size_t i = 0; i < entry.count; ++i) {
+        m_ring[RingSlot(index, i)] = pool.Intern(responses[first + i]);
+        m_responseBytes += responses[first + i].size();
+    }
+    for (StringPool::Handle handle : dropped) {
+        m_responseBytes -= pool.Get(handle).size();
+        pool.Release(handle);
+    }
+
+    ++m_clock;
+    Touch(index);
+}
+
+void LearningMemory::Remove(uint32_t index) {
+    StringPool& pool = StringPool::GetInstance();
+    Entry& entry = m_entries[index];
+    for (size_t i = 0; i < entry.count; ++i) {
+        StringPool::Handle handle = m_ring[RingSlot(index, i)];
+        m_responseBytes -= pool.Get(handle).size();
+        pool.Release(handle);
+    }
+    std::string_view key = m_arena.Get(entry.key);
+    m_keyBytes -= key.size();
+    m_garbageBytes += key.size();
+
+    // Backward-shift deletion keeps every probe sequence unbroken
+    size_t mask = m_slots.size() - 1;
+    size_t hole = FindSlot(HashKey(key));
+    for (size_t i = (hole + 1) & mask; m_slots[i].hash != 0; i = (i + 1) & mask) {
+        size_t home = SlotIndex(m_slots[i].hash, mask);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            m_slots[hole] = m_slots[i];
+            hole = i;
+        }
+    }
+    m_slots[hole] = Slot{0, 0, 0};
+
+    // Keep entries dense: the last one takes the freed index
+    uint32_t last = static_cast<uint32_t>(m_entries.size() - 1);
+    if (index != last) {
+        m_slots[FindSlot(HashKey(m_arena.Get(m_entries[last].key)))].entry = index;
+        m_entries[index] = m_entries[last];
+        std::copy(m_ring.begin() + static_cast<std::ptrdiff_t>(last * m_maxResponses),
+                  m_ring.begin() + static_cast<std::ptrdiff_t>((last + 1) * m_maxResponses),
+                  m_ring.begin() + static_cast<std::ptrdiff_t>(index * m_maxResponses));
+        m_lastUsed[index].store(m_lastUsed[last].load(std::memory_order_relaxed),
+                                std::memory_order_relaxed);
+    }
+    m_entries.pop_back();
+    m_ring.resize(m_entries.size() * m_maxResponses);
+    m_lastUsed.pop_back();
+
+    CompactIfNeeded();
+}
+
+size_t LearningMemory::EvictTo(size_t targetBytes, const std::function<void(uint32_t)>& onEvict) {
+    constexpr size_t SAMPLES = 8;
+
+    size_t evicted = 0;
+    while (GetUsedBytes() > targetBytes && !m_entries.empty()) {
+        uint32_t victim = 0;
+        uint32_t oldest = UINT32_MAX;
+        for (size_t i = 0; i < std::min(SAMPLES, m_entries.size()); ++i) {
+            // xorshift64
+            m_evictionRandom ^= m_evictionRandom << 13;
+            m_evictionRandom ^= m_evictionRandom >> 7;
+            m_evictionRandom ^= m_evictionRandom << 17;
+            uint32_t candidate = static_cast<uint32_t>(m_evictionRandom % m_entries.size());
+
+            // Age relative to the clock, so wraparound does not matter
+            uint32_t age = m_clock - m_lastUsed[candidate].load(std::memory_order_relaxed);
+            if (oldest == UINT32_MAX || age > oldest) {
+                oldest = age;
+                victim = candidate;
+            }
+        }
+        if (onEvict) {
+            onEvict(victim);
+        }
+        Remove(victim);
+        ++evicted;
+    }
+    return evicted;
+}
+
+size_t LearningMemory::GetMemoryBytes() const {
+    return m_slots.capacity() * sizeof(Slot) +
+           m_entries.capacity() * sizeof(Entry) +
+           m_ring.capacity() * sizeof(StringPool::Handle) +
+           m_arena.GetCapacityBytes();
+}
+
+void LearningMemory::Clear() {
+    ReleaseAll();
+    m_slots.assign(16, Slot{0, 0, 0});
+    m_entries.clear();
+    m_ring.clear();
+    m_arena.Clear();
+    m_lastUsed.clear();
+    m_keyBytes = 0;
+    m_responseBytes = 0;
+    m_garbageBytes = 0;
+}
+
+bool LearningMemory::SaveSnapshot(const std::string& path, uint64_t logPosition) const {
+    return SaveSnapshots(path, {this}, logPosition);
+}
+
+bool LearningMemory::LoadSnapshot(const std::string& path, uint64_t* logPosition) {
+    std::vector<LearningMemory> memories;
+    if (!LoadSnapshots(path, memories, logPosition) || memories.size() != 1) {
+        return false;
+    }
+    *this = std::move(memories.front());
+    return true;
+}
+
+bool LearningMemory::SaveSnapshots(const std::string& path,
+                                   const std::vector<const LearningMemory*>& memories,
+                                   uint64_t logPosition) {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        for (const LearningMemory* memory : memories) {
+            memory->WriteSnapshot(file, logPosition);
+        }
+
+        file.flush();
+        if (!file) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+
+    // The data must be on disk before the rename makes it the snapshot
+    int fd = ::open(tempPath.c_str(), O_RDONLY);
+    bool synced = fd >= 0 && ::fsync(fd) == 0;
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    if (!synced || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    // Persist the rename itself
+    std::string directory = path.find('/') == std::string::npos ?
+        "." : path.substr(0, path.find_last_of('/') + 1);
+    int dirFd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+    return true;
+}
+
+bool LearningMemory::LoadSnapshots(const std::string& path,
+                                   std::vector<LearningMemory>& memories,
+                                   uint64_t* logPosition) {
+    std::shared_ptr<const MappedFile> file = MappedFile::Open(path);
+    if (!file) {
+        return false;
+    }
+
+    std::vector<LearningMemory> loaded;
+    size_t offset = 0;
+    while (offset < file->GetSize()) {
+        loaded.emplace_back();
+        size_t consumed = loaded.back().ReadSnapshot(file, offset, loaded.size() == 1 ? logPosition : nullptr);
+        if (consumed == 0) {
+            return false;
+        }
+        offset += consumed;
+    }
+
+    memories = std::move(loaded);
+    return true;
+}
+
+void LearningMemory::WriteSnapshot(std::ostream& file, uint64_t logPosition) const {
+    SnapshotHeader header;
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.maxResponses = m_maxResponses;
+    header.slotCount = m_slots.size();
+    header.entryCount = m_entries.size();
+    header.chunkCount = m_arena.GetChunkCount();
+    header.garbageBytes = 0;
+    header.logPosition = logPosition;
+
+    // Pool handles mean nothing outside this process; number the distinct
+    // responses and store each text once
+    std::unordered_map<StringPool::Handle, uint32_t> responseIndex;
+    std::vector<uint32_t> ring(m_ring.size(), 0);
+    std::vector<uint32_t> responseLengths;
+    for (uint32_t i = 0; i < m_entries.size(); ++i) {
+        for (size_t j = 0; j < m_entries[i].count; ++j) {
+            size_t slot = RingSlot(i, j);
+            auto inserted = responseIndex.emplace(m_ring[slot], static_cast<uint32_t>(responseLengths.size()));
+            if (inserted.second) {
+                responseLengths.push_back(static_cast<uint32_t>(StringPool::GetInstance().Get(m_ring[slot]).size()));
+            }
+            ring[slot] = inserted.first->second;
+        }
+    }
+    std::vector<StringPool::Handle> responses(responseLengths.size());
+    for (const auto& item : responseIndex) {
+        responses[item.second] = item.first;
+    }
+    header.responseCount = responseLengths.size();
+
+    std::vector<uint64_t> chunkSizes;
+    chunkSizes.reserve(m_arena.GetChunkCount());
+    for (size_t i = 0; i < m_arena.GetChunkCount(); ++i) {
+        chunkSizes.push_back(m_arena.GetChunk(i).size());
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(m_slots.data()),
+               static_cast<std::streamsize>(m_slots.size() * sizeof(Slot)));
+    file.write(reinterpret_cast<const char*>(m_entries.data()),
+               static_cast<std::streamsize>(m_entries.size() * sizeof(Entry)));
+    file.write(reinterpret_cast<const char*>(ring.data()),
+               static_cast<std::streamsize>(ring.size() * sizeof(uint32_t)));
+    file.write(reinterpret_cast<const char*>(chunkSizes.data()),
+               static_cast<std::streamsize>(chunkSizes.size() * sizeof(uint64_t)));
+    file.write(reinterpret_cast<const char*>(responseLengths.data()),
+               static_cast<std::streamsize>(responseLengths.size() * sizeof(uint32_t)));
+    for (size_t i = 0; i < m_arena.GetChunkCount(); ++i) {
+        std::string_view chunk = m_arena.GetChunk(i);
+        file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    }
+    for (StringPool::Handle handle : responses) {
+        std::string_view response = StringPool::GetInstance().Get(handle);
+        file.write(response.data(), static_cast<std::streamsize>(response.size()));
+    }
+}
+
+size_t LearningMemory::ReadSnapshot(const std::shared_ptr<const MappedFile>& file,
+                                    size_t start, uint64_t* logPosition) {
+    const char* data = file->GetData() + start;
+    size_t size = file->GetSize() - start;
+    if (size < SNAPSHOT_HEADER_V1_SIZE) {
+        return 0;
+    }
+
+    // Older headers end before the fields their version lacks
+    SnapshotHeader header = {};
+    std::memcpy(&header, data, SNAPSHOT_HEADER_V1_SIZE);
+    size_t headerSize = header.version == 1 ? SNAPSHOT_HEADER_V1_SIZE :
+                        header.version == 2 ? SNAPSHOT_HEADER_V2_SIZE : sizeof(SnapshotHeader);
+    if (size < headerSize) {
+        return 0;
+    }
+    std::memcpy(&header, data, headerSize);
+
+    // Before version 3 responses were StringRefs into the arena
+    bool pooled = header.version >= 3;
+    size_t ringSlotSize = pooled ? sizeof(uint32_t) : sizeof(StringRef);
+
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version == 0 || header.version > SNAPSHOT_VERSION ||
+        header.byteOrder != BYTE_ORDER_MARK ||
+        header.maxResponses == 0 ||
+        header.slotCount == 0 || (header.slotCount & (header.slotCount - 1)) != 0 ||
+        header.entryCount >= header.slotCount ||
+        header.slotCount > size || header.chunkCount > size || header.responseCount > size ||
+        header.maxResponses > UINT32_MAX ||
+        (header.entryCount > 0 &&
+         header.maxResponses > size / ringSlotSize / header.entryCount)) {
+        return 0;
+    }
+
+    // Section bounds, checked before anything is read
+    uint64_t ringCount = header.entryCount * header.maxResponses;
+    uint64_t offset = headerSize;
+    uint64_t slotsOffset = offset;
+    offset += header.slotCount * sizeof(Slot);
+    uint64_t entriesOffset = offset;
+    offset += header.entryCount * sizeof(Entry);
+    uint64_t ringOffset = offset;
+    offset += ringCount * ringSlotSize;
+    uint64_t chunkSizesOffset = offset;
+    offset += header.chunkCount * sizeof(uint64_t);
+    uint64_t responseLengthsOffset = offset;
+    offset += header.responseCount * sizeof(uint32_t);
+    if (offset > size) {
+        return 0;
+    }
+
+    std::vector<uint64_t> chunkSizes(header.chunkCount);
+    CopySection(chunkSizes, data + chunkSizesOffset);
+
+    // Keys stay in the mapping
+    StringArena arena;
+    for (uint64_t chunkSize : chunkSizes) {
+        if (chunkSize > size - offset) {
+            return 0;
+        }
+        arena.AdoptChunk(data + offset, chunkSize, file);
+        offset += chunkSize;
+    }
+
+    std::vector<uint32_t> responseLengths(header.responseCount);
+    CopySection(responseLengths, data + responseLengthsOffset);
+    std::vector<std::string_view> responseTexts;
+    responseTexts.reserve(responseLengths.size());
+    for (uint32_t length : responseLengths) {
+        if (length > size - offset) {
+            return 0;
+        }
+        responseTexts.emplace_back(data + offset, length);
+        offset += length;
+    }
+
+    std::vector<Slot> slots(header.slotCount);
+    CopySection(slots, data + slotsOffset);
+    std::vector<Entry> entries(header.entryCount);
+    CopySection(entries, data + entriesOffset);
+    std::vector<uint32_t> responseIndexes(pooled ? ringCount : 0);
+    std::vector<StringRef> responseRefs(pooled ? 0 : ringCount);
+    CopySection(responseIndexes, data + ringOffset);
+    CopySection(responseRefs, data + ringOffset);
+
+    // Reject references outside the file rather than crash on them later
+    auto validRef = [&chunkSizes](const StringRef& ref) {
+        return ref.chunk < chunkSizes.size() &&
+               static_cast<uint64_t>(ref.offset) + ref.length <= chunkSizes[ref.chunk];
+    };
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const Entry& entry = entries[i];
+        if (!validRef(entry.key) || entry.count > header.maxResponses ||
+            entry.head >= header.maxResponses) {
+            return 0;
+        }
+        for (size_t j = 0; j < entry.count; ++j) {
+            size_t slot = i * header.maxResponses + (entry.head + j) % header.maxResponses;
+            if (pooled ? responseIndexes[slot] >= responseTexts.size() : !validRef(responseRefs[slot])) {
+                return 0;
+            }
+        }
+    }
+
+    // Each entry sits in exactly one slot, under its key's hash; as there
+    // are fewer entries than slots, every probe then ends at an empty slot
+    std::vector<bool> referenced(entries.size(), false);
+    size_t occupied = 0;
+    for (const Slot& slot : slots) {
+        if (slot.hash == 0) {
+            continue;
+        }
+        if (slot.entry >= entries.size() || referenced[slot.entry] ||
+            slot.hash != HashKey(arena.Get(entries[slot.entry].key))) {
+            return 0;
+        }
+        referenced[slot.entry] = true;
+        ++occupied;
+    }
+    if (occupied != entries.size()) {
+        return 0;
+    }
+
+    // Valid; move the responses into the pool, each distinct text once
+    StringPool& pool = StringPool::GetInstance();
+    std::vector<StringPool::Handle> responseHandles;
+    responseHandles.reserve(responseTexts.size());
+    for (std::string_view text : responseTexts) {
+        responseHandles.push_back(pool.Intern(text));
+    }
+
+    LearningMemory loaded(static_cast<size_t>(header.maxResponses));
+    loaded.m_ring.assign(ringCount, 0);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const Entry& entry = entries[i];
+        for (size_t j = 0; j < entry.count; ++j) {
+            size_t slot = i * header.maxResponses + (entry.head + j) % header.maxResponses;
+            if (pooled) {
+                loaded.m_ring[slot] = responseHandles[responseIndexes[slot]];
+                pool.Retain(loaded.m_ring[slot]);
+            }
+            else {
+                loaded.m_ring[slot] = pool.Intern(arena.Get(responseRefs[slot]));
+            }
+        }
+    }
+    for (StringPool::Handle handle : responseHandles) {
+        pool.Release(handle);
+    }
+
+    loaded.m_slots.swap(slots);
+    loaded.m_entries.swap(entries);
+    loaded.m_arena = std::move(arena);
+    loaded.ResetAccounting();
+    *this = std::move(loaded);
+    if (logPosition) {
+        *logPosition = header.logPosition;
+    }
+    return static_cast<size_t>(offset);
+}
+
+uint32_t LearningMemory::FindOrInsert(uint64_t hash, std::string_view key) {
+    // Keep the load factor at or below 3/4
+    if ((m_entries.size() + 1) * 4 > m_slots.size() * 3) {
+        Grow();
+    }
+
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = SlotIndex(hash, mask); ; i = (i + 1) & mask) {
+        Slot& slot = m_slots[i];
+        if (slot.hash == hash) {
+            return slot.entry;
+        }
+        if (slot.hash == 0) {
+            slot.hash = hash;
+            slot.entry = static_cast<uint32_t>(m_entries.size());
+            m_entries.push_back(Entry{m_arena.Append(key), 0, 0});
+            m_ring.resize(m_ring.size() + m_maxResponses);
+            m_lastUsed.emplace_back(m_clock);
+            m_keyBytes += key.size();
+            return slot.entry;
+        }
+    }
+}
+
+void LearningMemory::Grow() {
+    std::vector<Slot> slots(m_slots.size() * 2, Slot{0, 0, 0});
+    size_t mask = slots.size() - 1;
+    for (const Slot& slot : m_slots) {
+        if (slot.hash == 0) {
+            continue;
+        }
+        size_t i = SlotIndex(slot.hash, mask);
+        while (slots[i].hash != 0) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = slot;
+    }
+    m_slots.swap(slots);
+}
+
+void LearningMemory::ForEachResponse(const std::function<void(StringPool::Handle)>& visit) const {
+    for (uint32_t i = 0; i < m_entries.size(); ++i) {
+        for (size_t j = 0; j < m_entries[i].count; ++j) {
+            visit(m_ring[RingSlot(i, j)]);
+        }
+    }
+}
+
+size_t LearningMemory::FindSlot(uint64_t hash) const {
+    size_t mask = m_slots.size() - 1;
+    size_t i = SlotIndex(hash, mask);
+    while (m_slots[i].hash != hash) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+void LearningMemory::CompactIfNeeded() {
+    if (m_garbageBytes < StringArena::CHUNK_SIZE ||
+        m_garbageBytes * 2 < m_arena.GetUsedBytes()) {
+        return;
+    }
+
+    StringArena arena;
+    for (Entry& entry : m_entries) {
+        entry.key = arena.Append(m_arena.Get(entry.key));
+    }
+    m_arena = std::move(arena);
+    m_garbageBytes = 0;
+}
+
+void LearningMemory::ResetAccounting() {
+    m_clock = 0;
+    m_lastUsed.clear();
+    m_keyBytes = 0;
+    m_responseBytes = 0;
+    for (uint32_t i = 0; i < m_entries.size(); ++i) {
+        m_lastUsed.emplace_back(0);
+        m_keyBytes += m_entries[i].key.length;
+        for (size_t j = 0; j < m_entries[i].count; ++j) {
+            m_responseBytes += StringPool::GetInstance().Get(m_ring[RingSlot(i, j)]).size();
+        }
+    }
+
+    // Older snapshots keep responses in the arena too
+    m_garbageBytes = m_arena.GetUsedBytes() - m_keyBytes;
+}
+
+void LearningMemory::ReleaseAll() {
+    ForEachResponse([](StringPool::Handle handle) {
+        StringPool::GetInstance().Release(handle);
+    });
+}
+
+} // namespace ai_framework
@@ -0,0 +1,569 @@
+// learning_memory.h
+#ifndef AI_FRAMEWORK_LEARNING_MEMORY_H
+#define AI_FRAMEWORK_LEARNING_MEMORY_H
+
+#include "mapped_file.h"
+#include "string_pool.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief Location of a string inside a StringArena
+ */
+struct StringRef {
+    /** Chunk holding the string */
+    uint32_t chunk;
+
+    /** Offset of the first byte within the chunk */
+    uint32_t offset;
+
+    /** Length in bytes */
+    uint32_t length;
+};
+
+/**
+ * @brief Append-only storage for many small strings
+ *
+ * Strings are copied into large chunks, so storing one costs no heap
+ * allocation of its own and strings of one agent sit next to each other.
+ * Chunks never move; a StringRef stays valid until Clear. Read-only chunks
+ * can also be borrowed from a memory-mapped snapshot.
+ *
+ * Copying an arena shares the chunk storage instead of duplicating it; the
+ * copy sees the strings appended so far and appends into chunks of its own.
+ */
+class StringArena {
+public:
+    StringArena() = default;
+    StringArena(const StringArena& other);
+    StringArena& operator=(const StringArena& other);
+    StringArena(StringArena&&) = default;
+    StringArena& operator=(StringArena&&) = default;
+
+    /** Size of a regular chunk; longer strings get a chunk of their own */
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    /**
+     * @brief Copy a string into the arena
+     *
+     * @param text String to store
+     * @return StringRef Location of the copy
+     */
+    StringRef Append(std::string_view text);
+
+    /**
+     * @brief Get a stored string
+     *
+     * @param ref Location returned by Append
+     * @return std::string_view The string, valid until Clear
+     */
+    std::string_view Get(const StringRef& ref) const {
+        return std::string_view(m_chunks[ref.chunk].data + ref.offset, ref.length);
+    }
+
+    /**
+     * @brief Add a read-only chunk that lives in a mapped file
+     *
+     * @param data First byte of the chunk
+     * @param size Size of the chunk
+     * @param file Mapping holding the chunk, kept alive by the arena
+     */
+    void AdoptChunk(const char* data, size_t size, std::shared_ptr<const MappedFile> file);
+
+    /**
+     * @brief Get the number of chunks
+     *
+     * @return size_t Number of chunks
+     */
+    size_t GetChunkCount() const {
+        return m_chunks.size();
+    }
+
+    /**
+     * @brief Get the used bytes of a chunk
+     *
+     * @param chunk Chunk index
+     * @return std::string_view Bytes handed out from the chunk
+     */
+    std::string_view GetChunk(size_t chunk) const {
+        return std::string_view(m_chunks[chunk].data, m_chunks[chunk].used);
+    }
+
+    /**
+     * @brief Get the number of bytes allocated for chunks, not counting
+     *        chunks borrowed from mapped files
+     *
+     * @return size_t Allocated bytes
+     */
+    size_t GetCapacityBytes() const;
+
+    /**
+     * @brief Get the number of bytes handed out by Append
+     *
+     * @return size_t Used bytes
+     */
+    size_t GetUsedBytes() const {
+        return m_usedBytes;
+    }
+
+    /**
+     * @brief Release every chunk
+     */
+    void Clear();
+
+private:
+    struct Chunk {
+        /** Storage of an allocated chunk, null for a mapped one */
+        std::shared_ptr<char[]> storage;
+        const char* data;
+        size_t size;
+        size_t used;
+
+        /** Whether this arena may append to the chunk */
+        bool writable;
+    };
+
+    std::vector<Chunk> m_chunks;
+    size_t m_usedBytes = 0;
+
+    /** Mapped files that borrowed chunks point into */
+    std::vector<std::shared_ptr<const MappedFile>> m_files;
+};
+
+/**
+ * @brief Memory of a LearningAgent: responses seen for each feature key
+ *
+ * Keys are the first three features of a message joined by '_' and are
+ * addressed by their 64-bit hash in a flat open-addressing table, so a
+ * lookup hashes the features in place instead of building the key string.
+ * Two keys with the same hash share an entry; with 64-bit hashes that is
+ * negligible even for millions of keys. Key texts live in a per-memory
+ * StringArena; responses are handles into the process-wide StringPool, so
+ * a response repeated across keys and agents is stored once.
+ *
+ * Each key keeps its latest responses in a fixed-capacity ring, and the
+ * rings of all keys sit back to back in one slab, so recording a response
+ * overwrites the oldest slot in O(1) instead of shifting a vector. Keys
+ * can be evicted least recently used first to keep the memory within a
+ * byte budget. Not thread-safe; the owner serializes access, except that
+ * Touch may run alongside other const members.
+ */
+class LearningMemory {
+public:
+    /** Number of features that make up a key */
+    static constexpr size_t KEY_FEATURES = 3;
+
+    /** Returned by Find when a key is unknown */
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    /**
+     * @brief Constructor for LearningMemory
+     *
+     * @param maxResponses Responses kept per key; the oldest are dropped
+     */
+    explicit LearningMemory(size_t maxResponses = 10);
+
+    /**
+     * @brief Copy a memory; the copy shares key texts and pooled responses
+     */
+    LearningMemory(const LearningMemory& other);
+    LearningMemory(LearningMemory&& other) noexcept;
+    LearningMemory& operator=(LearningMemory other) noexcept;
+
+    /**
+     * @brief Destructor; releases the pooled responses
+     */
+    ~LearningMemory();
+    
+    /**
+     * @brief Change the number of responses kept per key
+     *
+     * Keys holding more than the new capacity keep their newest responses.
+     *
+     * @param maxResponses Responses kept per key, at least 1
+     */
+    void SetMaxResponses(size_t maxResponses);
+
+    /**
+     * @brief Get the number of responses kept per key
+     *
+     * @return size_t Ring capacity
+     */
+    size_t GetMaxResponses() const {
+        return m_maxResponses;
+    }
+
+    /**
+     * @brief Hash the key of a feature list
+     *
+     * Equal to HashKey of the first KEY_FEATURES features joined by '_'.
+     *
+     * @param features Features of a message, must not be empty
+     * @return uint64_t Key hash
+     */
+    static uint64_t HashKey(const std::vector<std::string_view>& features);
+
+    /**
+     * @brief Hash a key string
+     *
+     * @param key Key as stored in snapshots, e.g. "how_are_you"
+     * @return uint64_t Key hash
+     */
+    static uint64_t HashKey(std::string_view key);
+
+    /**
+     * @brief Build the key string of a feature list
+     *
+     * @param features Features of a message, must not be empty
+     * @return std::string Key string
+     */
+    static std::string JoinKey(const std::vector<std::string_view>& features);
+
+    /**
+     * @brief Find the entry of a key
+     *
+     * @param hash Key hash
+     * @return uint32_t Entry index, or NOT_FOUND
+     */
+    uint32_t Find(uint64_t hash) const;
+
+    /**
+     * @brief Get the number of responses of an entry
+     *
+     * @param entry Entry index returned by Find
+     * @return size_t Number of responses
+     */
+    size_t GetResponseCount(uint32_t entry) const {
+        return m_entries[entry].count;
+    }
+
+    /**
+     * @brief Get one response of an entry
+     *
+     * @param entry Entry index returned by Find
+     * @param index Response index, 0 is the oldest
+     * @return std::string_view The response, valid until the memory changes
+     */
+    std::string_view GetResponse(uint32_t entry, size_t index) const {
+        return StringPool::GetInstance().Get(m_ring[RingSlot(entry, index)]);
+    }
+
+    /**
+     * @brief Get the key string of an entry
+     *
+     * @param entry Entry index
+     * @return std::string_view The key, valid until the memory changes
+     */
+    std::string_view GetKey(uint32_t entry) const {
+        return m_arena.Get(m_entries[entry].key);
+    }
+
+    /**
+     * @brief Record a response for a key, dropping the oldest beyond the limit
+     *
+     * @param hash Key hash
+     * @param key Key string, stored if the key is new
+     * @param response Response to record
+     * @return uint32_t Index of the key's entry
+     */
+    uint32_t AddResponse(uint64_t hash, std::string_view key, std::string_view response);
+
+    /**
+     * @brief Note that an entry was used, for eviction
+     *
+     * @param entry Entry index returned by Find
+     */
+    void Touch(uint32_t entry) const {
+        m_lastUsed[entry].store(m_clock, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Remove the key of an entry and its responses
+     *
+     * The last entry moves into the freed index.
+     *
+     * @param entry Entry index
+     */
+    void Remove(uint32_t entry);
+
+    /**
+     * @brief Evict keys until the memory fits a byte budget
+     *
+     * Each victim is the least recently used of a few randomly sampled keys,
+     * which approximates LRU without maintaining a list on every access.
+     *
+     * @param targetBytes Budget for GetUsedBytes
+     * @param onEvict If set, called with each victim's entry before it is removed
+     * @return size_t Number of keys evicted
+     */
+    size_t EvictTo(size_t targetBytes, const std::function<void(uint32_t entry)>& onEvict = nullptr);
+
+    /**
+     * @brief Replace all responses of a key
+     *
+     * @param key Key string
+     * @param responses New responses, oldest first
+     */
+    void SetResponses(std::string_view key, const std::vector<std::string>& responses);
+
+    /**
+     * @brief Get the number of keys
+     *
+     * @return size_t Number of entries
+     */
+    size_t GetKeyCount() const {
+        return m_entries.size();
+    }
+
+    /**
+     * @brief Get the bytes the stored keys account for
+     *
+     * Counts the table, entries, response rings, key texts and response
+     * texts. Pooled responses count in full, so the figure does not depend
+     * on what other memories store. Maintained incrementally.
+     *
+     * @return size_t Accounted bytes
+     */
+    size_t GetUsedBytes() const {
+        return m_slots.size() * sizeof(Slot) +
+               m_entries.size() * (sizeof(Entry) + m_maxResponses * sizeof(StringPool::Handle)) +
+               m_keyBytes + m_responseBytes;
+    }
+
+    /**
+     * @brief Get the bytes used by the table, entries and arena
+     *
+     * Pooled response texts are shared and counted by StringPool instead.
+     *
+     * @return size_t Approximate resident bytes
+     */
+    size_t GetMemoryBytes() const;
+
+    /**
+     * @brief Remove every key
+     */
+    void Clear();
+
+    /**
+     * @brief Write the memory to a binary snapshot file
+     *
+     * The file is written next to the target and renamed over it, so a
+     * crash never leaves a truncated snapshot behind. A copy of the memory
+     * can be saved while the original keeps changing.
+     *
+     * @param path Path of the snapshot
+     * @param logPosition Opaque write-ahead log position the snapshot
+     *                    includes, returned by LoadSnapshot
+     * @return bool True if the snapshot was written
+     */
+    bool SaveSnapshot(const std::string& path, uint64_t logPosition = 0) const;
+
+    /**
+     * @brief Replace the memory with a binary snapshot file
+     *
+     * The file is memory-mapped: tables are copied out with memcpy and key
+     * texts are served from the mapping without copying. Responses are
+     * interned into the StringPool, each distinct text once.
+     * The memory is left unchanged if the file is missing or invalid.
+     *
+     * @param path Path of the snapshot
+     * @param logPosition If not null, receives the log position passed to
+     *                    SaveSnapshot
+     * @return bool True if the snapshot was loaded
+     */
+    bool LoadSnapshot(const std::string& path, uint64_t* logPosition = nullptr);
+
+    /**
+     * @brief Write several memories to one snapshot file, back to back
+     *
+     * @param path Path of the snapshot
+     * @param memories Memories to save, in order
+     * @param logPosition Write-ahead log position stored with every memory
+     * @return bool True if the snapshot was written
+     */
+    static bool SaveSnapshots(const std::string& path,
+                              const std::vector<const LearningMemory*>& memories,
+                              uint64_t logPosition = 0);
+
+    /**
+     * @brief Load every memory of a snapshot file
+     *
+     * A file written by SaveSnapshot holds exactly one memory.
+     *
+     * @param path Path of the snapshot
+     * @param memories Receives the memories, in file order; unchanged on failure
+     * @param logPosition If not null, receives the stored log position
+     * @return bool True if the whole file was valid
+     */
+    static bool LoadSnapshots(const std::string& path,
+                              std::vector<LearningMemory>& memories,
+                              uint64_t* logPosition = nullptr);
+
+private:
+    /** Version of the snapshot layout written by SaveSnapshot */
+    static constexpr uint32_t SNAPSHOT_VERSION = 3;
+
+    /**
+     * @brief Open-addressing slot; hash 0 marks an empty slot
+     */
+    struct Slot {
+        uint64_t hash;
+        uint32_t entry;
+
+        /** Explicit padding so snapshots contain no uninitialized bytes */
+        uint32_t reserved;
+    };
+
+    /**
+     * @brief Start of a snapshot file
+     *
+     * Followed by the slots, entries, response ring, chunk sizes, response
+     * lengths, chunk bytes and response bytes, in that order, all in native
+     * byte order. Ring slots index the snapshot's own response list.
+     */
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t maxResponses;
+        uint64_t slotCount;
+        uint64_t entryCount;
+        uint64_t chunkCount;
+
+        /** Unused since version 3, written as 0 */
+        uint64_t garbageBytes;
+
+        /** Added in version 2 */
+        uint64_t logPosition;
+
+        /** Added in version 3: distinct responses stored after the chunks */
+        uint64_t responseCount;
+    };
+
+    /** Header size of version 1 snapshots, which lack logPosition */
+    static constexpr size_t SNAPSHOT_HEADER_V1_SIZE = offsetof(SnapshotHeader, logPosition);
+
+    /** Header size of version 2 snapshots, whose responses live in the chunks */
+    static constexpr size_t SNAPSHOT_HEADER_V2_SIZE = offsetof(SnapshotHeader, responseCount);
+
+    /**
+     * @brief Key of one entry and the state of its response ring
+     */
+    struct Entry {
+        StringRef key;
+
+        /** Ring position of the oldest response */
+        uint32_t head;
+
+        /** Responses in the ring */
+        uint32_t count;
+    };
+
+    /**
+     * @brief Slab index of an entry's response, 0 being the oldest
+     */
+    size_t RingSlot(uint32_t entry, size_t index) const {
+        return static_cast<size_t>(entry) * m_maxResponses +
+               (m_entries[entry].head + index) % m_maxResponses;
+    }
+
+    /**
+     * @brief Append this memory's snapshot to a stream
+     */
+    void WriteSnapshot(std::ostream& file, uint64_t logPosition) const;
+
+    /**
+     * @brief Replace the memory with the snapshot starting at an offset of a mapping
+     *
+     * @return size_t Bytes of the snapshot, 0 if it is invalid
+     */
+    size_t ReadSnapshot(const std::shared_ptr<const MappedFile>& file, size_t start,
+                        uint64_t* logPosition);
+
+    /**
+     * @brief Find the entry of a key, creating it if needed
+     */
+    uint32_t FindOrInsert(uint64_t hash, std::string_view key);
+
+    /**
+     * @brief Double the slot array and reinsert every entry
+     */
+    void Grow();
+
+    /**
+     * @brief Call a function with the handle of every stored response
+     */
+    void ForEachResponse(const std::function<void(StringPool::Handle)>& visit) const;
+
+    /**
+     * @brief Release every stored response to the pool
+     */
+    void ReleaseAll();
+
+    /**
+     * @brief Slot holding an entry's hash
+     */
+    size_t FindSlot(uint64_t hash) const;
+
+    /**
+     * @brief Copy the live keys into a fresh arena once most of it is garbage
+     */
+    void CompactIfNeeded();
+
+    /**
+     * @brief Recompute the byte counters and access times after a load
+     */
+    void ResetAccounting();
+
+    /** Never hand out hash 0, it marks empty slots */
+    static uint64_t NonZero(uint64_t hash) {
+        return hash == 0 ? 1 : hash;
+    }
+
+    /** Responses kept per key */
+    size_t m_maxResponses;
+
+    /** Slots, a power of two in size */
+    std::vector<Slot> m_slots;
+
+    /** Entries in insertion order */
+    std::vector<Entry> m_entries;
+
+    /** Response rings of pooled handles, m_maxResponses slots per entry */
+    std::vector<StringPool::Handle> m_ring;
+
+    /** Key texts */
+    StringArena m_arena;
+
+    /** Write counter; entries are stamped with it when used */
+    uint32_t m_clock = 0;
+
+    /** Clock value of each entry's last use, parallel to m_entries */
+    mutable std::deque<std::atomic<uint32_t>> m_lastUsed;
+
+    /** Live key bytes in the arena */
+    size_t m_keyBytes = 0;
+
+    /** Bytes of the stored responses */
+    size_t m_responseBytes = 0;
+
+    /** Arena bytes of removed keys */
+    size_t m_garbageBytes = 0;
+
+    /** State of the generator sampling eviction candidates */
+    uint64_t m_evictionRandom = 0x9E3779B97F4A7C15ULL;
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_LEARNING_MEMORY_H
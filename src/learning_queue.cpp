@@ -0,0 +1,52 @@
+// learning_queue.cpp
+#include "learning_queue.h"
+#include <utility>
+
+namespace ai_framework {
+
+LearningQueue::~LearningQueue() {
+    Node* node = m_head.exchange(nullptr, std::memory_order_acquire);
+    while (node) {
+        Node* next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+bool LearningQueue::Push(LearnedResponse item) {
+    Node* node = new Node{std::move(item), m_head.load(std::memory_order_relaxed)};
+    Node* head = node->next;
+    while (!m_head.compare_exchange_weak(head, node,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+        node->next = head;
+    }
+
+    // The consumer may own the node already; only the local copy is safe
+    return head == nullptr;
+}
+
+size_t LearningQueue::PopAll(std::vector<LearnedResponse>& batch) {
+    Node* node = m_head.exchange(nullptr, std::memory_order_acquire);
+
+    // The list runs newest first; reverse it
+    Node* oldest = nullptr;
+    while (node) {
+        Node* next = node->next;
+        node->next = oldest;
+        oldest = node;
+        node = next;
+    }
+
+    size_t count = 0;
+    while (oldest) {
+        Node* next = oldest->next;
+        batch.push_back(std::move(oldest->item));
+        delete oldest;
+        oldest = next;
+        ++count;
+    }
+    return count;
+}
+
+} // namespace ai_framework
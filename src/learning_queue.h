@@ -0,0 +1,82 @@
+// learning_queue.h
+#ifndef AI_FRAMEWORK_LEARNING_QUEUE_H
+#define AI_FRAMEWORK_LEARNING_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief A response waiting to be learned for a key
+ */
+struct LearnedResponse {
+    /** Memory key, the message features joined */
+    std::string key;
+
+    /** Response to record */
+    std::string response;
+};
+
+/**
+ * @brief Lock-free multi-producer, multi-consumer queue of responses
+ *
+ * Producers push onto an atomic list head with one compare-and-swap. A
+ * consumer detaches the whole list with one exchange and reverses it, so a
+ * batch costs a single atomic operation however long it is, and consumers
+ * never pop single nodes that another popper could race for (no ABA).
+ * Responses pushed by one thread are popped in the order they were pushed
+ * when one thread pops; concurrent pops each take a disjoint part.
+ */
+class LearningQueue {
+public:
+    LearningQueue() = default;
+
+    /**
+     * @brief Destructor; drops responses never popped
+     */
+    ~LearningQueue();
+
+    LearningQueue(const LearningQueue&) = delete;
+    LearningQueue& operator=(const LearningQueue&) = delete;
+
+    /**
+     * @brief Queue a response; safe from any thread
+     *
+     * @param item Response to queue
+     * @return bool True if the queue was empty, so the consumer may be idle
+     */
+    bool Push(LearnedResponse item);
+
+    /**
+     * @brief Take every queued response; safe from any thread
+     *
+     * @param batch Receives the responses, oldest first, after its contents
+     * @return size_t Number of responses taken
+     */
+    size_t PopAll(std::vector<LearnedResponse>& batch);
+
+    /**
+     * @brief Check whether any response is queued
+     *
+     * @return bool True if the queue is empty
+     */
+    bool IsEmpty() const {
+        return m_head.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct Node {
+        LearnedResponse item;
+        Node* next;
+    };
+
+    /** Most recently pushed node */
+    std::atomic<Node*> m_head{nullptr};
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_LEARNING_QUEUE_H
@@ -0,0 +1,240 @@
+// literal_prefilter.cpp
+#include "literal_prefilter.h"
+#include <algorithm>
+#include <cctype>
+#include <queue>
+
+namespace ai_framework {
+
+LiteralPrefilter::LiteralPrefilter(bool icase)
+    : m_icase(icase), m_nodes(1), m_literalCount(0) {
+}
+
+std::string LiteralPrefilter::ExtractRequiredLiteral(const std::string& pattern) {
+    std::string best;
+    std::string run;
+    size_t pos = 0;
+
+    auto endRun = [&]() {
+        if (run.size() > best.size()) {
+            best = run;
+        }
+        run.clear();
+    };
+
+    while (pos < pattern.size()) {
+        char c = pattern[pos++];
+        bool isLiteral = false;
+        char literal = c;
+
+        switch (c) {
+            case '\\': {
+                if (pos >= pattern.size()) {
+                    return "";
+                }
+                char escape = pattern[pos++];
+                if (!std::isalnum(static_cast<unsigned char>(escape))) {
+                    isLiteral = true;
+                    literal = escape;
+                }
+                else if (escape == 'x') {
+                    pos += 2;
+                }
+                else if (escape == 'u') {
+                    pos += 4;
+                }
+                else if (escape == 'c') {
+                    pos += 1;
+                }
+                else if (std::isdigit(static_cast<unsigned char>(escape))) {
+                    while (pos < pattern.size() &&
+                           std::isdigit(static_cast<unsigned char>(pattern[pos]))) {
+                        ++pos;
+                    }
+                }
+                break;
+            }
+            case '[': {
+                // Skip the whole class, honouring escapes and a leading ']'
+                if (pos < pattern.size() && pattern[pos] == '^') {
+                    ++pos;
+                }
+                if (pos < pattern.size() && pattern[pos] == ']') {
+                    ++pos;
+                }
+                while (pos < pattern.size() && pattern[pos] != ']') {
+                    pos += (pattern[pos] == '\\') ? 2 : 1;
+                }
+                ++pos;
+                break;
+            }
+            case '(': {
+                // Skip the whole group; its contents may be optional
+                int depth = 1;
+                while (pos < pattern.size() && depth > 0) {
+                    char g = pattern[pos++];
+                    if (g == '\\') {
+                        ++pos;
+                    }
+                    else if (g == '[') {
+                        while (pos < pattern.size() && pattern[pos] != ']') {
+                            pos += (pattern[pos] == '\\') ? 2 : 1;
+                        }
+                        ++pos;
+                    }
+                    else if (g == '(') {
+                        ++depth;
+                    }
+                    else if (g == ')') {
+                        --depth;
+                    }
+                }
+                break;
+            }
+            case '|':
+                // A top-level alternative means no single literal is required
+                return "";
+            case '.': case '^': case '$': case ')':
+            case '*': case '+': case '?': case '{': case '}':
+                break;
+            default:
+                isLiteral = true;
+                break;
+        }
+
+        // Look at the quantifier applied to this token
+        bool optional = false;
+        bool repeated = false;
+        if (pos < pattern.size()) {
+            char q = pattern[pos];
+            if (q == '*' || q == '?') {
+                optional = true;
+                ++pos;
+            }
+            else if (q == '+') {
+                repeated = true;
+                ++pos;
+            }
+            else if (q == '{') {
+                size_t close = pattern.find('}', pos);
+                if (close == std::string::npos) {
+                    return "";
+                }
+                optional = (pos + 1 < pattern.size() && pattern[pos + 1] == '0');
+                repeated = true;
+                pos = close + 1;
+            }
+            if ((optional || repeated) && pos < pattern.size() && pattern[pos] == '?') {
+                ++pos;
+            }
+        }
+
+        if (!isLiteral || optional) {
+            endRun();
+            continue;
+        }
+
+        run += literal;
+        if (repeated) {
+            endRun();
+        }
+    }
+    endRun();
+
+    return best;
+}
+
+void LiteralPrefilter::AddLiteral(const std::string& literal, size_t id) {
+    int node = 0;
+    for (char c : literal) {
+        unsigned char folded = Fold(c);
+        int next = Child(node, folded);
+        if (next < 0) {
+            next = static_cast<int>(m_nodes.size());
+            auto& children = m_nodes[static_cast<size_t>(node)].children;
+            children.insert(
+                std::upper_bound(children.begin(), children.end(),
+                                 std::make_pair(folded, -1)),
+                std::make_pair(folded, next));
+            m_nodes.emplace_back();
+        }
+        node = next;
+    }
+    m_nodes[static_cast<size_t>(node)].ids.push_back(id);
+    ++m_literalCount;
+}
+
+void LiteralPrefilter::Build() {
+    // Breadth-first, so every failure target is finished before it is used
+    std::queue<int> pending;
+    for (const auto& child : m_nodes[0].children) {
+        m_nodes[static_cast<size_t>(child.second)].failure = 0;
+        pending.push(child.second);
+    }
+
+    while (!pending.empty()) {
+        int node = pending.front();
+        pending.pop();
+
+        for (const auto& child : m_nodes[static_cast<size_t>(node)].children) {
+            int failure = m_nodes[static_cast<size_t>(node)].failure;
+            int target = Child(failure, child.first);
+            while (target < 0 && failure != 0) {
+                failure = m_nodes[static_cast<size_t>(failure)].failure;
+                target = Child(failure, child.first);
+            }
+
+            TrieNode& next = m_nodes[static_cast<size_t>(child.second)];
+            next.failure = (target < 0 || target == child.second) ? 0 : target;
+            const TrieNode& fallback = m_nodes[static_cast<size_t>(next.failure)];
+            next.outputLink = fallback.ids.empty() ? fallback.outputLink : next.failure;
+            pending.push(child.second);
+        }
+    }
+}
+
+void LiteralPrefilter::FindCandidates(
+    const std::string& text,
+    std::vector<size_t>& ids) const {
+
+    ids.clear();
+    int node = 0;
+    for (char c : text) {
+        unsigned char folded = Fold(c);
+        int next = Child(node, folded);
+        while (next < 0 && node != 0) {
+            node = m_nodes[static_cast<size_t>(node)].failure;
+            next = Child(node, folded);
+        }
+        node = (next < 0) ? 0 : next;
+
+        for (int out = node; out > 0; out = m_nodes[static_cast<size_t>(out)].outputLink) {
+            const auto& found = m_nodes[static_cast<size_t>(out)].ids;
+            ids.insert(ids.end(), found.begin(), found.end());
+        }
+    }
+
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+}
+
+size_t LiteralPrefilter::GetLiteralCount() const {
+    return m_literalCount;
+}
+
+unsigned char LiteralPrefilter::Fold(char c) const {
+    unsigned char byte = static_cast<unsigned char>(c);
+    return m_icase ? static_cast<unsigned char>(std::tolower(byte)) : byte;
+}
+
+int LiteralPrefilter::Child(int node, unsigned char c) const {
+    const auto& children = m_nodes[static_cast<size_t>(node)].children;
+    auto it = std::lower_bound(
+        children.begin(), children.end(), c,
+        [](const std::pair<unsigned char, int>& child, unsigned char value) {
+            return child.first < value;
+        });
+    return (it != children.end() && it->first == c) ? it->second : -1;
+}
+
+} // namespace ai_framework
@@ -0,0 +1,100 @@
+// literal_prefilter.h
+#ifndef AI_FRAMEWORK_LITERAL_PREFILTER_H
+#define AI_FRAMEWORK_LITERAL_PREFILTER_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief Aho-Corasick index over the required literals of many patterns
+ *
+ * Each pattern contributes one literal that every match of it must contain.
+ * A single scan of a text then yields the patterns that can possibly match,
+ * so the remaining ones never reach a regex engine.
+ */
+class LiteralPrefilter {
+public:
+    /**
+     * @brief Constructor for LiteralPrefilter
+     *
+     * @param icase Whether literals are matched case-insensitively
+     */
+    explicit LiteralPrefilter(bool icase);
+
+    /**
+     * @brief Extract a literal every match of a pattern must contain
+     *
+     * Only top-level runs of plain characters are considered, so the result
+     * is conservative: an empty string means no literal could be proven.
+     *
+     * @param pattern ECMAScript regular expression
+     * @return std::string Longest required literal, or empty
+     */
+    static std::string ExtractRequiredLiteral(const std::string& pattern);
+
+    /**
+     * @brief Register the required literal of a pattern
+     *
+     * @param literal Non-empty literal text
+     * @param id Identifier reported when the literal occurs
+     */
+    void AddLiteral(const std::string& literal, size_t id);
+
+    /**
+     * @brief Compute failure links; call once after the last AddLiteral
+     */
+    void Build();
+
+    /**
+     * @brief Find the patterns whose literal occurs in a text
+     *
+     * @param text The text to scan
+     * @param ids Receives the ids of candidate patterns, sorted and unique
+     */
+    void FindCandidates(const std::string& text, std::vector<size_t>& ids) const;
+
+    /**
+     * @brief Get the number of registered literals
+     *
+     * @return size_t Number of literals
+     */
+    size_t GetLiteralCount() const;
+
+private:
+    /**
+     * @brief Node of the literal trie
+     */
+    struct TrieNode {
+        /** Children as (byte, node) pairs sorted by byte */
+        std::vector<std::pair<unsigned char, int>> children;
+
+        /** Longest proper suffix that is also a trie path */
+        int failure = 0;
+
+        /** Nearest node on the failure chain that ends a literal, or -1 */
+        int outputLink = -1;
+
+        /** Ids of literals ending at this node */
+        std::vector<size_t> ids;
+    };
+
+    /** Whether matching ignores case */
+    bool m_icase;
+
+    /** Trie nodes; node 0 is the root */
+    std::vector<TrieNode> m_nodes;
+
+    /** Number of registered literals */
+    size_t m_literalCount;
+
+    unsigned char Fold(char c) const;
+    int Child(int node, unsigned char c) const;
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_LITERAL_PREFILTER_H
@@ -2,6 +2,7 @@
 #include "logging_service.h"
 #include <iostream>
 #include <chrono>
+#include <ctime>
 #include <iomanip>
 #include <sstream>
 
@@ -53,9 +54,11 @@ void LoggingService::Log(LogLevel level, const std::string& message) {
     auto now = std::chrono::system_clock::now();
     auto time = std::chrono::system_clock::to_time_t(now);
     
-    // Format time string
+    // Format time string; localtime_r, since agents log from many threads
+    std::tm localTime;
+    localtime_r(&time, &localTime);
     std::stringstream ss;
-    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
+    ss << std::put_time(&localTime, "%Y-%m-%d %H:%M:%S");
     
     // Format log message
     std::string formattedMessage = 
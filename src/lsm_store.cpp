@@ -0,0 +1,1061 @@
+// lsm_store.cpp
+#include "lsm_store.h"
+#include "logging_service.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <zlib.h>
+
+namespace ai_framework {
+
+namespace {
+
+/** Identifies a segment file, "LSMSEG01" */
+constexpr uint64_t SEGMENT_MAGIC = 0x31304745534d534cULL;
+
+/** Index entry: first hash, offset and size of a block, size before deflating */
+constexpr size_t INDEX_ENTRY_SIZE = 2 * sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+/** Footer: magic, index offset, block count, filter offset and size, record count, probes */
+constexpr size_t FOOTER_SIZE = 7 * sizeof(uint64_t);
+
+const char* const MANIFEST_NAME = "MANIFEST";
+const char* const SEGMENT_SUFFIX = ".sst";
+
+void PutUint32(std::string& buffer, uint32_t value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void PutUint64(std::string& buffer, uint64_t value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+uint32_t GetUint32(const char* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint64_t GetUint64(const char* data) {
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Spread a key hash over all bits before probing the filter
+ */
+uint64_t MixHash(uint64_t hash) {
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    return hash ^ (hash >> 31);
+}
+
+/**
+ * @brief Visit the filter bits of a hash, by double hashing
+ */
+template <typename Probe>
+void ForEachProbe(uint64_t hash, uint64_t bits, uint32_t probes, Probe probe) {
+    uint64_t value = MixHash(hash);
+    uint64_t delta = (value >> 33) | (value << 31);
+    for (uint32_t i = 0; i < probes; ++i) {
+        if (!probe(value % bits)) {
+            return;
+        }
+        value += delta;
+    }
+}
+
+/**
+ * @brief Parse a block record; the views point into the block
+ *
+ * @return const char* End of the record, null if it overruns the block
+ */
+const char* ParseRecord(const char* data, const char* end, uint64_t& hash,
+                        std::string_view& key, std::vector<std::string_view>& responses) {
+    if (end - data < static_cast<ptrdiff_t>(sizeof(uint64_t) + 2 * sizeof(uint32_t))) {
+        return nullptr;
+    }
+    hash = GetUint64(data);
+    uint32_t keySize = GetUint32(data + sizeof(uint64_t));
+    uint32_t count = GetUint32(data + sizeof(uint64_t) + sizeof(uint32_t));
+    data += sizeof(uint64_t) + 2 * sizeof(uint32_t);
+    if (static_cast<size_t>(end - data) < keySize) {
+        return nullptr;
+    }
+    key = std::string_view(data, keySize);
+    data += keySize;
+
+    responses.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        if (end - data < static_cast<ptrdiff_t>(sizeof(uint32_t))) {
+            return nullptr;
+        }
+        uint32_t size = GetUint32(data);
+        data += sizeof(uint32_t);
+        if (static_cast<size_t>(end - data) < size) {
+            return nullptr;
+        }
+        responses.emplace_back(data, size);
+        data += size;
+    }
+    return data;
+}
+
+bool WriteAll(int fd, const char* data, size_t size) {
+    size_t written = 0;
+    while (written < size) {
+        ssize_t result = ::write(fd, data + written, size - written);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        written += static_cast<size_t>(result);
+    }
+    return true;
+}
+
+void SyncDirectory(const std::string& directory) {
+    int dirFd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+}
+
+/**
+ * @brief Writes one segment file block by block
+ *
+ * Only the current block, the index and the filter are held in memory, so
+ * a merge writes segments larger than RAM. An unfinished file is removed.
+ */
+class SegmentWriter {
+public:
+    SegmentWriter(std::string path, size_t blockBytes, size_t bitsPerKey, size_t expectedRecords)
+        : m_path(std::move(path)), m_blockBytes(blockBytes), m_fd(-1), m_offset(0),
+          m_records(0), m_firstHash(0), m_finished(false) {
+        m_filterBits = std::max<uint64_t>(64, static_cast<uint64_t>(expectedRecords) * bitsPerKey);
+        m_filterBits = (m_filterBits + 7) / 8 * 8;
+        m_filter.assign(m_filterBits / 8, '\0');
+        // ln 2 probes per bit and key minimise false positives
+        m_probes = static_cast<uint32_t>(std::clamp<size_t>(bitsPerKey * 69 / 100, 1, 30));
+    }
+
+    ~SegmentWriter() {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+        if (!m_finished) {
+            std::remove(m_path.c_str());
+        }
+    }
+
+    bool Open() {
+        m_fd = ::open(m_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        return m_fd >= 0;
+    }
+
+    bool Add(uint64_t hash, std::string_view key, const std::vector<std::string_view>& responses) {
+        if (m_block.empty()) {
+            m_firstHash = hash;
+        }
+        PutUint64(m_block, hash);
+        PutUint32(m_block, static_cast<uint32_t>(key.size()));
+        PutUint32(m_block, static_cast<uint32_t>(responses.size()));
+        m_block.append(key);
+        for (std::string_view response : responses) {
+            PutUint32(m_block, static_cast<uint32_t>(response.size()));
+            m_block.append(response);
+        }
+
+        ForEachProbe(hash, m_filterBits, m_probes, [this](uint64_t bit) {
+            m_filter[bit / 8] = static_cast<char>(m_filter[bit / 8] | (1 << (bit % 8)));
+            return true;
+        });
+        ++m_records;
+
+        return m_block.size() < m_blockBytes || WriteBlock();
+    }
+
+    /**
+     * @brief Write the last block, the index, the filter and the footer, and sync
+     */
+    bool Finish() {
+        if (!m_block.empty() && !WriteBlock()) {
+            return false;
+        }
+
+        uint64_t indexOffset = m_offset;
+        uint64_t filterOffset = indexOffset + m_index.size();
+        std::string tail = std::move(m_index);
+        tail.append(m_filter);
+        PutUint64(tail, SEGMENT_MAGIC);
+        PutUint64(tail, indexOffset);
+        PutUint64(tail, (filterOffset - indexOffset) / INDEX_ENTRY_SIZE);
+        PutUint64(tail, filterOffset);
+        PutUint64(tail, m_filter.size());
+        PutUint64(tail, m_records);
+        PutUint64(tail, m_probes);
+
+        // The data must be on disk before the manifest refers to it
+        if (!WriteAll(m_fd, tail.data(), tail.size()) || ::fsync(m_fd) != 0) {
+            return false;
+        }
+        ::close(m_fd);
+        m_fd = -1;
+        m_finished = true;
+        return true;
+    }
+
+private:
+    bool WriteBlock() {
+        uLongf size = compressBound(static_cast<uLong>(m_block.size()));
+        m_compressed.resize(size);
+        if (compress2(reinterpret_cast<Bytef*>(&m_compressed[0]), &size,
+                      reinterpret_cast<const Bytef*>(m_block.data()),
+                      static_cast<uLong>(m_block.size()), Z_DEFAULT_COMPRESSION) != Z_OK ||
+            !WriteAll(m_fd, m_compressed.data(), size)) {
+            return false;
+        }
+
+        PutUint64(m_index, m_firstHash);
+        PutUint64(m_index, m_offset);
+        PutUint32(m_index, static_cast<uint32_t>(size));
+        PutUint32(m_index, static_cast<uint32_t>(m_block.size()));
+        m_offset += size;
+        m_block.clear();
+        return true;
+    }
+
+    std::string m_path;
+    size_t m_blockBytes;
+    int m_fd;
+    uint64_t m_offset;
+    uint64_t m_records;
+    uint64_t m_firstHash;
+    uint64_t m_filterBits;
+    uint32_t m_probes;
+    bool m_finished;
+    std::string m_block;
+    std::string m_compressed;
+    std::string m_index;
+    std::string m_filter;
+};
+
+} // namespace
+
+/**
+ * @brief Byte-bounded LRU cache of inflated blocks, keyed by segment and block
+ */
+class LsmStore::BlockCache {
+public:
+    explicit BlockCache(size_t capacity) : m_capacity(capacity), m_bytes(0), m_hits(0), m_misses(0) {}
+
+    std::shared_ptr<const std::string> Get(uint64_t key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it == m_entries.end()) {
+            ++m_misses;
+            return nullptr;
+        }
+        ++m_hits;
+        m_order.splice(m_order.begin(), m_order, it->second);
+        return it->second->second;
+    }
+
+    void Insert(uint64_t key, std::shared_ptr<const std::string> block) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (block->size() > m_capacity || m_entries.count(key) != 0) {
+            return;
+        }
+        m_bytes += block->size();
+        m_order.emplace_front(key, std::move(block));
+        m_entries[key] = m_order.begin();
+        while (m_bytes > m_capacity) {
+            m_bytes -= m_order.back().second->size();
+            m_entries.erase(m_order.back().first);
+            m_order.pop_back();
+        }
+    }
+
+    void GetStats(StorageBackendStats& stats) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        stats.memoryBytes += m_bytes;
+        stats.cacheHits = m_hits;
+        stats.cacheMisses = m_misses;
+    }
+
+private:
+    using Entry = std::pair<uint64_t, std::shared_ptr<const std::string>>;
+
+    std::mutex m_mutex;
+    size_t m_capacity;
+    size_t m_bytes;
+    uint64_t m_hits;
+    uint64_t m_misses;
+
+    /** Most recently used first */
+    std::list<Entry> m_order;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> m_entries;
+};
+
+/**
+ * @brief One mapped segment file
+ */
+class LsmStore::Segment {
+public:
+    /**
+     * @brief Map and validate a segment file
+     *
+     * @return std::shared_ptr<Segment> The segment, or null if the file is invalid
+     */
+    static std::shared_ptr<Segment> Open(const std::string& path, uint64_t number) {
+        std::shared_ptr<const MappedFile> file = MappedFile::Open(path);
+        if (!file || file->GetSize() < FOOTER_SIZE) {
+            return nullptr;
+        }
+
+        const char* footer = file->GetData() + file->GetSize() - FOOTER_SIZE;
+        auto segment = std::shared_ptr<Segment>(new Segment());
+        segment->m_file = file;
+        segment->m_number = number;
+        segment->m_path = path;
+        uint64_t indexOffset = GetUint64(footer + 8);
+        segment->m_blockCount = GetUint64(footer + 16);
+        uint64_t filterOffset = GetUint64(footer + 24);
+        uint64_t filterBytes = GetUint64(footer + 32);
+        segment->m_records = GetUint64(footer + 40);
+        segment->m_probes = static_cast<uint32_t>(GetUint64(footer + 48));
+
+        uint64_t footerOffset = file->GetSize() - FOOTER_SIZE;
+        if (GetUint64(footer) != SEGMENT_MAGIC || indexOffset > footerOffset ||
+            segment->m_blockCount > (footerOffset - indexOffset) / INDEX_ENTRY_SIZE ||
+            filterOffset != indexOffset + segment->m_blockCount * INDEX_ENTRY_SIZE ||
+            filterBytes == 0 || filterBytes != footerOffset - filterOffset) {
+            return nullptr;
+        }
+
+        segment->m_index = file->GetData() + indexOffset;
+        segment->m_filter = file->GetData() + filterOffset;
+        segment->m_filterBits = filterBytes * 8;
+        for (size_t i = 0; i < segment->m_blockCount; ++i) {
+            const char* entry = segment->m_index + i * INDEX_ENTRY_SIZE;
+            if (GetUint64(entry + 8) + GetUint32(entry + 16) > indexOffset) {
+                return nullptr;
+            }
+        }
+        return segment;
+    }
+
+    uint64_t GetNumber() const {
+        return m_number;
+    }
+
+    const std::string& GetPath() const {
+        return m_path;
+    }
+
+    size_t GetBlockCount() const {
+        return m_blockCount;
+    }
+
+    uint64_t GetRecordCount() const {
+        return m_records;
+    }
+
+    size_t GetFileBytes() const {
+        return m_file->GetSize();
+    }
+
+    /**
+     * @brief Bytes of the index and filter, the pages every lookup touches
+     */
+    size_t GetIndexBytes() const {
+        return m_blockCount * INDEX_ENTRY_SIZE + m_filterBits / 8;
+    }
+
+    bool MayContain(uint64_t hash) const {
+        bool found = true;
+        ForEachProbe(hash, m_filterBits, m_probes, [this, &found](uint64_t bit) {
+            found = (m_filter[bit / 8] >> (bit % 8)) & 1;
+            return found;
+        });
+        return found;
+    }
+
+    /**
+     * @brief Find the block that would hold a hash
+     *
+     * @return size_t Block index, GetBlockCount() if the hash precedes every block
+     */
+    size_t FindBlock(uint64_t hash) const {
+        size_t low = 0;
+        size_t high = m_blockCount;
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (GetUint64(m_index + middle * INDEX_ENTRY_SIZE) <= hash) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+        return low == 0 ? m_blockCount : low - 1;
+    }
+
+    /**
+     * @brief Get the records of a block
+     *
+     * @param cache Cache to consult and fill, or null to bypass it
+     * @return std::shared_ptr<const std::string> Inflated records, null if the block is corrupt
+     */
+    std::shared_ptr<const std::string> ReadBlock(size_t block, BlockCache* cache) const {
+        uint64_t cacheKey = (m_number << 32) | block;
+        if (cache) {
+            if (auto cached = cache->Get(cacheKey)) {
+                return cached;
+            }
+        }
+
+        const char* entry = m_index + block * INDEX_ENTRY_SIZE;
+        uint64_t offset = GetUint64(entry + 8);
+        uint32_t size = GetUint32(entry + 16);
+        uLongf rawSize = GetUint32(entry + 20);
+        auto records = std::make_shared<std::string>(rawSize, '\0');
+        if (uncompress(reinterpret_cast<Bytef*>(&(*records)[0]), &rawSize,
+                       reinterpret_cast<const Bytef*>(m_file->GetData() + offset), size) != Z_OK ||
+            rawSize != records->size()) {
+            LoggingService::GetInstance().Log(
+                LogLevel::ERROR,
+                "Corrupt block " + std::to_string(block) + " in " + m_path);
+            return nullptr;
+        }
+
+        if (cache) {
+            cache->Insert(cacheKey, records);
+        }
+        return records;
+    }
+
+    /**
+     * @brief Read the record of a hash
+     *
+     * @return bool True if the segment holds the hash
+     */
+    bool Find(uint64_t hash, BlockCache* cache, std::string& key,
+              std::vector<std::string>& responses) const {
+        size_t block = FindBlock(hash);
+        if (block == m_blockCount) {
+            return false;
+        }
+        std::shared_ptr<const std::string> records = ReadBlock(block, cache);
+        if (!records) {
+            return false;
+        }
+
+        const char* data = records->data();
+        const char* end = data + records->size();
+        uint64_t recordHash;
+        std::string_view recordKey;
+        std::vector<std::string_view> recordResponses;
+        while (data < end) {
+            data = ParseRecord(data, end, recordHash, recordKey, recordResponses);
+            if (!data || recordHash > hash) {
+                return false;
+            }
+            if (recordHash == hash) {
+                key.assign(recordKey);
+                responses.assign(recordResponses.begin(), recordResponses.end());
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    Segment() = default;
+
+    std::shared_ptr<const MappedFile> m_file;
+    std::string m_path;
+    uint64_t m_number;
+    size_t m_blockCount;
+    uint64_t m_records;
+    const char* m_index;
+    const char* m_filter;
+    uint64_t m_filterBits;
+    uint32_t m_probes;
+};
+
+/**
+ * @brief Reads the records of a table or a segment in hash order
+ *
+ * Segment blocks are read past the cache, so a scan does not evict the
+ * blocks lookups use.
+ */
+class LsmStore::Cursor {
+public:
+    explicit Cursor(std::shared_ptr<const Memtable> table)
+        : m_table(std::move(table)), m_position(m_table->begin()), m_block(0),
+          m_data(nullptr), m_end(nullptr), m_valid(false), m_failed(false) {
+        LoadRecord();
+    }
+
+    explicit Cursor(std::shared_ptr<const Segment> segment)
+        : m_segment(std::move(segment)), m_block(0), m_data(nullptr), m_end(nullptr),
+          m_valid(false), m_failed(false) {
+        LoadRecord();
+    }
+
+    bool IsValid() const {
+        return m_valid;
+    }
+
+    /** Whether a corrupt block ended the cursor early */
+    bool HasFailed() const {
+        return m_failed;
+    }
+
+    uint64_t GetHash() const {
+        return m_hash;
+    }
+
+    std::string_view GetKey() const {
+        return m_key;
+    }
+
+    const std::vector<std::string_view>& GetResponses() const {
+        return m_responses;
+    }
+
+    void Next() {
+        if (m_table) {
+            ++m_position;
+        }
+        LoadRecord();
+    }
+
+private:
+    void LoadRecord() {
+        if (m_table) {
+            m_valid = m_position != m_table->end();
+            if (m_valid) {
+                m_hash = m_position->first;
+                m_key = m_position->second.key;
+                m_responses.assign(m_position->second.responses.begin(),
+                                   m_position->second.responses.end());
+            }
+            return;
+        }
+
+        while (m_data == m_end) {
+            if (m_block == m_segment->GetBlockCount()) {
+                m_valid = false;
+                return;
+            }
+            m_records = m_segment->ReadBlock(m_block++, nullptr);
+            if (!m_records) {
+                m_valid = false;
+                m_failed = true;
+                return;
+            }
+            m_data = m_records->data();
+            m_end = m_data + m_records->size();
+        }
+
+        m_data = ParseRecord(m_data, m_end, m_hash, m_key, m_responses);
+        m_valid = m_data != nullptr;
+        m_failed = !m_valid;
+    }
+
+    std::shared_ptr<const Memtable> m_table;
+    Memtable::const_iterator m_position;
+
+    std::shared_ptr<const Segment> m_segment;
+    size_t m_block;
+    std::shared_ptr<const std::string> m_records;
+    const char* m_data;
+    const char* m_end;
+
+    bool m_valid;
+    bool m_failed;
+    uint64_t m_hash;
+    std::string_view m_key;
+    std::vector<std::string_view> m_responses;
+};
+
+namespace {
+
+/**
+ * @brief Bytes a table record accounts for
+ */
+template <typename Record>
+size_t RecordBytes(const Record& record) {
+    size_t bytes = sizeof(uint64_t) + sizeof(Record) + 64 + record.key.size();
+    for (const auto& response : record.responses) {
+        bytes += sizeof(response) + response.size();
+    }
+    return bytes;
+}
+
+} // namespace
+
+LsmStore::LsmStore(std::string directory, LsmStoreOptions options)
+    : m_directory(std::move(directory)), m_options(options),
+      m_cache(std::make_unique<BlockCache>(options.cacheBytes)), m_memtableBytes(0),
+      m_immutableBytes(0), m_nextSegment(1), m_filterSkips(0), m_workPending(false), m_stop(false) {
+}
+
+LsmStore::~LsmStore() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    Flush();
+    {
+        std::lock_guard<std::mutex> lock(m_workMutex);
+        m_stop = true;
+    }
+    m_workCondition.notify_one();
+    m_thread.join();
+}
+
+bool LsmStore::Open() {
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    if (error) {
+        LoggingService::GetInstance().Log(
+            LogLevel::ERROR,
+            "Failed to create storage directory " + m_directory + ": " + error.message());
+        return false;
+    }
+
+    std::unordered_set<std::string> listed;
+    {
+        std::ifstream manifest(m_directory + "/" + MANIFEST_NAME);
+        std::string name;
+        while (std::getline(manifest, name)) {
+            if (name.empty()) {
+                continue;
+            }
+
+            uint64_t number = std::strtoull(name.c_str(), nullptr, 10);
+            auto segment = Segment::Open(m_directory + "/" + name, number);
+            if (!segment || SegmentPath(number) != segment->GetPath()) {
+                LoggingService::GetInstance().Log(
+                    LogLevel::ERROR,
+                    "Invalid storage segment " + m_directory + "/" + name);
+                return false;
+            }
+            m_segments.push_back(segment);
+            listed.insert(name);
+            m_nextSegment = std::max(m_nextSegment, number + 1);
+        }
+    }
+
+    // Segments a crash left behind before the manifest listed them
+    for (const auto& item : std::filesystem::directory_iterator(m_directory, error)) {
+        std::string name = item.path().filename().string();
+        if (name.size() > std::strlen(SEGMENT_SUFFIX) &&
+            name.compare(name.size() - std::strlen(SEGMENT_SUFFIX), std::string::npos, SEGMENT_SUFFIX) == 0 &&
+            listed.count(name) == 0) {
+            std::filesystem::remove(item.path(), error);
+        }
+    }
+
+    m_thread = std::thread(&LsmStore::RunBackground, this);
+    return true;
+}
+
+void LsmStore::Put(uint64_t hash, std::string_view key, const std::vector<std::string_view>& responses) {
+    Record record{std::string(key), std::vector<std::string>(responses.begin(), responses.end())};
+    size_t bytes = RecordBytes(record);
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_memtable.find(hash);
+    if (it != m_memtable.end()) {
+        m_memtableBytes -= RecordBytes(it->second);
+        it->second = std::move(record);
+    }
+    else {
+        m_memtable.emplace(hash, std::move(record));
+    }
+    m_memtableBytes += bytes;
+    if (m_memtableBytes < m_options.memtableBytes) {
+        return;
+    }
+
+    // At most one table waits for the disk, which bounds the memory held
+    m_flushedCondition.wait(lock, [this] { return !m_immutable; });
+    if (m_memtableBytes >= m_options.memtableBytes) {
+        Freeze();
+        lock.unlock();
+        Signal();
+    }
+}
+
+bool LsmStore::MayContain(uint64_t hash) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    if (m_memtable.count(hash) != 0 || (m_immutable && m_immutable->count(hash) != 0)) {
+        return true;
+    }
+    for (const auto& segment : m_segments) {
+        if (segment->MayContain(hash)) {
+            return true;
+        }
+        m_filterSkips.fetch_add(1, std::memory_order_relaxed);
+    }
+    return false;
+}
+
+bool LsmStore::Get(uint64_t hash, std::string& key, std::vector<std::string>& responses) const {
+    SegmentList segments;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        for (const Memtable* table : {&m_memtable, m_immutable.get()}) {
+            if (!table) {
+                continue;
+            }
+            auto it = table->find(hash);
+            if (it != table->end()) {
+                key = it->second.key;
+                responses = it->second.responses;
+                return true;
+            }
+        }
+        segments = m_segments;
+    }
+
+    // Blocks are read without the lock; the list keeps the files mapped
+    for (const auto& segment : segments) {
+        if (!segment->MayContain(hash)) {
+            m_filterSkips.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (segment->Find(hash, m_cache.get(), key, responses)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void LsmStore::ForEach(
+    const std::function<void(uint64_t, std::string_view, const std::vector<std::string_view>&)>& visit) const {
+
+    std::vector<Cursor> cursors;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        cursors.emplace_back(std::make_shared<const Memtable>(m_memtable));
+        if (m_immutable) {
+            cursors.emplace_back(m_immutable);
+        }
+        for (const auto& segment : m_segments) {
+            cursors.emplace_back(segment);
+        }
+    }
+
+    Merge(cursors, [&visit](uint64_t hash, std::string_view key,
+                            const std::vector<std::string_view>& responses) {
+        visit(hash, key, responses);
+        return true;
+    });
+}
+
+bool LsmStore::Flush() {
+    // A table frozen by a put is written first, then the current one
+    for (;;) {
+        if (!FlushImmutable()) {
+            return false;
+        }
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        if (!m_immutable) {
+            Freeze();
+            break;
+        }
+    }
+
+    bool written = FlushImmutable();
+    Signal();
+    return written;
+}
+
+void LsmStore::Clear() {
+    std::lock_guard<std::mutex> writeLock(m_writeMutex);
+    SegmentList segments;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_memtable.clear();
+        m_memtableBytes = 0;
+        m_immutable.reset();
+        m_immutableBytes = 0;
+        segments.swap(m_segments);
+    }
+    m_flushedCondition.notify_all();
+
+    WriteManifest(SegmentList());
+    for (const auto& segment : segments) {
+        std::remove(segment->GetPath().c_str());
+    }
+}
+
+StorageBackendStats LsmStore::GetStats() const {
+    StorageBackendStats stats = {};
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        stats.records = m_memtable.size() + (m_immutable ? m_immutable->size() : 0);
+        stats.memoryBytes = m_memtableBytes + m_immutableBytes;
+        stats.segments = m_segments.size();
+        for (const auto& segment : m_segments) {
+            stats.records += segment->GetRecordCount();
+            stats.memoryBytes += segment->GetIndexBytes();
+            stats.diskBytes += segment->GetFileBytes();
+        }
+    }
+    m_cache->GetStats(stats);
+    stats.filterSkips = m_filterSkips.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool LsmStore::Compact() {
+    return CompactSegments();
+}
+
+void LsmStore::Freeze() {
+    if (m_memtable.empty()) {
+        return;
+    }
+    m_immutable = std::make_shared<const Memtable>(std::move(m_memtable));
+    m_immutableBytes = m_memtableBytes;
+    m_memtable.clear();
+    m_memtableBytes = 0;
+}
+
+void LsmStore::Signal() {
+    {
+        std::lock_guard<std::mutex> lock(m_workMutex);
+        m_workPending = true;
+    }
+    m_workCondition.notify_one();
+}
+
+bool LsmStore::Merge(
+    std::vector<Cursor>& cursors,
+    const std::function<bool(uint64_t, std::string_view, const std::vector<std::string_view>&)>& visit) {
+
+    // Few cursors take part, so a linear scan for the smallest hash beats a heap
+    for (;;) {
+        Cursor* newest = nullptr;
+        for (auto& cursor : cursors) {
+            if (cursor.IsValid() && (!newest || cursor.GetHash() < newest->GetHash())) {
+                newest = &cursor;
+            }
+        }
+        if (!newest) {
+            break;
+        }
+
+        uint64_t hash = newest->GetHash();
+        if (!visit(hash, newest->GetKey(), newest->GetResponses())) {
+            return false;
+        }
+        for (auto& cursor : cursors) {
+            if (cursor.IsValid() && cursor.GetHash() == hash) {
+                cursor.Next();
+            }
+        }
+    }
+
+    return std::none_of(cursors.begin(), cursors.end(),
+                        [](const Cursor& cursor) { return cursor.HasFailed(); });
+}
+
+std::shared_ptr<const LsmStore::Segment> LsmStore::WriteSegment(
+    uint64_t number, std::vector<Cursor>& cursors, size_t expectedRecords) const {
+
+    std::string path = SegmentPath(number);
+    SegmentWriter writer(path, m_options.blockBytes, m_options.bloomBitsPerKey, expectedRecords);
+    bool written = writer.Open() &&
+        Merge(cursors, [&writer](uint64_t hash, std::string_view key,
+                                 const std::vector<std::string_view>& responses) {
+            return writer.Add(hash, key, responses);
+        }) &&
+        writer.Finish();
+    if (!written) {
+        LoggingService::GetInstance().Log(LogLevel::ERROR, "Failed to write storage segment " + path);
+        return nullptr;
+    }
+
+    auto segment = Segment::Open(path, number);
+    if (!segment) {
+        std::remove(path.c_str());
+    }
+    return segment;
+}
+
+bool LsmStore::FlushImmutable() {
+    std::lock_guard<std::mutex> writeLock(m_writeMutex);
+    std::shared_ptr<const Memtable> table;
+    SegmentList segments;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        table = m_immutable;
+        segments = m_segments;
+    }
+    if (!table) {
+        return true;
+    }
+
+    std::vector<Cursor> cursors;
+    cursors.emplace_back(table);
+    auto segment = WriteSegment(m_nextSegment++, cursors, table->size());
+    bool written = false;
+    if (segment) {
+        segments.insert(segments.begin(), segment);
+        written = WriteManifest(segments);
+        if (!written) {
+            std::remove(segment->GetPath().c_str());
+        }
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        if (written) {
+            m_segments = std::move(segments);
+        }
+        else {
+            // Keep the records readable; the next full table retries
+            for (const auto& entry : *table) {
+                if (m_memtable.emplace(entry.first, entry.second).second) {
+                    m_memtableBytes += RecordBytes(entry.second);
+                }
+            }
+        }
+        m_immutable.reset();
+        m_immutableBytes = 0;
+    }
+    m_flushedCondition.notify_all();
+    return written;
+}
+
+bool LsmStore::CompactSegments() {
+    SegmentList inputs;
+    uint64_t number;
+    {
+        std::lock_guard<std::mutex> writeLock(m_writeMutex);
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        if (m_segments.size() < 2) {
+            return true;
+        }
+        inputs = m_segments;
+        number = m_nextSegment++;
+    }
+
+    // Flushes go on while the inputs are merged
+    std::vector<Cursor> cursors;
+    size_t expectedRecords = 0;
+    for (const auto& segment : inputs) {
+        cursors.emplace_back(segment);
+        expectedRecords += segment->GetRecordCount();
+    }
+    auto merged = WriteSegment(number, cursors, expectedRecords);
+    if (!merged) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> writeLock(m_writeMutex);
+    SegmentList segments;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        segments = m_segments;
+    }
+
+    // Segments flushed meanwhile are newer and stay in front; anything else
+    // (a Clear) invalidates the merge
+    if (segments.size() < inputs.size() ||
+        !std::equal(inputs.begin(), inputs.end(), segments.end() - inputs.size())) {
+        std::remove(merged->GetPath().c_str());
+        return false;
+    }
+    segments.resize(segments.size() - inputs.size());
+    segments.push_back(merged);
+    if (!WriteManifest(segments)) {
+        std::remove(merged->GetPath().c_str());
+        return false;
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_segments = std::move(segments);
+    }
+
+    // Readers still holding the inputs keep their mappings
+    for (const auto& segment : inputs) {
+        std::remove(segment->GetPath().c_str());
+    }
+    return true;
+}
+
+bool LsmStore::WriteManifest(const SegmentList& segments) const {
+    std::string contents;
+    for (const auto& segment : segments) {
+        contents += std::to_string(segment->GetNumber()) + SEGMENT_SUFFIX + "\n";
+    }
+
+    std::string path = m_directory + "/" + MANIFEST_NAME;
+    std::string tempPath = path + ".tmp";
+    int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool written = fd >= 0 && WriteAll(fd, contents.data(), contents.size()) && ::fsync(fd) == 0;
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    if (!written || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        LoggingService::GetInstance().Log(LogLevel::ERROR, "Failed to write storage manifest " + path);
+        return false;
+    }
+
+    // Persist the rename and the new segment's directory entry
+    SyncDirectory(m_directory);
+    return true;
+}
+
+std::string LsmStore::SegmentPath(uint64_t number) const {
+    return m_directory + "/" + std::to_string(number) + SEGMENT_SUFFIX;
+}
+
+void LsmStore::RunBackground() {
+    std::unique_lock<std::mutex> lock(m_workMutex);
+    for (;;) {
+        m_workCondition.wait(lock, [this] { return m_workPending || m_stop; });
+        if (m_stop) {
+            return;
+        }
+        m_workPending = false;
+        lock.unlock();
+
+        FlushImmutable();
+        size_t segments;
+        {
+            std::shared_lock<std::shared_mutex> tableLock(m_mutex);
+            segments = m_segments.size();
+        }
+        if (segments >= m_options.compactionTrigger) {
+            CompactSegments();
+        }
+
+        lock.lock();
+    }
+}
+
+} // namespace ai_framework
@@ -0,0 +1,223 @@
+// lsm_store.h
+#ifndef AI_FRAMEWORK_LSM_STORE_H
+#define AI_FRAMEWORK_LSM_STORE_H
+
+#include "storage_backend.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief Tuning of an LsmStore
+ */
+struct LsmStoreOptions {
+    /** Bytes buffered in memory before they are written as a segment */
+    size_t memtableBytes = 4 * 1024 * 1024;
+
+    /** Uncompressed bytes per data block */
+    size_t blockBytes = 4 * 1024;
+
+    /** Bytes of inflated blocks kept in the cache */
+    size_t cacheBytes = 8 * 1024 * 1024;
+
+    /** Bloom filter bits per record */
+    size_t bloomBitsPerKey = 10;
+
+    /** Segments that trigger merging all of them into one */
+    size_t compactionTrigger = 4;
+};
+
+/**
+ * @brief Log-structured store of keys and responses on disk
+ *
+ * Puts go to a sorted in-memory table. A full table is frozen and a
+ * background thread writes it as an immutable segment file: deflated data
+ * blocks sorted by key hash, an index of the blocks' first hashes, and a
+ * bloom filter over all hashes. Segments are memory-mapped, so only the
+ * index and filter pages of a segment stay resident, and inflated blocks
+ * are kept in a byte-bounded LRU cache.
+ *
+ * A lookup checks the tables, then the segments from newest to oldest;
+ * a segment whose filter rules the hash out is skipped without reading a
+ * block. Once compactionTrigger segments exist, the background thread
+ * merges them into one, keeping the newest record of every hash.
+ *
+ * The MANIFEST file lists the live segments and is replaced atomically, so
+ * a crash leaves either the old or the new set; records still buffered in
+ * memory are lost unless Flush was called. Thread-safe.
+ */
+class LsmStore : public StorageBackend {
+public:
+    /**
+     * @brief Constructor for LsmStore
+     *
+     * @param directory Directory of the segments and the manifest
+     * @param options Tuning
+     */
+    explicit LsmStore(std::string directory, LsmStoreOptions options = LsmStoreOptions());
+
+    /**
+     * @brief Destructor; flushes the buffered records and stops the background thread
+     */
+    ~LsmStore() override;
+
+    LsmStore(const LsmStore&) = delete;
+    LsmStore& operator=(const LsmStore&) = delete;
+
+    /**
+     * @brief Open the segments listed by the manifest and start the background thread
+     *
+     * Segment files not in the manifest, left by an interrupted write, are deleted.
+     *
+     * @return bool True if the store is ready
+     */
+    bool Open();
+
+    void Put(uint64_t hash, std::string_view key,
+             const std::vector<std::string_view>& responses) override;
+
+    bool MayContain(uint64_t hash) const override;
+
+    bool Get(uint64_t hash, std::string& key, std::vector<std::string>& responses) const override;
+
+    void ForEach(const std::function<void(uint64_t hash, std::string_view key,
+                                          const std::vector<std::string_view>& responses)>& visit) const override;
+
+    bool Flush() override;
+
+    void Clear() override;
+
+    StorageBackendStats GetStats() const override;
+
+    /**
+     * @brief Merge every segment into one now
+     *
+     * @return bool True if the merged segment was written
+     */
+    bool Compact();
+
+private:
+    class Segment;
+    class BlockCache;
+    class Cursor;
+
+    struct Record {
+        std::string key;
+        std::vector<std::string> responses;
+    };
+
+    using Memtable = std::map<uint64_t, Record>;
+    using SegmentList = std::vector<std::shared_ptr<const Segment>>;
+
+    /**
+     * @brief Freeze the current table for the background thread
+     *
+     * Needs the exclusive lock and no frozen table.
+     */
+    void Freeze();
+
+    /**
+     * @brief Wake the background thread
+     */
+    void Signal();
+
+    /**
+     * @brief Merge sorted cursors, newest first, visiting the newest record of each hash
+     *
+     * @param visit Returns false to stop
+     * @return bool False if visit stopped the merge or a block was unreadable
+     */
+    static bool Merge(std::vector<Cursor>& cursors,
+                      const std::function<bool(uint64_t, std::string_view,
+                                               const std::vector<std::string_view>&)>& visit);
+
+    /**
+     * @brief Write merged cursors as a new segment and open it
+     *
+     * @param expectedRecords Upper bound of the records, sizes the bloom filter
+     * @return std::shared_ptr<const Segment> The segment, or null on failure
+     */
+    std::shared_ptr<const Segment> WriteSegment(uint64_t number, std::vector<Cursor>& cursors,
+                                                size_t expectedRecords) const;
+
+    /**
+     * @brief Write the frozen table as a segment, if there is one
+     *
+     * @return bool True unless writing failed
+     */
+    bool FlushImmutable();
+
+    /**
+     * @brief Merge the current segments into one
+     */
+    bool CompactSegments();
+
+    /**
+     * @brief Replace the manifest with the given segments
+     *
+     * Needs m_writeMutex.
+     */
+    bool WriteManifest(const SegmentList& segments) const;
+
+    /**
+     * @brief Path of a segment file
+     */
+    std::string SegmentPath(uint64_t number) const;
+
+    /**
+     * @brief Flush frozen tables and compact until stopped
+     */
+    void RunBackground();
+
+    std::string m_directory;
+    LsmStoreOptions m_options;
+
+    /** Inflated blocks of all segments */
+    std::unique_ptr<BlockCache> m_cache;
+
+    /** Mutex guarding the tables and the segment list */
+    mutable std::shared_mutex m_mutex;
+
+    /** Signalled when the frozen table has been written */
+    std::condition_variable_any m_flushedCondition;
+
+    /** Table receiving puts */
+    Memtable m_memtable;
+    size_t m_memtableBytes;
+
+    /** Full table being written, or null */
+    std::shared_ptr<const Memtable> m_immutable;
+    size_t m_immutableBytes;
+
+    /** Live segments, newest first */
+    SegmentList m_segments;
+
+    /** Mutex serializing segment writes and manifest changes */
+    mutable std::mutex m_writeMutex;
+
+    /** Number of the next segment file */
+    uint64_t m_nextSegment;
+
+    /** Lookups skipped by a bloom filter */
+    mutable std::atomic<uint64_t> m_filterSkips;
+
+    std::thread m_thread;
+    std::mutex m_workMutex;
+    std::condition_variable m_workCondition;
+    bool m_workPending;
+    bool m_stop;
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_LSM_STORE_H
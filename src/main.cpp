@@ -85,8 +85,9 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    // Create SObjectizer environment
-    so_5::wrapped_env_t env;
+    // Create SObjectizer environment; static so that it outlives the agent
+    // manager singleton, whose agents deregister from it on destruction
+    static so_5::wrapped_env_t env;
     
     // Initialize agent manager
     AgentManager& agentManager = AgentManager::GetInstance(env.environment());
@@ -156,10 +157,40 @@ int main(int argc, char* argv[]) {
         try {
             nlohmann::json jsonMessage = nlohmann::json::parse(message);
             std::string targetAgent = jsonMessage["agent"].get<std::string>();
+            
+            // Bulk training: {"agent": ..., "ingest": [[message, response], ...]}
+            if (jsonMessage.contains("ingest")) {
+                std::vector<std::pair<std::string, std::string>> pairs;
+                pairs.reserve(jsonMessage["ingest"].size());
+                for (const auto& pair : jsonMessage["ingest"]) {
+                    pairs.emplace_back(pair.at(0).get<std::string>(), pair.at(1).get<std::string>());
+                }
+                
+                // Ingested on the manager's worker; the server thread moves on
+                agentManager.IngestAgentMemoryAsync(targetAgent, std::move(pairs),
+                    [sendResponse](bool success, size_t ingested, const std::string& error) {
+                        if (success) {
+                            sendResponse("{\"ingested\": " + std::to_string(ingested) + "}");
+                        }
+                        else {
+                            sendResponse(nlohmann::json{{"error", error}}.dump());
+                        }
+                    });
+                return;
+            }
+            
             std::string content = jsonMessage["message"].get<std::string>();
             
-            std::string response = agentManager.SendMessage(targetAgent, content);
-            sendResponse(response);
+            // The agent answers on its own thread; the server thread moves on
+            agentManager.SendMessageAsync(targetAgent, content,
+                [sendResponse](bool success, const std::string& response) {
+                    if (success) {
+                        sendResponse(response);
+                    }
+                    else {
+                        sendResponse(nlohmann::json{{"error", response}}.dump());
+                    }
+                });
         }
         catch (const std::exception& e) {
             sendResponse("{\"error\": \"" + std::string(e.what()) + "\"}");
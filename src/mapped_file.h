@@ -0,0 +1,63 @@
+// mapped_file.h
+#ifndef AI_FRAMEWORK_MAPPED_FILE_H
+#define AI_FRAMEWORK_MAPPED_FILE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace ai_framework {
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * The mapping is shared, so every process mapping the same file reads the
+ * same page cache pages. It is released when the object is destroyed.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Map a file
+     *
+     * @param path Path of the file
+     * @return std::shared_ptr<MappedFile> The mapping, or null if the file
+     *         cannot be opened or mapped
+     */
+    static std::shared_ptr<MappedFile> Open(const std::string& path);
+
+    /**
+     * @brief Destructor; unmaps the file
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Get the first byte of the mapping
+     *
+     * @return const char* Mapped bytes
+     */
+    const char* GetData() const {
+        return m_data;
+    }
+
+    /**
+     * @brief Get the size of the mapping
+     *
+     * @return size_t Size in bytes
+     */
+    size_t GetSize() const {
+        return m_size;
+    }
+
+private:
+    MappedFile(const char* data, size_t size) : m_data(data), m_size(size) {}
+
+    const char* m_data;
+    size_t m_size;
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_MAPPED_FILE_H
@@ -0,0 +1,20 @@
+// memory_budget.cpp
+#include "memory_budget.h"
+
+namespace ai_framework {
+
+MemoryBudget& MemoryBudget::GetInstance() {
+    static MemoryBudget instance;
+    return instance;
+}
+
+MemoryBudgetStats MemoryBudget::GetStats() const {
+    MemoryBudgetStats stats;
+    stats.limitBytes = m_limitBytes.load(std::memory_order_relaxed);
+    stats.usedBytes = m_usedBytes.load(std::memory_order_relaxed);
+    stats.evictions = m_evictions.load(std::memory_order_relaxed);
+    stats.evictedBytes = m_evictedBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace ai_framework
@@ -0,0 +1,104 @@
+// memory_budget.h
+#ifndef AI_FRAMEWORK_MEMORY_BUDGET_H
+#define AI_FRAMEWORK_MEMORY_BUDGET_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ai_framework {
+
+/**
+ * @brief Counters of the process-wide memory budget
+ */
+struct MemoryBudgetStats {
+    /** Configured ceiling in bytes, 0 for none */
+    uint64_t limitBytes;
+
+    /** Bytes charged by all learning memories */
+    int64_t usedBytes;
+
+    /** Keys evicted by any learning memory */
+    uint64_t evictions;
+
+    /** Bytes freed by those evictions */
+    uint64_t evictedBytes;
+};
+
+/**
+ * @brief Process-wide byte ceiling shared by all learning memories
+ *
+ * Memories charge their growth in batches and evict their own keys while
+ * the total is over the limit, so agents together stay within the ceiling
+ * even if each is within its own budget.
+ */
+class MemoryBudget {
+public:
+    /**
+     * @brief Get the singleton instance of MemoryBudget
+     *
+     * @return MemoryBudget& Reference to the MemoryBudget instance
+     */
+    static MemoryBudget& GetInstance();
+
+    /**
+     * @brief Set the ceiling
+     *
+     * @param limitBytes Bytes all memories may use together, 0 for no limit
+     */
+    void SetLimit(uint64_t limitBytes) {
+        m_limitBytes.store(limitBytes, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Add to or subtract from the charged bytes
+     *
+     * @param bytes Change in bytes
+     */
+    void Charge(int64_t bytes) {
+        m_usedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get how far the charged bytes exceed the ceiling
+     *
+     * @return uint64_t Bytes over the limit, 0 if within it or unlimited
+     */
+    uint64_t GetOverage() const {
+        uint64_t limit = m_limitBytes.load(std::memory_order_relaxed);
+        int64_t used = m_usedBytes.load(std::memory_order_relaxed);
+        return limit == 0 || used <= static_cast<int64_t>(limit) ? 0 : static_cast<uint64_t>(used) - limit;
+    }
+
+    /**
+     * @brief Count evicted keys
+     *
+     * @param keys Keys evicted
+     * @param bytes Bytes they freed
+     */
+    void RecordEvictions(uint64_t keys, uint64_t bytes) {
+        m_evictions.fetch_add(keys, std::memory_order_relaxed);
+        m_evictedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the budget counters
+     *
+     * @return MemoryBudgetStats Current counters
+     */
+    MemoryBudgetStats GetStats() const;
+
+private:
+    MemoryBudget() = default;
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    std::atomic<uint64_t> m_limitBytes{0};
+    std::atomic<int64_t> m_usedBytes{0};
+    std::atomic<uint64_t> m_evictions{0};
+    std::atomic<uint64_t> m_evictedBytes{0};
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_MEMORY_BUDGET_H
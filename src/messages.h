@@ -2,6 +2,7 @@
 #ifndef AI_FRAMEWORK_MESSAGES_H
 #define AI_FRAMEWORK_MESSAGES_H
 
+#include <cstdint>
 #include <string>
 #include <so_5/all.hpp>
 
@@ -63,6 +64,9 @@ struct AgentMessage final : public so_5::message_t {
     /** Mbox for sending back the response */
     so_5::mbox_t replyTo;
     
+    /** Sender's tag for the request, copied into the response */
+    uint64_t requestId;
+    
     /**
      * @brief Constructor for AgentMessage
      * 
@@ -70,16 +74,19 @@ struct AgentMessage final : public so_5::message_t {
      * @param tgt ID of the target agent
      * @param cnt Content of the message
      * @param reply Mbox for sending back the response
+     * @param request Sender's tag for the request
      */
     AgentMessage(
         std::string src,
         std::string tgt,
         std::string cnt,
-        so_5::mbox_t reply)
+        so_5::mbox_t reply,
+        uint64_t request = 0)
         : sourceId(std::move(src)),
           targetId(std::move(tgt)),
           content(std::move(cnt)),
-          replyTo(std::move(reply)) {}
+          replyTo(std::move(reply)),
+          requestId(request) {}
 };
 
 /**
@@ -92,14 +99,25 @@ struct AgentResponse final : public so_5::message_t {
     /** Response content */
     std::string content;
     
+    /** Tag of the request this answers */
+    uint64_t requestId;
+    
+    /** Why the message could not be processed, empty on success */
+    std::string error;
+    
     /**
      * @brief Constructor for AgentResponse
      * 
      * @param id ID of the responding agent
      * @param cnt Response content
+     * @param request Tag of the request this answers
+     * @param err Why the message could not be processed, empty on success
      */
-    AgentResponse(std::string id, std::string cnt)
-        : agentId(std::move(id)), content(std::move(cnt)) {}
+    AgentResponse(std::string id, std::string cnt, uint64_t request = 0, std::string err = "")
+        : agentId(std::move(id)),
+          content(std::move(cnt)),
+          requestId(request),
+          error(std::move(err)) {}
 };
 
 } // namespace messages
@@ -0,0 +1,746 @@
+// pattern_set_matcher.cpp
+#include "pattern_set_matcher.h"
+#include <algorithm>
+#include <cctype>
+
+namespace ai_framework {
+
+namespace {
+
+/** Largest bounded repeat count compiled into the NFA */
+constexpr int MAX_REPEAT = 1000;
+
+/** Largest number of NFA nodes a single pattern may expand to */
+constexpr size_t MAX_PATTERN_NODES = 20000;
+
+/**
+ * @brief Thrown internally when a pattern is outside the supported subset
+ */
+struct UnsupportedSyntax {};
+
+std::bitset<256> ClassOf(int (*predicate)(int)) {
+    std::bitset<256> bytes;
+    for (int c = 0; c < 256; ++c) {
+        if (predicate(c)) {
+            bytes.set(static_cast<size_t>(c));
+        }
+    }
+    return bytes;
+}
+
+int IsWordChar(int c) {
+    return std::isalnum(c) || c == '_';
+}
+
+} // namespace
+
+/**
+ * @brief Parsed regular expression
+ */
+struct PatternSetMatcher::SyntaxNode {
+    enum class Type { Empty, Bytes, Concat, Alternate, Repeat, AssertBegin, AssertEnd };
+
+    Type type = Type::Empty;
+    std::bitset<256> bytes;
+    std::vector<SyntaxNode> children;
+    int min = 0;
+    int max = -1;
+};
+
+/**
+ * @brief Partially built NFA with dangling exits
+ */
+struct PatternSetMatcher::Fragment {
+    /** Entry node */
+    int start;
+
+    /** Exits to patch, as (node, successor slot) pairs */
+    std::vector<std::pair<int, int>> outs;
+};
+
+/**
+ * @brief Recursive descent parser for the supported ECMAScript subset
+ */
+class PatternSetMatcher::Parser {
+public:
+    Parser(const std::string& pattern, bool icase)
+        : m_pattern(pattern), m_pos(0), m_icase(icase) {
+    }
+
+    SyntaxNode Parse() {
+        SyntaxNode node = ParseDisjunction();
+        if (m_pos != m_pattern.size()) {
+            throw UnsupportedSyntax();
+        }
+        return node;
+    }
+
+private:
+    const std::string& m_pattern;
+    size_t m_pos;
+    bool m_icase;
+
+    bool AtEnd() const {
+        return m_pos >= m_pattern.size();
+    }
+
+    char Peek() const {
+        return m_pattern[m_pos];
+    }
+
+    char Next() {
+        if (AtEnd()) {
+            throw UnsupportedSyntax();
+        }
+        return m_pattern[m_pos++];
+    }
+
+    SyntaxNode MakeBytes(std::bitset<256> bytes, bool negate) const {
+        if (m_icase) {
+            std::bitset<256> folded = bytes;
+            for (int c = 0; c < 256; ++c) {
+                if (bytes.test(static_cast<size_t>(c))) {
+                    folded.set(static_cast<size_t>(std::tolower(c)));
+                    folded.set(static_cast<size_t>(std::toupper(c)));
+                }
+            }
+            bytes = folded;
+        }
+
+        SyntaxNode node;
+        node.type = SyntaxNode::Type::Bytes;
+        node.bytes = negate ? ~bytes : bytes;
+        return node;
+    }
+
+    SyntaxNode ParseDisjunction() {
+        SyntaxNode node;
+        node.type = SyntaxNode::Type::Alternate;
+        node.children.push_back(ParseAlternative());
+        while (!AtEnd() && Peek() == '|') {
+            ++m_pos;
+            node.children.push_back(ParseAlternative());
+        }
+        return node.children.size() == 1 ? std::move(node.children.front()) : node;
+    }
+
+    SyntaxNode ParseAlternative() {
+        SyntaxNode node;
+        node.type = SyntaxNode::Type::Concat;
+        while (!AtEnd() && Peek() != '|' && Peek() != ')') {
+            node.children.push_back(ParseTerm());
+        }
+        return node;
+    }
+
+    SyntaxNode ParseTerm() {
+        char c = Peek();
+        if (c == '^' || c == '$') {
+            ++m_pos;
+            if (!AtEnd() && std::string("*+?{").find(Peek()) != std::string::npos) {
+                throw UnsupportedSyntax();
+            }
+            SyntaxNode node;
+            node.type = (c == '^') ? SyntaxNode::Type::AssertBegin : SyntaxNode::Type::AssertEnd;
+            return node;
+        }
+
+        SyntaxNode atom = ParseAtom();
+        if (AtEnd()) {
+            return atom;
+        }
+
+        int min = 0;
+        int max = -1;
+        switch (Peek()) {
+            case '*':
+                ++m_pos;
+                break;
+            case '+':
+                ++m_pos;
+                min = 1;
+                break;
+            case '?':
+                ++m_pos;
+                max = 1;
+                break;
+            case '{':
+                ++m_pos;
+                min = ParseCount();
+                max = min;
+                if (!AtEnd() && Peek() == ',') {
+                    ++m_pos;
+                    max = (!AtEnd() && Peek() == '}') ? -1 : ParseCount();
+                }
+                if (Next() != '}' || (max != -1 && max < min)) {
+                    throw UnsupportedSyntax();
+                }
+                break;
+            default:
+                return atom;
+        }
+
+        // Lazy quantifiers accept the same language
+        if (!AtEnd() && Peek() == '?') {
+            ++m_pos;
+        }
+        if (!AtEnd() && std::string("*+?{").find(Peek()) != std::string::npos) {
+            throw UnsupportedSyntax();
+        }
+
+        SyntaxNode node;
+        node.type = SyntaxNode::Type::Repeat;
+        node.min = min;
+        node.max = max;
+        node.children.push_back(std::move(atom));
+        return node;
+    }
+
+    int ParseCount() {
+        int value = 0;
+        size_t start = m_pos;
+        while (!AtEnd() && std::isdigit(static_cast<unsigned char>(Peek()))) {
+            value = value * 10 + (Next() - '0');
+            if (value > MAX_REPEAT) {
+                throw UnsupportedSyntax();
+            }
+        }
+        if (m_pos == start) {
+            throw UnsupportedSyntax();
+        }
+        return value;
+    }
+
+    SyntaxNode ParseAtom() {
+        char c = Next();
+        switch (c) {
+            case '.': {
+                std::bitset<256> bytes;
+                bytes.set('\n');
+                bytes.set('\r');
+                return MakeBytes(bytes, true);
+            }
+            case '(': {
+                if (!AtEnd() && Peek() == '?') {
+                    ++m_pos;
+                    if (Next() != ':') {
+                        throw UnsupportedSyntax();
+                    }
+                }
+                SyntaxNode node = ParseDisjunction();
+                if (Next() != ')') {
+                    throw UnsupportedSyntax();
+                }
+                return node;
+            }
+            case '[':
+                return ParseClass();
+            case '\\': {
+                bool negate = false;
+                std::bitset<256> bytes = ParseEscape(false, negate);
+                return MakeBytes(bytes, negate);
+            }
+            case '*': case '+': case '?': case '{': case '}':
+            case ']': case ')': case '|':
+                throw UnsupportedSyntax();
+            default: {
+                std::bitset<256> bytes;
+                bytes.set(static_cast<unsigned char>(c));
+                return MakeBytes(bytes, false);
+            }
+        }
+    }
+
+    std::bitset<256> ParseEscape(bool inClass, bool& negate) {
+        char c = Next();
+        negate = false;
+        std::bitset<256> bytes;
+        switch (c) {
+            case 'd': case 'D':
+                bytes = ClassOf(std::isdigit);
+                negate = (c == 'D');
+                break;
+            case 'w': case 'W':
+                bytes = ClassOf(IsWordChar);
+                negate = (c == 'W');
+                break;
+            case 's': case 'S':
+                bytes = ClassOf(std::isspace);
+                negate = (c == 'S');
+                break;
+            case 't': bytes.set('\t'); break;
+            case 'n': bytes.set('\n'); break;
+            case 'r': bytes.set('\r'); break;
+            case 'v': bytes.set('\v'); break;
+            case 'f': bytes.set('\f'); break;
+            case '0':
+                if (!AtEnd() && std::isdigit(static_cast<unsigned char>(Peek()))) {
+                    throw UnsupportedSyntax();
+                }
+                bytes.set(0);
+                break;
+            case 'x': {
+                int value = 0;
+                for (int i = 0; i < 2; ++i) {
+                    char h = Next();
+                    if (!std::isxdigit(static_cast<unsigned char>(h))) {
+                        throw UnsupportedSyntax();
+                    }
+                    value = value * 16 + (std::isdigit(static_cast<unsigned char>(h)) ?
+                        h - '0' : std::tolower(static_cast<unsigned char>(h)) - 'a' + 10);
+                }
+                bytes.set(static_cast<size_t>(value));
+                break;
+            }
+            default:
+                // Back-references, \b, \B, \c, \u and unknown letters stay
+                // with std::regex
+                if (std::isalnum(static_cast<unsigned char>(c)) || (inClass && c == '-')) {
+                    throw UnsupportedSyntax();
+                }
+                bytes.set(static_cast<unsigned char>(c));
+                break;
+        }
+        return bytes;
+    }
+
+    SyntaxNode ParseClass() {
+        bool negate = false;
+        if (!AtEnd() && Peek() == '^') {
+            negate = true;
+            ++m_pos;
+        }
+        // Empty classes and POSIX [:name:] syntax are left to std::regex
+        if (!AtEnd() && Peek() == ']') {
+            throw UnsupportedSyntax();
+        }
+
+        std::bitset<256> bytes;
+        while (true) {
+            char c = Next();
+            if (c == ']') {
+                break;
+            }
+            if (c == '[') {
+                throw UnsupportedSyntax();
+            }
+
+            int low = static_cast<unsigned char>(c);
+            if (c == '\\') {
+                bool escapeNegate = false;
+                std::bitset<256> escape = ParseEscape(true, escapeNegate);
+                if (escapeNegate || escape.count() != 1) {
+                    bytes |= escapeNegate ? ~escape : escape;
+                    if (!AtEnd() && Peek() == '-' &&
+                        m_pos + 1 < m_pattern.size() && m_pattern[m_pos + 1] != ']') {
+                        throw UnsupportedSyntax();
+                    }
+                    continue;
+                }
+                low = 0;
+                while (!escape.test(static_cast<size_t>(low))) {
+                    ++low;
+                }
+            }
+
+            int high = low;
+            if (!AtEnd() && Peek() == '-' &&
+                m_pos + 1 < m_pattern.size() && m_pattern[m_pos + 1] != ']') {
+                ++m_pos;
+                char h = Next();
+                if (h == '\\' || h == '[') {
+                    throw UnsupportedSyntax();
+                }
+                high = static_cast<unsigned char>(h);
+                if (high < low) {
+                    throw UnsupportedSyntax();
+                }
+            }
+
+            for (int b = low; b <= high; ++b) {
+                bytes.set(static_cast<size_t>(b));
+            }
+        }
+        return MakeBytes(bytes, negate);
+    }
+};
+
+PatternSetMatcher::DfaState::DfaState() {
+    for (auto& next : this->next) {
+        next.store(-1, std::memory_order_relaxed);
+    }
+}
+
+PatternSetMatcher::DfaCache::DfaCache()
+    : states(MAX_DFA_STATES),
+      begin(-1) {
+}
+
+PatternSetMatcher::PatternSetMatcher(bool icase)
+    : m_icase(icase),
+      m_currentId(0),
+      m_patternBase(0),
+      m_dfa(std::make_shared<DfaCache>()),
+      m_dfaFlushes(0) {
+    for (int c = 0; c < 256; ++c) {
+        m_fold[static_cast<size_t>(c)] =
+            static_cast<unsigned char>(icase ? std::tolower(c) : c);
+    }
+}
+
+bool PatternSetMatcher::AddPattern(const std::string& pattern, size_t id) {
+    SyntaxNode syntax;
+    try {
+        syntax = Parser(pattern, m_icase).Parse();
+    }
+    catch (const UnsupportedSyntax&) {
+        return false;
+    }
+
+    m_patternBase = m_nodes.size();
+    m_currentId = id;
+    try {
+        Fragment fragment = Compile(syntax);
+        int match = AddNode(NfaNode::Type::Match);
+        Patch(fragment.outs, match);
+        m_starts.push_back(fragment.start);
+    }
+    catch (const UnsupportedSyntax&) {
+        m_nodes.resize(m_patternBase);
+        return false;
+    }
+
+    ResetDfa();
+    return true;
+}
+
+size_t PatternSetMatcher::GetPatternCount() const {
+    return m_starts.size();
+}
+
+size_t PatternSetMatcher::GetDfaFlushCount() const {
+    return m_dfaFlushes.load(std::memory_order_relaxed);
+}
+
+int PatternSetMatcher::AddNode(NfaNode::Type type) {
+    if (m_nodes.size() - m_patternBase >= MAX_PATTERN_NODES) {
+        throw UnsupportedSyntax();
+    }
+    NfaNode node;
+    node.type = type;
+    node.id = m_currentId;
+    m_nodes.push_back(node);
+    return static_cast<int>(m_nodes.size() - 1);
+}
+
+void PatternSetMatcher::Patch(const std::vector<std::pair<int, int>>& outs, int target) {
+    for (const auto& out : outs) {
+        NfaNode& node = m_nodes[static_cast<size_t>(out.first)];
+        (out.second == 0 ? node.out : node.out1) = target;
+    }
+}
+
+PatternSetMatcher::Fragment PatternSetMatcher::Compile(const SyntaxNode& syntax) {
+    switch (syntax.type) {
+        case SyntaxNode::Type::Bytes: {
+            int node = AddNode(NfaNode::Type::Bytes);
+            m_nodes[static_cast<size_t>(node)].bytes = syntax.bytes;
+            return Fragment{node, {{node, 0}}};
+        }
+        case SyntaxNode::Type::AssertBegin:
+        case SyntaxNode::Type::AssertEnd: {
+            int node = AddNode(syntax.type == SyntaxNode::Type::AssertBegin ?
+                NfaNode::Type::AssertBegin : NfaNode::Type::AssertEnd);
+            return Fragment{node, {{node, 0}}};
+        }
+        case SyntaxNode::Type::Concat: {
+            if (syntax.children.empty()) {
+                break;
+            }
+            Fragment result = Compile(syntax.children.front());
+            for (size_t i = 1; i < syntax.children.size(); ++i) {
+                Fragment next = Compile(syntax.children[i]);
+                Patch(result.outs, next.start);
+                result.outs = std::move(next.outs);
+            }
+            return result;
+        }
+        case SyntaxNode::Type::Alternate: {
+            Fragment result = Compile(syntax.children.back());
+            for (size_t i = syntax.children.size() - 1; i-- > 0;) {
+                Fragment branch = Compile(syntax.children[i]);
+                int split = AddNode(NfaNode::Type::Split);
+                m_nodes[static_cast<size_t>(split)].out = branch.start;
+                m_nodes[static_cast<size_t>(split)].out1 = result.start;
+                branch.outs.insert(branch.outs.end(), result.outs.begin(), result.outs.end());
+                result = Fragment{split, std::move(branch.outs)};
+            }
+            return result;
+        }
+        case SyntaxNode::Type::Repeat: {
+            const SyntaxNode& child = syntax.children.front();
+            SyntaxNode sequence;
+            sequence.type = SyntaxNode::Type::Concat;
+            for (int i = 0; i < syntax.min; ++i) {
+                sequence.children.push_back(child);
+            }
+            Fragment result = Compile(sequence);
+
+            int optional = (syntax.max < 0) ? 1 : syntax.max - syntax.min;
+            for (int i = 0; i < optional; ++i) {
+                Fragment body = Compile(child);
+                int split = AddNode(NfaNode::Type::Split);
+                m_nodes[static_cast<size_t>(split)].out = body.start;
+                Fragment next{split, {{split, 1}}};
+                if (syntax.max < 0) {
+                    Patch(body.outs, split);
+                }
+                else {
+                    next.outs.insert(next.outs.end(), body.outs.begin(), body.outs.end());
+                }
+                Patch(result.outs, next.start);
+                result.outs = std::move(next.outs);
+            }
+            return result;
+        }
+        case SyntaxNode::Type::Empty:
+            break;
+    }
+
+    int node = AddNode(NfaNode::Type::Empty);
+    return Fragment{node, {{node, 0}}};
+}
+
+void PatternSetMatcher::Closure(
+    std::vector<int>& seeds,
+    bool atBegin,
+    bool atEnd,
+    std::vector<int>& nodes,
+    size_t& match) const {
+
+    std::vector<char> visited(m_nodes.size(), 0);
+    std::vector<size_t> matched;
+    nodes.clear();
+    match = NO_MATCH;
+
+    while (!seeds.empty()) {
+        int index = seeds.back();
+        seeds.pop_back();
+        if (index < 0 || visited[static_cast<size_t>(index)]) {
+            continue;
+        }
+        visited[static_cast<size_t>(index)] = 1;
+
+        const NfaNode& node = m_nodes[static_cast<size_t>(index)];
+        switch (node.type) {
+            case NfaNode::Type::Bytes:
+                nodes.push_back(index);
+                break;
+            case NfaNode::Type::Split:
+                seeds.push_back(node.out1);
+                seeds.push_back(node.out);
+                break;
+            case NfaNode::Type::Empty:
+                seeds.push_back(node.out);
+                break;
+            case NfaNode::Type::AssertBegin:
+                if (atBegin) {
+                    seeds.push_back(node.out);
+                }
+                break;
+            case NfaNode::Type::AssertEnd:
+                if (atEnd) {
+                    seeds.push_back(node.out);
+                }
+                else {
+                    nodes.push_back(index);
+                }
+                break;
+            case NfaNode::Type::Match:
+                matched.push_back(node.id);
+                match = std::min(match, node.id);
+                break;
+        }
+    }
+
+    // A pattern that already matched cannot change the result again, so its
+    // threads are dropped; this keeps the number of distinct states small
+    if (!matched.empty()) {
+        nodes.erase(
+            std::remove_if(nodes.begin(), nodes.end(), [&](int index) {
+                size_t id = m_nodes[static_cast<size_t>(index)].id;
+                return std::find(matched.begin(), matched.end(), id) != matched.end();
+            }),
+            nodes.end());
+    }
+    std::sort(nodes.begin(), nodes.end());
+}
+
+void PatternSetMatcher::Advance(
+    const std::vector<int>& nodes,
+    unsigned char c,
+    std::vector<int>& next,
+    size_t& match) const {
+
+    // Every position is also a potential match start (unanchored search)
+    std::vector<int> seeds(m_starts.rbegin(), m_starts.rend());
+    for (int index : nodes) {
+        const NfaNode& node = m_nodes[static_cast<size_t>(index)];
+        if (node.type == NfaNode::Type::Bytes && node.bytes.test(c)) {
+            seeds.push_back(node.out);
+        }
+    }
+    Closure(seeds, false, false, next, match);
+}
+
+size_t PatternSetMatcher::EndMatch(const std::vector<int>& nodes, bool atBegin) const {
+    std::vector<int> seeds;
+    for (int index : nodes) {
+        const NfaNode& node = m_nodes[static_cast<size_t>(index)];
+        if (node.type == NfaNode::Type::AssertEnd) {
+            seeds.push_back(node.out);
+        }
+    }
+    if (seeds.empty()) {
+        return NO_MATCH;
+    }
+
+    std::vector<int> unused;
+    size_t match = NO_MATCH;
+    Closure(seeds, atBegin, true, unused, match);
+    return match;
+}
+
+int PatternSetMatcher::BeginState(DfaCache& cache) const {
+    int state = cache.begin.load(std::memory_order_acquire);
+    if (state >= 0) {
+        return state;
+    }
+
+    std::lock_guard<std::mutex> lock(m_dfaMutex);
+    ComputeBeginState(cache);
+    return cache.begin.load(std::memory_order_relaxed);
+}
+
+void PatternSetMatcher::ComputeBeginState(DfaCache& cache) const {
+    if (cache.begin.load(std::memory_order_relaxed) >= 0) {
+        return;
+    }
+
+    std::vector<int> seeds(m_starts.rbegin(), m_starts.rend());
+    std::vector<int> nodes;
+    size_t match = NO_MATCH;
+    Closure(seeds, true, false, nodes, match);
+
+    // Always the first state of its cache, so there is room for it
+    cache.emptyMatch = std::min(match, EndMatch(nodes, true));
+    int state = InternState(cache, std::move(nodes), match);
+    cache.begin.store(state, std::memory_order_release);
+}
+
+int PatternSetMatcher::ComputeTransition(
+    std::shared_ptr<DfaCache>& cache,
+    const DfaState*& state,
+    unsigned char c) const {
+
+    std::lock_guard<std::mutex> lock(m_dfaMutex);
+    int next = state->next[c].load(std::memory_order_relaxed);
+    if (next >= 0) {
+        return next;
+    }
+
+    std::vector<int> nodes;
+    size_t match = NO_MATCH;
+    Advance(state->nodes, c, nodes, match);
+    next = InternState(*cache, nodes, match);
+    if (next < 0) {
+        // Cache is full: carry the current state over to a fresh cache
+        // and keep running the DFA there
+        std::shared_ptr<DfaCache> fresh = FlushDfa(cache);
+        int from = InternState(*fresh, state->nodes, state->match);
+        next = InternState(*fresh, std::move(nodes), match);
+        cache = std::move(fresh);
+        state = cache->states[static_cast<size_t>(from)].get();
+    }
+
+    // Publish only after the target state is fully built
+    const_cast<DfaState*>(state)->next[c].store(next, std::memory_order_release);
+    return next;
+}
+
+int PatternSetMatcher::InternState(DfaCache& cache, std::vector<int> nodes, size_t match) const {
+    std::vector<int> key = nodes;
+    key.push_back(match == NO_MATCH ? -1 : static_cast<int>(match));
+
+    auto it = cache.index.find(key);
+    if (it != cache.index.end()) {
+        return it->second;
+    }
+    if (cache.count >= MAX_DFA_STATES) {
+        return -1;
+    }
+
+    auto state = std::make_unique<DfaState>();
+    state->endMatch = EndMatch(nodes, false);
+    state->match = match;
+    state->nodes = std::move(nodes);
+
+    int index = static_cast<int>(cache.count++);
+    cache.states[static_cast<size_t>(index)] = std::move(state);
+    cache.index.emplace(std::move(key), index);
+    return index;
+}
+
+std::shared_ptr<PatternSetMatcher::DfaCache> PatternSetMatcher::FlushDfa(
+    const std::shared_ptr<DfaCache>& full) const {
+
+    // Another search may have flushed already; its cache will do if it can
+    // still take the two states being carried over
+    std::shared_ptr<DfaCache> current = std::atomic_load(&m_dfa);
+    if (current != full && current->count + 2 <= MAX_DFA_STATES) {
+        return current;
+    }
+
+    current = std::make_shared<DfaCache>();
+    ComputeBeginState(*current);
+    std::atomic_store(&m_dfa, current);
+    m_dfaFlushes.fetch_add(1, std::memory_order_relaxed);
+    return current;
+}
+
+size_t PatternSetMatcher::FindFirstMatch(const std::string& text) const {
+    // Held for the whole search, so a flush never frees states in use
+    std::shared_ptr<DfaCache> cache = std::atomic_load(&m_dfa);
+    int begin = BeginState(*cache);
+    if (text.empty()) {
+        return cache->emptyMatch;
+    }
+
+    const DfaState* state = cache->states[static_cast<size_t>(begin)].get();
+    size_t best = state->match;
+
+    for (size_t pos = 0; pos < text.size(); ++pos) {
+        if (best == 0) {
+            return best;
+        }
+
+        unsigned char c = m_fold[static_cast<unsigned char>(text[pos])];
+        int next = state->next[c].load(std::memory_order_acquire);
+        if (next < 0) {
+            next = ComputeTransition(cache, state, c);
+        }
+
+        state = cache->states[static_cast<size_t>(next)].get();
+        best = std::min(best, state->match);
+    }
+
+    return std::min(best, state->endMatch);
+}
+
+void PatternSetMatcher::ResetDfa() {
+    std::lock_guard<std::mutex> lock(m_dfaMutex);
+    std::atomic_store(&m_dfa, std::make_shared<DfaCache>());
+    m_dfaFlushes.store(0, std::memory_order_relaxed);
+}
+
+} // namespace ai_framework
@@ -0,0 +1,197 @@
+// pattern_set_matcher.h
+#ifndef AI_FRAMEWORK_PATTERN_SET_MATCHER_H
+#define AI_FRAMEWORK_PATTERN_SET_MATCHER_H
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief Matches a message against many regular expressions in one pass
+ *
+ * All patterns are compiled into a single NFA which is searched through a
+ * lazily built DFA, so a search costs one table lookup per input byte no
+ * matter how many patterns are loaded and can never backtrack. Only the
+ * regular subset of the ECMAScript grammar is supported; patterns using
+ * back-references, lookaround or word boundaries are rejected by AddPattern
+ * so the caller can evaluate them with std::regex instead.
+ */
+class PatternSetMatcher {
+public:
+    /** Returned by FindFirstMatch when no pattern matches */
+    static constexpr size_t NO_MATCH = static_cast<size_t>(-1);
+
+    /** Maximum number of DFA states kept in the transition cache before it is flushed */
+    static constexpr size_t MAX_DFA_STATES = 4096;
+
+    /**
+     * @brief Constructor for PatternSetMatcher
+     *
+     * @param icase Whether patterns match case-insensitively
+     */
+    explicit PatternSetMatcher(bool icase);
+
+    /**
+     * @brief Add a pattern to the set
+     *
+     * Must not be called while another thread is searching.
+     *
+     * @param pattern ECMAScript regular expression
+     * @param id Identifier reported on a match (lower ids win)
+     * @return bool True if the pattern was added, false if its syntax is unsupported
+     */
+    bool AddPattern(const std::string& pattern, size_t id);
+
+    /**
+     * @brief Search a text for all patterns at once
+     *
+     * Safe to call from several threads concurrently.
+     *
+     * @param text The text to search
+     * @return size_t Lowest id of a pattern found anywhere in the text, or NO_MATCH
+     */
+    size_t FindFirstMatch(const std::string& text) const;
+
+    /**
+     * @brief Get the number of patterns in the set
+     *
+     * @return size_t Number of patterns added successfully
+     */
+    size_t GetPatternCount() const;
+
+    /**
+     * @brief Get the number of times the DFA cache filled up and was flushed
+     *
+     * @return size_t Number of flushes since the last pattern was added
+     */
+    size_t GetDfaFlushCount() const;
+
+private:
+    /**
+     * @brief Node of the combined Thompson NFA
+     */
+    struct NfaNode {
+        enum class Type { Bytes, Split, Empty, AssertBegin, AssertEnd, Match };
+
+        /** Kind of node */
+        Type type;
+
+        /** Bytes accepted by a Bytes node */
+        std::bitset<256> bytes;
+
+        /** Successor node */
+        int out = -1;
+
+        /** Second successor of a Split node */
+        int out1 = -1;
+
+        /** Id of the pattern this node belongs to */
+        size_t id = 0;
+    };
+
+    /**
+     * @brief Cached DFA state (a set of NFA nodes)
+     */
+    struct DfaState {
+        /** Sorted Bytes nodes and pending end-of-text assertions */
+        std::vector<int> nodes;
+
+        /** Lowest pattern id matched on entering this state */
+        size_t match = NO_MATCH;
+
+        /** Lowest pattern id matched if the text ends in this state */
+        size_t endMatch = NO_MATCH;
+
+        /** Successor state per input byte, -1 until computed */
+        std::array<std::atomic<int>, 256> next;
+
+        DfaState();
+    };
+
+    /**
+     * @brief One generation of lazily built DFA states
+     *
+     * A full cache is replaced by an empty one rather than cleared, so
+     * searches still walking the old states keep them alive until they
+     * move over or finish.
+     */
+    struct DfaCache {
+        /** DFA states by node set, used to share states */
+        std::map<std::vector<int>, int> index;
+
+        /** DFA states, fixed capacity so readers never see a reallocation */
+        std::vector<std::unique_ptr<DfaState>> states;
+
+        /** Number of DFA states in use */
+        size_t count = 0;
+
+        /** State at the beginning of the text, -1 until computed */
+        std::atomic<int> begin;
+
+        /** Lowest pattern id matching the empty text, set with begin */
+        size_t emptyMatch = NO_MATCH;
+
+        DfaCache();
+    };
+
+    struct SyntaxNode;
+    struct Fragment;
+    class Parser;
+
+    /** Whether matching ignores case */
+    bool m_icase;
+
+    /** Input byte translation (lower-casing when m_icase is set) */
+    std::array<unsigned char, 256> m_fold;
+
+    /** Nodes of the combined NFA */
+    std::vector<NfaNode> m_nodes;
+
+    /** Start node of every pattern */
+    std::vector<int> m_starts;
+
+    /** Pattern id used while compiling */
+    size_t m_currentId;
+
+    /** First NFA node of the pattern being compiled */
+    size_t m_patternBase;
+
+    /** Mutex guarding DFA construction */
+    mutable std::mutex m_dfaMutex;
+
+    /** Current DFA cache, read and replaced with std::atomic_load/store */
+    mutable std::shared_ptr<DfaCache> m_dfa;
+
+    /** Number of times a full DFA cache was replaced */
+    mutable std::atomic<size_t> m_dfaFlushes;
+
+    int AddNode(NfaNode::Type type);
+    void Patch(const std::vector<std::pair<int, int>>& outs, int target);
+    Fragment Compile(const SyntaxNode& node);
+
+    void Closure(std::vector<int>& seeds, bool atBegin, bool atEnd,
+                 std::vector<int>& nodes, size_t& match) const;
+    void Advance(const std::vector<int>& nodes, unsigned char c,
+                 std::vector<int>& next, size_t& match) const;
+    size_t EndMatch(const std::vector<int>& nodes, bool atBegin) const;
+
+    int BeginState(DfaCache& cache) const;
+    void ComputeBeginState(DfaCache& cache) const;
+    int ComputeTransition(std::shared_ptr<DfaCache>& cache,
+                          const DfaState*& state, unsigned char c) const;
+    int InternState(DfaCache& cache, std::vector<int> nodes, size_t match) const;
+    std::shared_ptr<DfaCache> FlushDfa(const std::shared_ptr<DfaCache>& full) const;
+    void ResetDfa();
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_PATTERN_SET_MATCHER_H
@@ -0,0 +1,152 @@
+// rcu.cpp
+#include "rcu.h"
+#include <algorithm>
+#include <limits>
+
+namespace ai_framework {
+
+thread_local EpochDomain::LocalState EpochDomain::s_local;
+
+EpochDomain& EpochDomain::GetInstance() {
+    static EpochDomain instance;
+    return instance;
+}
+
+EpochDomain::~EpochDomain() {
+    for (auto& retired : m_retired) {
+        retired.second();
+    }
+
+    ThreadRecord* record = m_records.load(std::memory_order_acquire);
+    while (record) {
+        ThreadRecord* next = record->next;
+        delete record;
+        record = next;
+    }
+}
+
+EpochDomain::LocalState::~LocalState() {
+    // Hand the slot to the next thread that needs one
+    if (record) {
+        record->epoch.store(0, std::memory_order_release);
+        record->inUse.store(false, std::memory_order_release);
+    }
+}
+
+void EpochDomain::Enter() {
+    LocalState& local = s_local;
+    if (local.depth++ > 0) {
+        return;
+    }
+    if (!local.record) {
+        local.record = AcquireRecord();
+    }
+
+    // Announce before any protected pointer is loaded
+    local.record->epoch.store(m_epoch.load(std::memory_order_seq_cst),
+                              std::memory_order_seq_cst);
+}
+
+void EpochDomain::Exit() {
+    LocalState& local = s_local;
+    if (--local.depth > 0) {
+        return;
+    }
+    local.record->epoch.store(0, std::memory_order_release);
+
+    // The last reader out frees what it was holding back, unless a writer
+    // is busy with the list right now
+    if (m_retiredCount.load(std::memory_order_relaxed) > 0) {
+        std::vector<std::function<void()>> ready;
+        {
+            std::unique_lock<std::mutex> lock(m_retiredMutex, std::try_to_lock);
+            if (!lock.owns_lock()) {
+                return;
+            }
+            ready = TakeReclaimable();
+        }
+        for (auto& deleter : ready) {
+            deleter();
+        }
+    }
+}
+
+void EpochDomain::Retire(std::function<void()> deleter) {
+    // Readers that announced this epoch or earlier may hold the object;
+    // anyone entering after the increment already sees its replacement
+    uint64_t epoch = m_epoch.fetch_add(1, std::memory_order_seq_cst);
+
+    std::lock_guard<std::mutex> lock(m_retiredMutex);
+    m_retired.emplace_back(epoch, std::move(deleter));
+    m_retiredCount.store(m_retired.size(), std::memory_order_relaxed);
+}
+
+size_t EpochDomain::Reclaim() {
+    std::vector<std::function<void()>> ready;
+    size_t pending = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_retiredMutex);
+        ready = TakeReclaimable();
+        pending = m_retired.size();
+    }
+
+    // Run deleters outside the lock, they may retire objects themselves
+    for (auto& deleter : ready) {
+        deleter();
+    }
+    return pending;
+}
+
+std::vector<std::function<void()>> EpochDomain::TakeReclaimable() {
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for (ThreadRecord* record = m_records.load(std::memory_order_acquire);
+         record; record = record->next) {
+        uint64_t epoch = record->epoch.load(std::memory_order_seq_cst);
+        if (epoch != 0) {
+            oldest = std::min(oldest, epoch);
+        }
+    }
+
+    // Objects retired before the oldest announced epoch are unreachable
+    auto it = std::partition(m_retired.begin(), m_retired.end(),
+        [oldest](const std::pair<uint64_t, std::function<void()>>& retired) {
+            return retired.first >= oldest;
+        });
+
+    std::vector<std::function<void()>> ready;
+    for (auto freed = it; freed != m_retired.end(); ++freed) {
+        ready.push_back(std::move(freed->second));
+    }
+    m_retired.erase(it, m_retired.end());
+    m_retiredCount.store(m_retired.size(), std::memory_order_relaxed);
+    return ready;
+}
+
+size_t EpochDomain::GetPendingCount() const {
+    return m_retiredCount.load(std::memory_order_relaxed);
+}
+
+EpochDomain::ThreadRecord* EpochDomain::AcquireRecord() {
+    // Reuse a slot left behind by a finished thread
+    for (ThreadRecord* record = m_records.load(std::memory_order_acquire);
+         record; record = record->next) {
+        bool expected = false;
+        if (!record->inUse.load(std::memory_order_relaxed) &&
+            record->inUse.compare_exchange_strong(expected, true,
+                                                  std::memory_order_acq_rel)) {
+            return record;
+        }
+    }
+
+    ThreadRecord* record = new ThreadRecord();
+    record->inUse.store(true, std::memory_order_relaxed);
+    ThreadRecord* head = m_records.load(std::memory_order_relaxed);
+    do {
+        record->next = head;
+    } while (!m_records.compare_exchange_weak(head, record,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+    return record;
+}
+
+} // namespace ai_framework
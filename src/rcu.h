@@ -0,0 +1,203 @@
+// rcu.h
+#ifndef AI_FRAMEWORK_RCU_H
+#define AI_FRAMEWORK_RCU_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief Process-wide epoch-based reclamation domain
+ *
+ * Readers announce the current epoch while they hold references obtained
+ * from an RcuPointer; writers retire replaced objects tagged with the epoch
+ * of the swap. A retired object is freed once no reader still announces an
+ * epoch at or before that swap. Readers never take a lock.
+ */
+class EpochDomain {
+public:
+    /**
+     * @brief Get the singleton instance of EpochDomain
+     *
+     * @return EpochDomain& Reference to the EpochDomain instance
+     */
+    static EpochDomain& GetInstance();
+
+    /**
+     * @brief Destructor; frees everything still retired
+     */
+    ~EpochDomain();
+
+    /**
+     * @brief Enter a read-side critical section (may nest)
+     */
+    void Enter();
+
+    /**
+     * @brief Leave a read-side critical section
+     */
+    void Exit();
+
+    /**
+     * @brief Hand over an object that readers may still be using
+     *
+     * @param deleter Called once no reader can reach the object any more
+     */
+    void Retire(std::function<void()> deleter);
+
+    /**
+     * @brief Free every retired object no reader can still reach
+     *
+     * @return size_t Number of objects still waiting for readers to drain
+     */
+    size_t Reclaim();
+
+    /**
+     * @brief Get the number of retired objects not yet freed
+     *
+     * @return size_t Number of pending objects
+     */
+    size_t GetPendingCount() const;
+
+private:
+    /**
+     * @brief Per-thread announcement slot
+     */
+    struct ThreadRecord {
+        /** Epoch announced by the owning thread, 0 when quiescent */
+        std::atomic<uint64_t> epoch{0};
+
+        /** Whether a live thread owns this record */
+        std::atomic<bool> inUse{false};
+
+        /** Next record in the domain's list */
+        ThreadRecord* next = nullptr;
+    };
+
+    /**
+     * @brief Thread-local reader state
+     */
+    struct LocalState {
+        ThreadRecord* record = nullptr;
+        unsigned depth = 0;
+        ~LocalState();
+    };
+
+    EpochDomain() = default;
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    ThreadRecord* AcquireRecord();
+
+    /**
+     * @brief Remove the retired objects no reader can reach; needs m_retiredMutex
+     *
+     * @return std::vector<std::function<void()>> Deleters to run
+     */
+    std::vector<std::function<void()>> TakeReclaimable();
+
+    /** Global epoch, starts at 1 so 0 can mean quiescent */
+    std::atomic<uint64_t> m_epoch{1};
+
+    /** Announcement slots, push-only list */
+    std::atomic<ThreadRecord*> m_records{nullptr};
+
+    /** Mutex guarding the retired list (writers only) */
+    mutable std::mutex m_retiredMutex;
+
+    /** Retired objects with the epoch they were retired in */
+    std::vector<std::pair<uint64_t, std::function<void()>>> m_retired;
+
+    /** Size of m_retired, readable without the mutex */
+    std::atomic<size_t> m_retiredCount{0};
+
+    static thread_local LocalState s_local;
+};
+
+/**
+ * @brief RAII read-side critical section
+ *
+ * Pointers loaded from an RcuPointer stay valid while a guard is alive on
+ * the loading thread.
+ */
+class EpochGuard {
+public:
+    EpochGuard() {
+        EpochDomain::GetInstance().Enter();
+    }
+
+    ~EpochGuard() {
+        EpochDomain::GetInstance().Exit();
+    }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+/**
+ * @brief Pointer whose target is replaced by atomic swap and reclaimed by epoch
+ *
+ * Load is a single atomic read and must be called under an EpochGuard.
+ * Store publishes a new object and retires the previous one, which is
+ * deleted once every reader that might have loaded it has left its guard.
+ */
+template <typename T>
+class RcuPointer {
+public:
+    /**
+     * @brief Constructor for RcuPointer
+     *
+     * @param initial Initial object, may be null
+     */
+    explicit RcuPointer(std::unique_ptr<T> initial = nullptr)
+        : m_pointer(initial.release()) {
+    }
+
+    /**
+     * @brief Destructor; no reader may still be using the current object
+     */
+    ~RcuPointer() {
+        delete m_pointer.load(std::memory_order_acquire);
+    }
+
+    RcuPointer(const RcuPointer&) = delete;
+    RcuPointer& operator=(const RcuPointer&) = delete;
+
+    /**
+     * @brief Read the current object
+     *
+     * @return T* Current object, valid until the caller's EpochGuard ends
+     */
+    T* Load() const {
+        return m_pointer.load(std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief Publish a new object and retire the old one
+     *
+     * @param value New object, may be null
+     */
+    void Store(std::unique_ptr<T> value) {
+        T* old = m_pointer.exchange(value.release(), std::memory_order_seq_cst);
+        EpochDomain& domain = EpochDomain::GetInstance();
+        if (old) {
+            domain.Retire([old]() { delete old; });
+        }
+        domain.Reclaim();
+    }
+
+private:
+    /** Current object */
+    std::atomic<T*> m_pointer;
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_RCU_H
@@ -1,168 +1,170 @@
 // rule_based_agent.cpp
 #include "rule_based_agent.h"
 #include "logging_service.h"
+#include "rule_set_cache.h"
 #include <nlohmann/json.hpp>
 #include <sstream>
-#include <algorithm>
 
 namespace ai_framework {
 
 RuleBasedAgent::RuleBasedAgent(so_5::environment_t& env, std::string id)
     : Agent(env, std::move(id)), 
-      m_defaultResponse("I don't have a specific rule for that."), 
-      m_mbox(so_direct_mbox()) {
+      m_snapshot(std::unique_ptr<const Snapshot>(
+          new Snapshot{nullptr, "I don't have a specific rule for that.", nullptr})), 
+      m_prefilterScans(0),
+      m_rulesEvaluated(0),
+      m_rulesEliminated(0) {
 }
 
 bool RuleBasedAgent::Initialize(const std::string& config) {
+    if (!ReloadRules(config)) {
+        return false;
+    }
+    
+    EpochGuard guard;
+    LoggingService::GetInstance().Log(
+        LogLevel::INFO, 
+        "RuleBasedAgent " + m_id + " initialized with " + 
+        std::to_string(m_snapshot.Load()->ruleSet->GetRuleCount()) + " rules");
+    
+    return true;
+}
+
+bool RuleBasedAgent::ReloadRules(const std::string& config) {
     try {
         // Parse configuration JSON
         nlohmann::json configJson = nlohmann::json::parse(config);
         
-        // Extract default response if provided
+        std::lock_guard<std::mutex> lock(m_reloadMutex);
+        auto snapshot = std::make_unique<Snapshot>();
+        
+        // Extract default response if provided, otherwise keep the current one
         if (configJson.contains("default_response")) {
-            m_defaultResponse = configJson["default_response"].get<std::string>();
+            snapshot->defaultResponse = configJson["default_response"].get<std::string>();
         }
-        
-        // Extract rules if provided
-        if (configJson.contains("rules")) {
-            auto rulesJson = configJson["rules"];
-            for (const auto& ruleJson : rulesJson) {
-                if (ruleJson.contains("pattern") && 
-                    ruleJson.contains("response")) {
-                    
-                    std::string pattern = ruleJson["pattern"].get<std::string>();
-                    std::string response = ruleJson["response"].get<std::string>();
-                    int priority = 0;
-                    
-                    if (ruleJson.contains("priority")) {
-                        priority = ruleJson["priority"].get<int>();
-                    }
-                    
-                    AddRule(pattern, response, priority);
-                }
-            }
+        else {
+            EpochGuard guard;
+            snapshot->defaultResponse = m_snapshot.Load()->defaultResponse;
         }
         
+        // Agents configured with the same rules share one compiled set
+        nlohmann::json rulesJson = configJson.contains("rules") ? 
+            configJson["rules"] : nlohmann::json::array();
+        snapshot->ruleSet = RuleSetCache::GetInstance().Acquire(rulesJson.dump());
+        snapshot->profiler.reset(new RuleProfiler(snapshot->ruleSet->GetRuleCount()));
+        
+        // Publish; in-flight messages keep the snapshot they loaded
+        m_snapshot.Store(std::move(snapshot));
+        
         LoggingService::GetInstance().Log(
-            LogLevel::INFO, 
-            "RuleBasedAgent " + m_id + " initialized with " + 
-            std::to_string(m_rules.size()) + " rules");
+            LogLevel::DEBUG, 
+            "RuleBasedAgent " + m_id + " published a new rule set");
         
         return true;
     } 
     catch (const std::exception& e) {
         LoggingService::GetInstance().Log(
             LogLevel::ERROR, 
-            "Failed to initialize RuleBasedAgent " + m_id + ": " + e.what());
+            "Failed to load rules for RuleBasedAgent " + m_id + ": " + e.what());
         return false;
     }
 }
 
 std::string RuleBasedAgent::ProcessMessage(const std::string& message) {
+    EpochGuard guard;
+    const Snapshot* snapshot = m_snapshot.Load();
+    if (!snapshot->ruleSet) {
+        return snapshot->defaultResponse;
+    }
+    
     // Find the best matching rule
-    const Rule* rule = FindMatchingRule(message);
+    std::smatch matches;
+    PrefilterStats stats = {};
+    size_t rule = snapshot->ruleSet->FindMatch(
+        message, matches, stats, &snapshot->profiler->Local());
+    
+    if (stats.messagesScanned > 0) {
+        m_prefilterScans.fetch_add(stats.messagesScanned, std::memory_order_relaxed);
+        m_rulesEvaluated.fetch_add(stats.rulesEvaluated, std::memory_order_relaxed);
+        m_rulesEliminated.fetch_add(stats.rulesEliminated, std::memory_order_relaxed);
+    }
     
-    if (rule) {
+    if (rule != CompiledRuleSet::NO_MATCH) {
         // Generate a response using the rule
-        return GenerateRuleResponse(*rule, message);
+        return snapshot->ruleSet->GenerateResponse(rule, matches, m_id);
     }
     
     // No matching rule, return default response
-    return m_defaultResponse;
+    return snapshot->defaultResponse;
 }
 
-void RuleBasedAgent::so_define_agent() {
-    // Subscribe to agent messages
-    so_subscribe(m_mbox).event([this](const messages::AgentMessage& msg) {
-        this->HandleMessage(msg);
-    });
+PrefilterStats RuleBasedAgent::GetPrefilterStats() const {
+    PrefilterStats stats;
+    stats.messagesScanned = m_prefilterScans.load(std::memory_order_relaxed);
+    stats.rulesEvaluated = m_rulesEvaluated.load(std::memory_order_relaxed);
+    stats.rulesEliminated = m_rulesEliminated.load(std::memory_order_relaxed);
+    return stats;
 }
 
-void RuleBasedAgent::so_evt_start() {
-    LoggingService::GetInstance().Log(
-        LogLevel::INFO, 
-        "RuleBasedAgent " + m_id + " started");
-}
-
-void RuleBasedAgent::so_evt_finish() {
-    LoggingService::GetInstance().Log(
-        LogLevel::INFO, 
-        "RuleBasedAgent " + m_id + " finished");
+RuleSetProfile RuleBasedAgent::GetRuleProfile() const {
+    EpochGuard guard;
+    const Snapshot* snapshot = m_snapshot.Load();
+    if (!snapshot->profiler) {
+        return RuleSetProfile{0, 0, {}};
+    }
+    return snapshot->profiler->Collect();
 }
 
-void RuleBasedAgent::AddRule(
-    const std::string& pattern, 
-    const std::string& responseTemplate, 
-    int priority) {
+std::string RuleBasedAgent::DumpRuleProfile() const {
+    EpochGuard guard;
+    const Snapshot* snapshot = m_snapshot.Load();
     
-    try {
-        // Create a new rule
-        Rule rule;
-        rule.pattern = std::regex(pattern, std::regex::icase);
-        rule.responseTemplate = responseTemplate;
-        rule.priority = priority;
-        
-        // Add the rule to the list
-        m_rules.push_back(rule);
-        
-        // Sort rules by priority (descending)
-        std::sort(m_rules.begin(), m_rules.end(), 
-                 [](const Rule& a, const Rule& b) {
-                     return a.priority > b.priority;
-                 });
-        
-        LoggingService::GetInstance().Log(
-            LogLevel::DEBUG, 
-            "Added rule with pattern '" + pattern + "' and priority " + 
-            std::to_string(priority));
+    nlohmann::json dump = {
+        {"agent_id", m_id},
+        {"messages", 0},
+        {"matcher_nanos", 0},
+        {"rules", nlohmann::json::array()}
+    };
+    if (!snapshot->profiler) {
+        return dump.dump();
     }
-    catch (const std::regex_error& e) {
-        LoggingService::GetInstance().Log(
-            LogLevel::ERROR, 
-            "Invalid regex pattern '" + pattern + "': " + e.what());
+    
+    RuleSetProfile profile = snapshot->profiler->Collect();
+    dump["messages"] = profile.messages;
+    dump["matcher_nanos"] = profile.matcherNanos;
+    
+    for (size_t i = 0; i < profile.rules.size(); ++i) {
+        const RuleCounters& counters = profile.rules[i];
+        dump["rules"].push_back({
+            {"index", i},
+            {"pattern", snapshot->ruleSet->GetPatternSource(i)},
+            {"priority", snapshot->ruleSet->GetPriority(i)},
+            {"evaluations", counters.evaluations},
+            {"matches", counters.matches},
+            {"regex_runs", counters.regexRuns},
+            {"regex_nanos", counters.regexNanos},
+            {"dead", profile.messages > 0 && counters.matches == 0}
+        });
     }
+    
+    return dump.dump();
 }
 
-const Rule* RuleBasedAgent::FindMatchingRule(const std::string& message) const {
-    // Try to match each rule in order of priority
-    for (const auto& rule : m_rules) {
-        if (std::regex_search(message, rule.pattern)) {
-            return &rule;
-        }
-    }
-    
-    // No matching rule
-    return nullptr;
+void RuleBasedAgent::so_define_agent() {
+    // Agent messages are answered by the base class
+    Agent::so_define_agent();
 }
 
-std::string RuleBasedAgent::GenerateRuleResponse(
-    const Rule& rule, 
-    const std::string& message) const {
-    
-    // Simple template substitution
-    std::string response = rule.responseTemplate;
-    
-    // Extract captures from the regex
-    std::smatch matches;
-    if (std::regex_search(message, matches, rule.pattern)) {
-        // Replace $0, $1, etc. with the corresponding captures
-        for (size_t i = 0; i < matches.size(); ++i) {
-            std::string placeholder = "$" + std::to_string(i);
-            std::string value = matches[i].str();
-            
-            // Replace all occurrences
-            size_t pos = 0;
-            while ((pos = response.find(placeholder, pos)) != std::string::npos) {
-                response.replace(pos, placeholder.length(), value);
-                pos += value.length();
-            }
-        }
-    }
-    
-    return response;
+void RuleBasedAgent::so_evt_start() {
+    LoggingService::GetInstance().Log(
+        LogLevel::INFO, 
+        "RuleBasedAgent " + m_id + " started");
 }
-void RuleBasedAgent::HandleMessage(const messages::AgentMessage& msg){
 
+void RuleBasedAgent::so_evt_finish() {
+    LoggingService::GetInstance().Log(
+        LogLevel::INFO, 
+        "RuleBasedAgent " + m_id + " finished");
 }
 
 } // namespace ai_framework
\ No newline at end of file
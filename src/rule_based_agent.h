@@ -4,27 +4,19 @@
 
 #include "agent.h"
 #include "messages.h"
+#include "rcu.h"
+#include "rule_profiler.h"
+#include "rule_set.h"
+#include <atomic>
+#include <cstdint>
 #include <map>
-#include <regex>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 namespace ai_framework {
 
-/**
- * @brief Structure representing a rule for the rule-based agent
- */
-struct Rule {
-    /** Pattern to match */
-    std::regex pattern;
-    
-    /** Response template */
-    std::string responseTemplate;
-    
-    /** Priority of the rule (higher values = higher priority) */
-    int priority;
-};
-
 /**
  * @brief Agent that uses predefined rules to generate responses
  * 
@@ -61,6 +53,45 @@ public:
      * @return std::string Response to the message
      */
     virtual std::string ProcessMessage(const std::string& message) override;
+    
+    /**
+     * @brief Replace the agent's rules while it keeps serving messages
+     * 
+     * The new rules are compiled on the calling thread and published with an
+     * atomic swap; messages already being processed finish on the old rules
+     * and the old rule set is freed once they are done.
+     * 
+     * @param config JSON with "rules" and optionally "default_response"
+     * @return bool True if the new rules were published, false otherwise
+     */
+    bool ReloadRules(const std::string& config);
+    
+    /**
+     * @brief Get the literal prefilter counters
+     * 
+     * @return PrefilterStats Counters accumulated since initialization
+     */
+    PrefilterStats GetPrefilterStats() const;
+    
+    /**
+     * @brief Get the per-rule counters of the current rule set
+     * 
+     * Counters start from zero whenever the rules are reloaded.
+     * 
+     * @return RuleSetProfile Counters in rule priority order
+     */
+    RuleSetProfile GetRuleProfile() const;
+    
+    /**
+     * @brief Dump the per-rule counters as JSON
+     * 
+     * Each rule is listed with its pattern and priority so rules can be
+     * reordered or pruned from the data; rules that never matched are
+     * flagged as dead.
+     * 
+     * @return std::string JSON object with "messages", "matcher_nanos" and "rules"
+     */
+    std::string DumpRuleProfile() const;
 
 protected:
     /**
@@ -79,40 +110,34 @@ protected:
     virtual void so_evt_finish() override;
 
 private:
-    /** Rules for this agent */
-    std::vector<Rule> m_rules;
-    
-    /** Default response if no rule matches */
-    std::string m_defaultResponse;
-    
     /**
-     * @brief Add a new rule to the agent
-     * 
-     * @param pattern Regular expression pattern to match
-     * @param responseTemplate Template for the response
-     * @param priority Priority of the rule
+     * @brief Everything a message is answered from, published as one unit
      */
-    void AddRule(const std::string& pattern, const std::string& responseTemplate, int priority);
+    struct Snapshot {
+        /** Compiled rules */
+        std::shared_ptr<const CompiledRuleSet> ruleSet;
+        
+        /** Default response if no rule matches */
+        std::string defaultResponse;
+        
+        /** Hit and latency counters of ruleSet for this agent */
+        std::unique_ptr<RuleProfiler> profiler;
+    };
     
-    /**
-     * @brief Find the best matching rule for a message
-     * 
-     * @param message The message to match
-     * @return const Rule* Pointer to the matched rule, or nullptr if no match
-     */
-    const Rule* FindMatchingRule(const std::string& message) const;
+    /** Current rules, read without locking */
+    RcuPointer<const Snapshot> m_snapshot;
     
-    /**
-     * @brief Generate a response using a rule and a message
-     * 
-     * @param rule The rule to use
-     * @param message The input message
-     * @return std::string Generated response
-     */
-    std::string GenerateRuleResponse(const Rule& rule, const std::string& message) const;
-
-    void HandleMessage(const messages::AgentMessage& msg);
-    so_5::mbox_t m_mbox;
+    /** Mutex serializing rule reloads (never taken by readers) */
+    std::mutex m_reloadMutex;
+    
+    /** Messages that went through the prefilter */
+    std::atomic<uint64_t> m_prefilterScans;
+    
+    /** Fallback rules evaluated after prefiltering */
+    std::atomic<uint64_t> m_rulesEvaluated;
+    
+    /** Fallback rules eliminated by the prefilter */
+    std::atomic<uint64_t> m_rulesEliminated;
 };
 
 } // namespace ai_framework
@@ -0,0 +1,99 @@
+// rule_profiler.cpp
+#include "rule_profiler.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace ai_framework {
+
+namespace {
+
+std::atomic<uint64_t> s_nextInstanceId(1);
+
+/**
+ * @brief Counter blocks of the current thread by profiler instance
+ *
+ * Blocks are shared with their profiler; an entry whose profiler is gone
+ * holds the only reference and is dropped the next time one is added.
+ */
+thread_local std::unordered_map<uint64_t, std::shared_ptr<RuleProfiler::ThreadCounters>> s_localCounters;
+
+} // namespace
+
+RuleProfiler::ThreadCounters::ThreadCounters(size_t ruleCount)
+    : m_slots(new Slot[ruleCount]), m_ruleCount(ruleCount) {
+}
+
+void RuleProfiler::ThreadCounters::RecordMessage(size_t rule, uint64_t matcherNanos) {
+    Bump(m_messages, 1);
+    Bump(m_matcherNanos, matcherNanos);
+    if (rule < m_ruleCount) {
+        Bump(m_slots[rule].matches, 1);
+    }
+}
+
+void RuleProfiler::ThreadCounters::RecordRegexRun(size_t rule, uint64_t nanos) {
+    Bump(m_slots[rule].regexRuns, 1);
+    Bump(m_slots[rule].regexNanos, nanos);
+}
+
+RuleProfiler::RuleProfiler(size_t ruleCount)
+    : m_ruleCount(ruleCount),
+      m_instanceId(s_nextInstanceId.fetch_add(1, std::memory_order_relaxed)) {
+}
+
+RuleProfiler::ThreadCounters& RuleProfiler::Local() {
+    auto it = s_localCounters.find(m_instanceId);
+    if (it != s_localCounters.end()) {
+        return *it->second;
+    }
+
+    // First record from this thread; forget blocks of destroyed profilers
+    for (auto stale = s_localCounters.begin(); stale != s_localCounters.end();) {
+        if (stale->second.use_count() == 1) {
+            stale = s_localCounters.erase(stale);
+        }
+        else {
+            ++stale;
+        }
+    }
+
+    std::shared_ptr<ThreadCounters> counters(new ThreadCounters(m_ruleCount));
+    {
+        std::lock_guard<std::mutex> lock(m_threadsMutex);
+        m_threads.push_back(counters);
+    }
+    s_localCounters.emplace(m_instanceId, counters);
+    return *counters;
+}
+
+RuleSetProfile RuleProfiler::Collect() const {
+    RuleSetProfile profile;
+    profile.messages = 0;
+    profile.matcherNanos = 0;
+    profile.rules.assign(m_ruleCount, RuleCounters{0, 0, 0, 0});
+
+    {
+        std::lock_guard<std::mutex> lock(m_threadsMutex);
+        for (const auto& counters : m_threads) {
+            profile.messages += counters->m_messages.load(std::memory_order_relaxed);
+            profile.matcherNanos += counters->m_matcherNanos.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < m_ruleCount; ++i) {
+                const ThreadCounters::Slot& slot = counters->m_slots[i];
+                profile.rules[i].matches += slot.matches.load(std::memory_order_relaxed);
+                profile.rules[i].regexRuns += slot.regexRuns.load(std::memory_order_relaxed);
+                profile.rules[i].regexNanos += slot.regexNanos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // A rule is reached by every message not answered by a rule above it
+    uint64_t reached = profile.messages;
+    for (RuleCounters& rule : profile.rules) {
+        rule.evaluations = reached;
+        reached -= std::min(reached, rule.matches);
+    }
+
+    return profile;
+}
+
+} // namespace ai_framework
@@ -0,0 +1,142 @@
+// rule_profiler.h
+#ifndef AI_FRAMEWORK_RULE_PROFILER_H
+#define AI_FRAMEWORK_RULE_PROFILER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief Aggregated counters of one rule
+ */
+struct RuleCounters {
+    /** Messages that reached the rule, i.e. no higher priority rule matched */
+    uint64_t evaluations;
+
+    /** Messages the rule answered */
+    uint64_t matches;
+
+    /** std::regex runs of the rule (fallback evaluation and capture extraction) */
+    uint64_t regexRuns;
+
+    /** Time spent in those std::regex runs, in nanoseconds */
+    uint64_t regexNanos;
+};
+
+/**
+ * @brief Aggregated counters of a whole rule set
+ */
+struct RuleSetProfile {
+    /** Messages matched against the rule set */
+    uint64_t messages;
+
+    /** Time spent in the multi-pattern matcher pass, in nanoseconds */
+    uint64_t matcherNanos;
+
+    /** Counters per rule, in priority order */
+    std::vector<RuleCounters> rules;
+};
+
+/**
+ * @brief Low-overhead per-rule hit and latency counters
+ *
+ * Each thread writes its own block of counters with plain relaxed stores,
+ * so recording never contends; Collect sums the blocks on read. Only
+ * matches are recorded per rule on the hot path: a rule is evaluated
+ * exactly when no higher priority rule matched, so evaluation counts are
+ * derived from the match counts on read instead of being bumped for every
+ * rule on every message.
+ */
+class RuleProfiler {
+public:
+    /**
+     * @brief Counters written by one thread
+     */
+    class ThreadCounters {
+    public:
+        /**
+         * @brief Record one message matched against the rule set
+         *
+         * @param rule Index of the rule that answered, or a value >= the
+         *             rule count if none did
+         * @param matcherNanos Time spent in the matcher pass
+         */
+        void RecordMessage(size_t rule, uint64_t matcherNanos);
+
+        /**
+         * @brief Record one std::regex run of a rule
+         *
+         * @param rule Index of the rule
+         * @param nanos Time spent in the run
+         */
+        void RecordRegexRun(size_t rule, uint64_t nanos);
+
+    private:
+        friend class RuleProfiler;
+
+        struct Slot {
+            std::atomic<uint64_t> matches{0};
+            std::atomic<uint64_t> regexRuns{0};
+            std::atomic<uint64_t> regexNanos{0};
+        };
+
+        explicit ThreadCounters(size_t ruleCount);
+
+        /** Add to a counter only this thread writes */
+        static void Bump(std::atomic<uint64_t>& counter, uint64_t value) {
+            counter.store(counter.load(std::memory_order_relaxed) + value,
+                          std::memory_order_relaxed);
+        }
+
+        std::unique_ptr<Slot[]> m_slots;
+        size_t m_ruleCount;
+        std::atomic<uint64_t> m_messages{0};
+        std::atomic<uint64_t> m_matcherNanos{0};
+    };
+
+    /**
+     * @brief Constructor for RuleProfiler
+     *
+     * @param ruleCount Number of rules in the profiled rule set
+     */
+    explicit RuleProfiler(size_t ruleCount);
+
+    RuleProfiler(const RuleProfiler&) = delete;
+    RuleProfiler& operator=(const RuleProfiler&) = delete;
+
+    /**
+     * @brief Get the calling thread's counters, creating them on first use
+     *
+     * @return ThreadCounters& Counters owned by the calling thread
+     */
+    ThreadCounters& Local();
+
+    /**
+     * @brief Sum the counters of all threads
+     *
+     * @return RuleSetProfile Counters accumulated since construction
+     */
+    RuleSetProfile Collect() const;
+
+private:
+    /** Number of rules */
+    size_t m_ruleCount;
+
+    /** Identifies this profiler in the threads' lookup tables */
+    uint64_t m_instanceId;
+
+    /** Mutex guarding the list of thread blocks (not taken on the hot path) */
+    mutable std::mutex m_threadsMutex;
+
+    /** Counter blocks of every thread that recorded anything */
+    std::vector<std::shared_ptr<ThreadCounters>> m_threads;
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_RULE_PROFILER_H
@@ -0,0 +1,292 @@
+// rule_set.cpp
+#include "rule_set.h"
+#include "logging_service.h"
+#include <algorithm>
+#include <chrono>
+
+namespace ai_framework {
+
+namespace {
+
+uint64_t ElapsedNanos(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+} // namespace
+
+CompiledRuleSet::CompiledRuleSet()
+    : m_matcher(true), m_prefilter(true) {
+}
+
+size_t CompiledRuleSet::GetRuleCount() const {
+    return m_patterns.size();
+}
+
+const std::string& CompiledRuleSet::GetPatternSource(size_t index) const {
+    return m_sources[index];
+}
+
+int CompiledRuleSet::GetPriority(size_t index) const {
+    return m_priorities[index];
+}
+
+size_t CompiledRuleSet::FindMatch(
+    const std::string& message,
+    std::smatch& matches,
+    PrefilterStats& stats,
+    RuleProfiler::ThreadCounters* profile) const {
+
+    std::chrono::steady_clock::time_point start;
+    if (profile) {
+        start = std::chrono::steady_clock::now();
+    }
+
+    // One pass over the message finds the best rule the matcher knows about
+    size_t best = m_matcher.FindFirstMatch(message);
+
+    uint64_t matcherNanos = 0;
+    if (profile) {
+        matcherNanos = ElapsedNanos(start);
+    }
+
+    // Rules outside the matcher's syntax only need checking if they
+    // outrank that result and pass the literal prefilter
+    if (!m_fallbackRules.empty() && m_fallbackRules.front() < best) {
+        std::vector<size_t> candidates;
+        m_prefilter.FindCandidates(message, candidates);
+
+        ++stats.messagesScanned;
+        stats.rulesEliminated += m_prefilter.GetLiteralCount() - candidates.size();
+
+        size_t middle = candidates.size();
+        candidates.insert(candidates.end(), m_unfilteredRules.begin(), m_unfilteredRules.end());
+        std::inplace_merge(candidates.begin(), candidates.begin() +
+                           static_cast<std::ptrdiff_t>(middle), candidates.end());
+
+        for (size_t index : candidates) {
+            if (index >= best) {
+                break;
+            }
+            ++stats.rulesEvaluated;
+            if (RunRegex(index, message, matches, profile)) {
+                if (profile) {
+                    profile->RecordMessage(index, matcherNanos);
+                }
+                return index;
+            }
+        }
+    }
+
+    // The matcher only reports which rule fired, so captures need one
+    // regex run on that rule alone
+    if (best != NO_MATCH && m_usesCaptures[best]) {
+        RunRegex(best, message, matches, profile);
+    }
+
+    if (profile) {
+        profile->RecordMessage(best, matcherNanos);
+    }
+    return best;
+}
+
+bool CompiledRuleSet::RunRegex(
+    size_t index,
+    const std::string& message,
+    std::smatch& matches,
+    RuleProfiler::ThreadCounters* profile) const {
+
+    if (!profile) {
+        return std::regex_search(message, matches, m_patterns[index]);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool found = std::regex_search(message, matches, m_patterns[index]);
+    profile->RecordRegexRun(index, ElapsedNanos(start));
+    return found;
+}
+
+std::string CompiledRuleSet::GenerateResponse(
+    size_t index,
+    const std::smatch& matches,
+    const std::string& agentId) const {
+
+    auto begin = m_segments.begin() + m_segmentBegin[index];
+    auto end = m_segments.begin() + m_segmentBegin[index + 1];
+
+    // Size the buffer once, then append every segment
+    size_t length = 0;
+    for (auto it = begin; it != end; ++it) {
+        switch (it->type) {
+            case TemplateSegment::Type::Literal:
+                length += it->length;
+                break;
+            case TemplateSegment::Type::Capture:
+                if (it->value < matches.size()) {
+                    length += static_cast<size_t>(matches[it->value].length());
+                }
+                break;
+            case TemplateSegment::Type::AgentId:
+                length += agentId.size();
+                break;
+        }
+    }
+
+    std::string response;
+    response.reserve(length);
+    for (auto it = begin; it != end; ++it) {
+        switch (it->type) {
+            case TemplateSegment::Type::Literal:
+                response.append(m_text, it->value, it->length);
+                break;
+            case TemplateSegment::Type::Capture:
+                if (it->value < matches.size() && matches[it->value].matched) {
+                    response.append(matches[it->value].first, matches[it->value].second);
+                }
+                break;
+            case TemplateSegment::Type::AgentId:
+                response += agentId;
+                break;
+        }
+    }
+
+    return response;
+}
+
+bool RuleSetBuilder::AddRule(
+    const std::string& pattern,
+    const std::string& responseTemplate,
+    int priority) {
+
+    try {
+        Rule rule;
+        rule.pattern = std::regex(pattern, std::regex::icase);
+        rule.source = pattern;
+        rule.responseTemplate = responseTemplate;
+        rule.priority = priority;
+        m_rules.push_back(std::move(rule));
+
+        LoggingService::GetInstance().Log(
+            LogLevel::DEBUG,
+            "Added rule with pattern '" + pattern + "' and priority " +
+            std::to_string(priority));
+        return true;
+    }
+    catch (const std::regex_error& e) {
+        LoggingService::GetInstance().Log(
+            LogLevel::ERROR,
+            "Invalid regex pattern '" + pattern + "': " + e.what());
+        return false;
+    }
+}
+
+size_t RuleSetBuilder::GetRuleCount() const {
+    return m_rules.size();
+}
+
+std::shared_ptr<const CompiledRuleSet> RuleSetBuilder::Build() {
+    // Sort rules by priority (descending), keeping insertion order on ties
+    std::stable_sort(m_rules.begin(), m_rules.end(),
+                     [](const Rule& a, const Rule& b) {
+                         return a.priority > b.priority;
+                     });
+
+    std::shared_ptr<CompiledRuleSet> ruleSet(new CompiledRuleSet());
+    ruleSet->m_patterns.reserve(m_rules.size());
+    ruleSet->m_sources.reserve(m_rules.size());
+    ruleSet->m_priorities.reserve(m_rules.size());
+    ruleSet->m_usesCaptures.reserve(m_rules.size());
+    ruleSet->m_segmentBegin.reserve(m_rules.size() + 1);
+
+    for (size_t i = 0; i < m_rules.size(); ++i) {
+        Rule& rule = m_rules[i];
+
+        ruleSet->m_segmentBegin.push_back(static_cast<uint32_t>(ruleSet->m_segments.size()));
+        ParseTemplate(rule.responseTemplate, rule.pattern.mark_count(), *ruleSet);
+        ruleSet->m_usesCaptures.push_back(static_cast<uint8_t>(std::any_of(
+            ruleSet->m_segments.begin() + ruleSet->m_segmentBegin.back(),
+            ruleSet->m_segments.end(),
+            [](const TemplateSegment& segment) {
+                return segment.type == TemplateSegment::Type::Capture;
+            })));
+
+        // Rule indices double as matcher ids, so the lowest id is the
+        // highest priority rule
+        if (!ruleSet->m_matcher.AddPattern(rule.source, i)) {
+            // Rules left to std::regex are only evaluated when the literal
+            // they require occurs in the message
+            ruleSet->m_fallbackRules.push_back(i);
+            std::string literal = LiteralPrefilter::ExtractRequiredLiteral(rule.source);
+            if (literal.empty()) {
+                ruleSet->m_unfilteredRules.push_back(i);
+            }
+            else {
+                ruleSet->m_prefilter.AddLiteral(literal, i);
+            }
+        }
+
+        ruleSet->m_patterns.push_back(std::move(rule.pattern));
+        ruleSet->m_sources.push_back(std::move(rule.source));
+        ruleSet->m_priorities.push_back(rule.priority);
+    }
+    ruleSet->m_segmentBegin.push_back(static_cast<uint32_t>(ruleSet->m_segments.size()));
+    ruleSet->m_prefilter.Build();
+    m_rules.clear();
+
+    if (!ruleSet->m_fallbackRules.empty()) {
+        LoggingService::GetInstance().Log(
+            LogLevel::DEBUG,
+            "Rule set evaluates " + std::to_string(ruleSet->m_fallbackRules.size()) +
+            " of " + std::to_string(ruleSet->GetRuleCount()) + " rules with std::regex");
+    }
+
+    return ruleSet;
+}
+
+void RuleSetBuilder::ParseTemplate(
+    const std::string& responseTemplate,
+    size_t captureCount,
+    CompiledRuleSet& ruleSet) {
+
+    static const std::string AGENT_ID_SLOT = "${agent_id}";
+
+    size_t literalStart = ruleSet.m_text.size();
+    auto flushLiteral = [&]() {
+        size_t length = ruleSet.m_text.size() - literalStart;
+        if (length > 0) {
+            ruleSet.m_segments.push_back({
+                TemplateSegment::Type::Literal,
+                static_cast<uint32_t>(literalStart),
+                static_cast<uint32_t>(length)});
+        }
+        literalStart = ruleSet.m_text.size();
+    };
+
+    for (size_t pos = 0; pos < responseTemplate.size(); ++pos) {
+        char c = responseTemplate[pos];
+        if (c == '$' && pos + 1 < responseTemplate.size()) {
+            char next = responseTemplate[pos + 1];
+
+            // $0 to $9, as long as the pattern has that many groups
+            if (next >= '0' && next <= '9' &&
+                static_cast<size_t>(next - '0') <= captureCount) {
+                flushLiteral();
+                ruleSet.m_segments.push_back({
+                    TemplateSegment::Type::Capture, static_cast<uint32_t>(next - '0'), 0});
+                ++pos;
+                continue;
+            }
+
+            if (responseTemplate.compare(pos, AGENT_ID_SLOT.size(), AGENT_ID_SLOT) == 0) {
+                flushLiteral();
+                ruleSet.m_segments.push_back({TemplateSegment::Type::AgentId, 0, 0});
+                pos += AGENT_ID_SLOT.size() - 1;
+                continue;
+            }
+        }
+        ruleSet.m_text += c;
+    }
+    flushLiteral();
+}
+
+} // namespace ai_framework
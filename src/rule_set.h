@@ -0,0 +1,226 @@
+// rule_set.h
+#ifndef AI_FRAMEWORK_RULE_SET_H
+#define AI_FRAMEWORK_RULE_SET_H
+
+#include "literal_prefilter.h"
+#include "pattern_set_matcher.h"
+#include "rule_profiler.h"
+#include <cstdint>
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief Structure representing a rule for the rule-based agent
+ */
+struct Rule {
+    /** Pattern to match */
+    std::regex pattern;
+
+    /** Source text of the pattern */
+    std::string source;
+
+    /** Response template */
+    std::string responseTemplate;
+
+    /** Priority of the rule (higher values = higher priority) */
+    int priority;
+};
+
+/**
+ * @brief Piece of a parsed response template
+ */
+struct TemplateSegment {
+    enum class Type {
+        /** Text copied as is */
+        Literal,
+        /** Capture group of the match ($0 to $9) */
+        Capture,
+        /** ID of the responding agent (${agent_id}) */
+        AgentId
+    };
+
+    /** Kind of segment */
+    Type type;
+
+    /** Offset into the rule set's text pool, or the group index of a Capture */
+    uint32_t value;
+
+    /** Length of a Literal segment */
+    uint32_t length;
+};
+
+/**
+ * @brief Counters describing how well the literal prefilter works
+ */
+struct PrefilterStats {
+    /** Messages that went through the prefilter */
+    uint64_t messagesScanned;
+
+    /** Rules evaluated with std::regex after prefiltering */
+    uint64_t rulesEvaluated;
+
+    /** Rules skipped because their required literal was absent */
+    uint64_t rulesEliminated;
+};
+
+/**
+ * @brief Immutable, compiled set of rules
+ *
+ * Rules are stored in priority order as parallel arrays, with every
+ * response template flattened into one segment array and one text pool.
+ * Nothing changes after RuleSetBuilder::Build, so one instance can be read
+ * from any number of threads without locking.
+ */
+class CompiledRuleSet {
+public:
+    /** Returned by FindMatch when no rule matches */
+    static constexpr size_t NO_MATCH = PatternSetMatcher::NO_MATCH;
+
+    /**
+     * @brief Get the number of rules
+     *
+     * @return size_t Number of rules in the set
+     */
+    size_t GetRuleCount() const;
+
+    /**
+     * @brief Get the source text of a rule's pattern
+     *
+     * @param index Rule index (0 is the highest priority)
+     * @return const std::string& Pattern text
+     */
+    const std::string& GetPatternSource(size_t index) const;
+
+    /**
+     * @brief Get the priority of a rule
+     *
+     * @param index Rule index (0 is the highest priority)
+     * @return int Priority
+     */
+    int GetPriority(size_t index) const;
+
+    /**
+     * @brief Find the highest priority rule matching a message
+     *
+     * @param message The message to match
+     * @param matches Filled with the captures if the rule's template uses them
+     * @param stats Incremented with the prefilter work done for this message
+     * @param profile Calling thread's rule counters, or null to skip profiling
+     * @return size_t Index of the matched rule, or NO_MATCH
+     */
+    size_t FindMatch(const std::string& message, std::smatch& matches,
+                     PrefilterStats& stats,
+                     RuleProfiler::ThreadCounters* profile = nullptr) const;
+
+    /**
+     * @brief Generate the response of a matched rule
+     *
+     * @param index Index of the matched rule
+     * @param matches Captures of the rule's pattern in the message
+     * @param agentId ID substituted for ${agent_id}
+     * @return std::string Generated response
+     */
+    std::string GenerateResponse(size_t index, const std::smatch& matches,
+                                 const std::string& agentId) const;
+
+private:
+    friend class RuleSetBuilder;
+
+    CompiledRuleSet();
+
+    /**
+     * @brief Run one rule's std::regex, timing it if profiling
+     */
+    bool RunRegex(size_t index, const std::string& message, std::smatch& matches,
+                  RuleProfiler::ThreadCounters* profile) const;
+
+    /** Compiled patterns in priority order */
+    std::vector<std::regex> m_patterns;
+
+    /** Pattern source texts */
+    std::vector<std::string> m_sources;
+
+    /** Rule priorities */
+    std::vector<int> m_priorities;
+
+    /** Whether each rule's template references capture groups */
+    std::vector<uint8_t> m_usesCaptures;
+
+    /** First segment of each rule's template, plus one end marker */
+    std::vector<uint32_t> m_segmentBegin;
+
+    /** Template segments of all rules */
+    std::vector<TemplateSegment> m_segments;
+
+    /** Literal template text of all rules */
+    std::string m_text;
+
+    /** Linear-time matcher over all rules it can compile */
+    PatternSetMatcher m_matcher;
+
+    /** Indices of rules the matcher cannot handle, in priority order */
+    std::vector<size_t> m_fallbackRules;
+
+    /** Required literals of the fallback rules */
+    LiteralPrefilter m_prefilter;
+
+    /** Fallback rules without a required literal, always evaluated */
+    std::vector<size_t> m_unfilteredRules;
+};
+
+/**
+ * @brief Collects rules and freezes them into a CompiledRuleSet
+ *
+ * Rules are only sorted and compiled once, in Build, so loading N rules
+ * costs O(N log N) instead of a sort per insert.
+ */
+class RuleSetBuilder {
+public:
+    /**
+     * @brief Add a rule to the set being built
+     *
+     * @param pattern Regular expression pattern to match
+     * @param responseTemplate Template for the response
+     * @param priority Priority of the rule
+     * @return bool True if the rule was added, false if the pattern is invalid
+     */
+    bool AddRule(const std::string& pattern, const std::string& responseTemplate, int priority);
+
+    /**
+     * @brief Get the number of rules collected so far
+     *
+     * @return size_t Number of rules
+     */
+    size_t GetRuleCount() const;
+
+    /**
+     * @brief Sort the collected rules and compile them
+     *
+     * The builder is left empty and can be reused.
+     *
+     * @return std::shared_ptr<const CompiledRuleSet> The frozen rule set
+     */
+    std::shared_ptr<const CompiledRuleSet> Build();
+
+private:
+    /** Rules in insertion order */
+    std::vector<Rule> m_rules;
+
+    /**
+     * @brief Split a response template into literal text and slots
+     *
+     * @param responseTemplate Template to parse
+     * @param captureCount Number of capture groups in the rule's pattern
+     * @param ruleSet Rule set receiving the segments and literal text
+     */
+    static void ParseTemplate(const std::string& responseTemplate, size_t captureCount,
+                              CompiledRuleSet& ruleSet);
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_RULE_SET_H
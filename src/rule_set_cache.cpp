@@ -0,0 +1,120 @@
+// rule_set_cache.cpp
+#include "rule_set_cache.h"
+#include "logging_service.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+
+namespace ai_framework {
+
+RuleSetCache& RuleSetCache::GetInstance() {
+    static RuleSetCache instance;
+    return instance;
+}
+
+std::shared_ptr<const CompiledRuleSet> RuleSetCache::Acquire(const std::string& rulesJson) {
+    uint64_t hash = Hash(rulesJson);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(hash);
+        if (it != m_entries.end() && it->second.rulesJson == rulesJson) {
+            if (auto ruleSet = it->second.ruleSet.lock()) {
+                ++m_hits;
+                return ruleSet;
+            }
+        }
+    }
+
+    // Compile without holding the lock so unrelated lookups are not blocked
+    std::shared_ptr<const CompiledRuleSet> ruleSet = Compile(rulesJson);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_misses;
+
+    auto it = m_entries.find(hash);
+    if (it != m_entries.end()) {
+        if (it->second.rulesJson != rulesJson) {
+            // Hash collision with another live rule set, leave it uncached
+            if (!it->second.ruleSet.expired()) {
+                return ruleSet;
+            }
+        }
+        else if (auto existing = it->second.ruleSet.lock()) {
+            // Another thread compiled the same rules meanwhile, share its copy
+            return existing;
+        }
+    }
+
+    m_entries[hash] = Entry{rulesJson, ruleSet};
+
+    if (m_entries.size() >= m_pruneThreshold) {
+        PruneExpired();
+        m_pruneThreshold = std::max<size_t>(64, m_entries.size() * 2);
+    }
+
+    return ruleSet;
+}
+
+RuleSetCacheStats RuleSetCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    RuleSetCacheStats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.liveRuleSets = 0;
+    for (const auto& entry : m_entries) {
+        if (!entry.second.ruleSet.expired()) {
+            ++stats.liveRuleSets;
+        }
+    }
+    return stats;
+}
+
+std::shared_ptr<const CompiledRuleSet> RuleSetCache::Compile(const std::string& rulesJson) {
+    nlohmann::json rules = nlohmann::json::parse(rulesJson);
+
+    RuleSetBuilder builder;
+    for (const auto& ruleJson : rules) {
+        if (ruleJson.contains("pattern") &&
+            ruleJson.contains("response")) {
+
+            std::string pattern = ruleJson["pattern"].get<std::string>();
+            std::string response = ruleJson["response"].get<std::string>();
+            int priority = 0;
+
+            if (ruleJson.contains("priority")) {
+                priority = ruleJson["priority"].get<int>();
+            }
+
+            builder.AddRule(pattern, response, priority);
+        }
+    }
+
+    LoggingService::GetInstance().Log(
+        LogLevel::DEBUG,
+        "Compiling rule set with " + std::to_string(builder.GetRuleCount()) + " rules");
+
+    return builder.Build();
+}
+
+uint64_t RuleSetCache::Hash(const std::string& rulesJson) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : rulesJson) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void RuleSetCache::PruneExpired() {
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->second.ruleSet.expired()) {
+            it = m_entries.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+} // namespace ai_framework
@@ -0,0 +1,115 @@
+// rule_set_cache.h
+#ifndef AI_FRAMEWORK_RULE_SET_CACHE_H
+#define AI_FRAMEWORK_RULE_SET_CACHE_H
+
+#include "rule_set.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ai_framework {
+
+/**
+ * @brief Counters describing how much the rule set cache is shared
+ */
+struct RuleSetCacheStats {
+    /** Lookups answered with an already compiled rule set */
+    uint64_t hits;
+
+    /** Lookups that had to compile a rule set */
+    uint64_t misses;
+
+    /** Distinct rule sets currently alive */
+    size_t liveRuleSets;
+};
+
+/**
+ * @brief Process-wide cache of compiled rule sets, addressed by content
+ *
+ * Rule sets are keyed by a hash of their canonical rules JSON, so every
+ * agent configured with the same rules shares one CompiledRuleSet. The
+ * cache only holds weak references; a rule set is freed with the last
+ * agent using it.
+ */
+class RuleSetCache {
+public:
+    /**
+     * @brief Get the singleton instance of RuleSetCache
+     *
+     * @return RuleSetCache& Reference to the RuleSetCache instance
+     */
+    static RuleSetCache& GetInstance();
+
+    /**
+     * @brief Get the compiled rule set for a rules array, compiling it if needed
+     *
+     * @param rulesJson Canonical JSON of the "rules" array (as produced by
+     *                  nlohmann::json::dump, so key order and whitespace
+     *                  do not matter)
+     * @return std::shared_ptr<const CompiledRuleSet> The shared rule set
+     * @throws std::exception If the JSON cannot be parsed
+     */
+    std::shared_ptr<const CompiledRuleSet> Acquire(const std::string& rulesJson);
+
+    /**
+     * @brief Get the cache counters
+     *
+     * @return RuleSetCacheStats Counters accumulated since startup
+     */
+    RuleSetCacheStats GetStats() const;
+
+private:
+    /**
+     * @brief Cached rule set with the text it was compiled from
+     */
+    struct Entry {
+        /** Canonical rules JSON, compared on lookup to rule out hash collisions */
+        std::string rulesJson;
+
+        /** Compiled rules, expired once no agent uses them */
+        std::weak_ptr<const CompiledRuleSet> ruleSet;
+    };
+
+    RuleSetCache() = default;
+    RuleSetCache(const RuleSetCache&) = delete;
+    RuleSetCache& operator=(const RuleSetCache&) = delete;
+
+    /**
+     * @brief Compile a rules array
+     *
+     * @param rulesJson JSON of the "rules" array
+     * @return std::shared_ptr<const CompiledRuleSet> The compiled rule set
+     */
+    static std::shared_ptr<const CompiledRuleSet> Compile(const std::string& rulesJson);
+
+    /**
+     * @brief 64-bit FNV-1a hash of the rules JSON
+     */
+    static uint64_t Hash(const std::string& rulesJson);
+
+    /**
+     * @brief Drop entries whose rule set has been freed; needs m_mutex
+     */
+    void PruneExpired();
+
+    /** Mutex guarding the entries and counters */
+    mutable std::mutex m_mutex;
+
+    /** Cached rule sets by content hash */
+    std::unordered_map<uint64_t, Entry> m_entries;
+
+    /** Lookups answered from the cache */
+    uint64_t m_hits = 0;
+
+    /** Lookups that compiled */
+    uint64_t m_misses = 0;
+
+    /** Entry count that triggers the next prune of expired entries */
+    size_t m_pruneThreshold = 64;
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_RULE_SET_CACHE_H
@@ -0,0 +1,468 @@
+// sharded_learning_memory.cpp
+#include "sharded_learning_memory.h"
+#include "memory_budget.h"
+#include <algorithm>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace ai_framework {
+
+namespace {
+
+/**
+ * @brief Random generator of the calling thread
+ */
+std::minstd_rand& LocalRandom() {
+    thread_local std::minstd_rand random(
+        static_cast<std::minstd_rand::result_type>(
+            std::random_device{}() ^ std::hash<std::thread::id>{}(std::this_thread::get_id())));
+    return random;
+}
+
+/**
+ * @brief Copy a random response of an entry and mark the entry used
+ */
+bool PickResponse(const LearningMemory& memory, uint32_t entry, std::string& response) {
+    size_t count = memory.GetResponseCount(entry);
+    if (count == 0) {
+        return false;
+    }
+
+    std::uniform_int_distribution<size_t> pick(0, count - 1);
+    response.assign(memory.GetResponse(entry, pick(LocalRandom())));
+    memory.Touch(entry);
+    return true;
+}
+
+} // namespace
+
+ShardedLearningMemory::ShardedLearningMemory(size_t maxResponses) {
+    for (auto& shard : m_shards) {
+        shard.memory.SetMaxResponses(maxResponses);
+    }
+}
+
+ShardedLearningMemory::~ShardedLearningMemory() {
+    for (auto& shard : m_shards) {
+        MemoryBudget::GetInstance().Charge(-static_cast<int64_t>(shard.chargedBytes));
+    }
+    MemoryBudget::GetInstance().Charge(-static_cast<int64_t>(m_externalBytes.load()));
+}
+
+void ShardedLearningMemory::SetByteBudget(size_t budgetBytes) {
+    m_budgetBytes.store(budgetBytes, std::memory_order_relaxed);
+    UpdateShardBudget();
+    for (auto& shard : m_shards) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        AfterWrite(shard, true);
+    }
+}
+
+void ShardedLearningMemory::SetExternalBytes(size_t bytes) {
+    size_t charged = m_externalBytes.load(std::memory_order_relaxed);
+    do {
+        int64_t delta = static_cast<int64_t>(bytes) - static_cast<int64_t>(charged);
+        if (delta < CHARGE_BATCH && delta > -CHARGE_BATCH) {
+            return;
+        }
+    } while (!m_externalBytes.compare_exchange_weak(charged, bytes, std::memory_order_relaxed));
+
+    // The shards evict down to the smaller budget as they are next written
+    MemoryBudget::GetInstance().Charge(static_cast<int64_t>(bytes) - static_cast<int64_t>(charged));
+    UpdateShardBudget();
+}
+
+void ShardedLearningMemory::UpdateShardBudget() {
+    size_t budget = m_budgetBytes.load(std::memory_order_relaxed);
+    size_t external = m_externalBytes.load(std::memory_order_relaxed);
+    m_shardBudget.store(budget == 0 ? 0 : std::max<size_t>(1, (budget - std::min(budget, external)) / SHARD_COUNT),
+                        std::memory_order_relaxed);
+}
+
+void ShardedLearningMemory::SetEvictionListener(std::function<void(uint64_t hash)> listener) {
+    m_evictionListener = std::move(listener);
+}
+
+LearningMemoryStats ShardedLearningMemory::GetStats() const {
+    LearningMemoryStats stats = {};
+    stats.budgetBytes = m_budgetBytes.load(std::memory_order_relaxed);
+    for (const auto& shard : m_shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        stats.keys += shard.memory.GetKeyCount();
+        stats.usedBytes += shard.memory.GetUsedBytes();
+        stats.evictions += shard.evictions;
+        stats.evictedBytes += shard.evictedBytes;
+        stats.coldKeys += shard.cold.GetKeyCount();
+        stats.coldBytes += shard.cold.GetMemoryBytes();
+        stats.coldRawBytes += shard.cold.GetRawBytes();
+    }
+    if (m_backend) {
+        stats.storage = m_backend->GetStats();
+    }
+    return stats;
+}
+
+void ShardedLearningMemory::SetStorageBackend(std::unique_ptr<StorageBackend> backend) {
+    m_backend = std::move(backend);
+}
+
+void ShardedLearningMemory::SetColdTier(bool enabled) {
+    m_coldTier.store(enabled, std::memory_order_relaxed);
+    if (enabled) {
+        return;
+    }
+    for (auto& shard : m_shards) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        if (m_evictionListener) {
+            shard.cold.ForEach([this](std::string_view key, const std::vector<std::string_view>&) {
+                m_evictionListener(LearningMemory::HashKey(key));
+            });
+        }
+        shard.cold.Clear();
+    }
+}
+
+uint32_t ShardedLearningMemory::Promote(Shard& shard, uint64_t hash) {
+    std::string key;
+    std::vector<std::string> responses;
+    bool found = (shard.cold.Contains(hash) && shard.cold.Take(hash, key, responses)) ||
+                 (m_backend && m_backend->MayContain(hash) && m_backend->Get(hash, key, responses));
+    if (!found) {
+        return LearningMemory::NOT_FOUND;
+    }
+    shard.memory.SetResponses(key, responses);
+    return shard.memory.Find(hash);
+}
+
+void ShardedLearningMemory::AfterWrite(Shard& shard, bool force) {
+    MemoryBudget& global = MemoryBudget::GetInstance();
+    size_t used = shard.memory.GetUsedBytes();
+
+    size_t target = used;
+    size_t budget = m_shardBudget.load(std::memory_order_relaxed);
+    if (budget != 0) {
+        target = std::min(target, budget);
+    }
+
+    // Over the process-wide ceiling: give back up to half of this shard
+    uint64_t overage = global.GetOverage();
+    if (overage > 0) {
+        target = std::min<size_t>(target, used - std::min<uint64_t>(overage, used / 2));
+    }
+
+    if (target < used) {
+        std::function<void(uint32_t)> demote;
+        if (m_backend) {
+            demote = [this, &shard](uint32_t entry) {
+                std::vector<std::string_view> responses;
+                for (size_t i = 0; i < shard.memory.GetResponseCount(entry); ++i) {
+                    responses.push_back(shard.memory.GetResponse(entry, i));
+                }
+                std::string_view key = shard.memory.GetKey(entry);
+                m_backend->Put(LearningMemory::HashKey(key), key, responses);
+            };
+        }
+        else if (m_coldTier.load(std::memory_order_relaxed)) {
+            demote = [&shard](uint32_t entry) {
+                std::vector<std::string_view> responses;
+                for (size_t i = 0; i < shard.memory.GetResponseCount(entry); ++i) {
+                    responses.push_back(shard.memory.GetResponse(entry, i));
+                }
+                std::string_view key = shard.memory.GetKey(entry);
+                shard.cold.Add(LearningMemory::HashKey(key), key, responses);
+            };
+        }
+        else if (m_evictionListener) {
+            demote = [this, &shard](uint32_t entry) {
+                m_evictionListener(LearningMemory::HashKey(shard.memory.GetKey(entry)));
+            };
+        }
+        size_t keys = shard.memory.EvictTo(target, demote);
+        size_t freed = used - shard.memory.GetUsedBytes();
+        shard.evictions += keys;
+        shard.evictedBytes += freed;
+        global.RecordEvictions(keys, freed);
+        used -= freed;
+        force = true;
+    }
+
+    // Batched so writes rarely touch the shared counter
+    int64_t delta = static_cast<int64_t>(used) - static_cast<int64_t>(shard.chargedBytes);
+    if (force || delta >= CHARGE_BATCH || delta <= -CHARGE_BATCH) {
+        global.Charge(delta);
+        shard.chargedBytes = used;
+    }
+}
+
+void ShardedLearningMemory::SetMaxResponses(size_t maxResponses) {
+    for (auto& shard : m_shards) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.memory.SetMaxResponses(maxResponses);
+        AfterWrite(shard, true);
+    }
+}
+
+size_t ShardedLearningMemory::GetMaxResponses() const {
+    std::shared_lock<std::shared_mutex> lock(m_shards[0].mutex);
+    return m_shards[0].memory.GetMaxResponses();
+}
+
+bool ShardedLearningMemory::GetRandomResponse(uint64_t hash, std::string& response) {
+    Shard& shard = ShardOf(hash);
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        uint32_t entry = shard.memory.Find(hash);
+        if (entry != LearningMemory::NOT_FOUND) {
+            return PickResponse(shard.memory, entry, response);
+        }
+        if (!shard.cold.Contains(hash) && !(m_backend && m_backend->MayContain(hash))) {
+            return false;
+        }
+    }
+
+    // A cold or stored key: move it back under the exclusive lock
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    uint32_t entry = shard.memory.Find(hash);
+    if (entry == LearningMemory::NOT_FOUND) {
+        entry = Promote(shard, hash);
+    }
+    bool found = entry != LearningMemory::NOT_FOUND && PickResponse(shard.memory, entry, response);
+    AfterWrite(shard);
+    return found;
+}
+
+bool ShardedLearningMemory::Learn(const std::vector<std::string_view>& features,
+                                  std::string_view response, WriteAheadLog* log) {
+    uint64_t hash = LearningMemory::HashKey(features);
+    Shard& shard = ShardOf(hash);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+    // The key text is only needed for new keys
+    std::string key;
+    bool added = shard.memory.Find(hash) == LearningMemory::NOT_FOUND &&
+                 Promote(shard, hash) == LearningMemory::NOT_FOUND;
+    if (added) {
+        key = LearningMemory::JoinKey(features);
+    }
+    uint32_t entry = shard.memory.AddResponse(hash, key, response);
+
+    if (log) {
+        log->Append(shard.memory.GetKey(entry), response);
+    }
+    AfterWrite(shard);
+    return added;
+}
+
+void ShardedLearningMemory::LearnBatch(const std::vector<LearnedResponse>& batch,
+                                       WriteAheadLog* log, std::vector<size_t>* newKeys) {
+    // Group the batch by shard, keeping batch order within each shard
+    std::vector<uint64_t> hashes(batch.size());
+    std::array<size_t, SHARD_COUNT + 1> offsets = {};
+    for (size_t i = 0; i < batch.size(); ++i) {
+        hashes[i] = LearningMemory::HashKey(batch[i].key);
+        ++offsets[ShardIndex(hashes[i]) + 1];
+    }
+    for (size_t s = 0; s < SHARD_COUNT; ++s) {
+        offsets[s + 1] += offsets[s];
+    }
+    std::vector<size_t> order(batch.size());
+    std::array<size_t, SHARD_COUNT> next;
+    std::copy(offsets.begin(), offsets.end() - 1, next.begin());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        order[next[ShardIndex(hashes[i])]++] = i;
+    }
+
+    for (size_t s = 0; s < SHARD_COUNT; ++s) {
+        if (offsets[s] == offsets[s + 1]) {
+            continue;
+        }
+
+        Shard& shard = m_shards[s];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        for (size_t k = offsets[s]; k < offsets[s + 1]; ++k) {
+            size_t i = order[k];
+            if (shard.memory.Find(hashes[i]) == LearningMemory::NOT_FOUND &&
+                Promote(shard, hashes[i]) == LearningMemory::NOT_FOUND && newKeys) {
+                newKeys->push_back(i);
+            }
+            shard.memory.AddResponse(hashes[i], batch[i].key, batch[i].response);
+            if (log) {
+                log->Append(batch[i].key, batch[i].response);
+            }
+        }
+        AfterWrite(shard);
+    }
+}
+
+void ShardedLearningMemory::AddResponse(std::string_view key, std::string_view response) {
+    uint64_t hash = LearningMemory::HashKey(key);
+    Shard& shard = ShardOf(hash);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    if (shard.memory.Find(hash) == LearningMemory::NOT_FOUND) {
+        Promote(shard, hash);
+    }
+    shard.memory.AddResponse(hash, key, response);
+    AfterWrite(shard);
+}
+
+void ShardedLearningMemory::SetResponses(std::string_view key, const std::vector<std::string>& responses) {
+    uint64_t hash = LearningMemory::HashKey(key);
+    Shard& shard = ShardOf(hash);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.cold.Erase(hash);
+    shard.memory.SetResponses(key, responses);
+    AfterWrite(shard);
+}
+
+void ShardedLearningMemory::ForEach(
+    const std::function<void(std::string_view, const std::vector<std::string_view>&)>& visit) const {
+
+    std::vector<std::string_view> responses;
+    for (const auto& shard : m_shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        for (uint32_t entry = 0; entry < shard.memory.GetKeyCount(); ++entry) {
+            responses.clear();
+            for (size_t i = 0; i < shard.memory.GetResponseCount(entry); ++i) {
+                responses.push_back(shard.memory.GetResponse(entry, i));
+            }
+            visit(shard.memory.GetKey(entry), responses);
+        }
+        shard.cold.ForEach(visit);
+    }
+
+    if (m_backend) {
+        // Keys read back into memory were visited above
+        m_backend->ForEach([this, &visit](uint64_t hash, std::string_view key,
+                                          const std::vector<std::string_view>& responses) {
+            const Shard& shard = ShardOf(hash);
+            {
+                std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                if (shard.memory.Find(hash) != LearningMemory::NOT_FOUND || shard.cold.Contains(hash)) {
+                    return;
+                }
+            }
+            visit(key, responses);
+        });
+    }
+}
+
+size_t ShardedLearningMemory::GetKeyCount() const {
+    size_t count = 0;
+    for (const auto& shard : m_shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        count += shard.memory.GetKeyCount() + shard.cold.GetKeyCount();
+    }
+    return count;
+}
+
+size_t ShardedLearningMemory::GetMemoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& shard : m_shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        bytes += shard.memory.GetMemoryBytes() + shard.cold.GetMemoryBytes();
+    }
+    if (m_backend) {
+        bytes += m_backend->GetStats().memoryBytes;
+    }
+    return bytes;
+}
+
+void ShardedLearningMemory::Clear() {
+    for (auto& shard : m_shards) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.memory.Clear();
+        shard.cold.Clear();
+        AfterWrite(shard, true);
+    }
+    if (m_backend) {
+        m_backend->Clear();
+    }
+}
+
+bool ShardedLearningMemory::SaveSnapshot(const std::string& path, WriteAheadLog* log) const {
+    std::vector<LearningMemory> copies;
+    std::vector<ColdStore> colds;
+    copies.reserve(SHARD_COUNT);
+    colds.reserve(SHARD_COUNT);
+    uint64_t logPosition = 0;
+    {
+        // Hold every shard so the copies and the log agree on one point in
+        // time; readers keep going, copies share the texts
+        std::vector<std::shared_lock<std::shared_mutex>> locks;
+        locks.reserve(SHARD_COUNT);
+        for (const auto& shard : m_shards) {
+            locks.emplace_back(shard.mutex);
+        }
+        for (const auto& shard : m_shards) {
+            copies.push_back(shard.memory);
+            colds.push_back(shard.cold);
+        }
+        // Without a new segment the snapshot cannot say which records it
+        // covers; keep the previous snapshot and every segment instead
+        if (log && !log->Rotate(logPosition)) {
+            return false;
+        }
+    }
+
+    // Cold keys are written like the others; loading brings them back hot
+    for (size_t i = 0; i < SHARD_COUNT; ++i) {
+        LearningMemory& copy = copies[i];
+        colds[i].ForEach([&copy](std::string_view key, const std::vector<std::string_view>& responses) {
+            copy.SetResponses(key, std::vector<std::string>(responses.begin(), responses.end()));
+        });
+    }
+
+    // Keys evicted before the copy point are only in the backend
+    if (m_backend && !m_backend->Flush()) {
+        return false;
+    }
+
+    std::vector<const LearningMemory*> memories;
+    for (const auto& copy : copies) {
+        memories.push_back(&copy);
+    }
+    if (!LearningMemory::SaveSnapshots(path, memories, logPosition)) {
+        return false;
+    }
+
+    if (log) {
+        log->RemoveSegmentsUpTo(logPosition);
+    }
+    return true;
+}
+
+bool ShardedLearningMemory::LoadSnapshot(const std::string& path, uint64_t* logPosition) {
+    std::vector<LearningMemory> memories;
+    if (!LearningMemory::LoadSnapshots(path, memories, logPosition)) {
+        return false;
+    }
+
+    if (memories.size() == SHARD_COUNT) {
+        for (size_t i = 0; i < SHARD_COUNT; ++i) {
+            std::unique_lock<std::shared_mutex> lock(m_shards[i].mutex);
+            m_shards[i].memory = std::move(memories[i]);
+            m_shards[i].cold.Clear();
+            AfterWrite(m_shards[i], true);
+        }
+        return true;
+    }
+
+    // Written with another shard layout; rehash every key
+    size_t maxResponses = GetMaxResponses();
+    Clear();
+    for (const auto& memory : memories) {
+        maxResponses = std::max(maxResponses, memory.GetMaxResponses());
+    }
+    SetMaxResponses(maxResponses);
+    for (const auto& memory : memories) {
+        for (uint32_t entry = 0; entry < memory.GetKeyCount(); ++entry) {
+            for (size_t i = 0; i < memory.GetResponseCount(entry); ++i) {
+                AddResponse(memory.GetKey(entry), memory.GetResponse(entry, i));
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace ai_framework
@@ -0,0 +1,375 @@
+// sharded_learning_memory.h
+#ifndef AI_FRAMEWORK_SHARDED_LEARNING_MEMORY_H
+#define AI_FRAMEWORK_SHARDED_LEARNING_MEMORY_H
+
+#include "cold_store.h"
+#include "learning_memory.h"
+#include "learning_queue.h"
+#include "storage_backend.h"
+#include "write_ahead_log.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief Size and eviction counters of one agent's memory
+ */
+struct LearningMemoryStats {
+    /** Keys in the uncompressed memory */
+    size_t keys;
+
+    /** Bytes accounted for the keys, see LearningMemory::GetUsedBytes */
+    size_t usedBytes;
+
+    /** Configured budget, 0 for none */
+    size_t budgetBytes;
+
+    /** Keys evicted so far */
+    uint64_t evictions;
+
+    /** Bytes freed by evictions */
+    uint64_t evictedBytes;
+
+    /** Keys in the compressed cold tier */
+    size_t coldKeys;
+
+    /** Bytes held by the cold tier */
+    size_t coldBytes;
+
+    /** Uncompressed size of the cold tier's records */
+    size_t coldRawBytes;
+
+    /** Counters of the storage backend, zero without one */
+    StorageBackendStats storage;
+};
+
+/**
+ * @brief LearningMemory split into independently locked shards
+ *
+ * Keys are spread over the shards by the top bits of their hash. Each shard
+ * has its own reader-writer lock, so lookups on one agent run in parallel and
+ * learning for keys in different shards does not contend. Random responses
+ * are drawn from a thread-local generator instead of the globally locked
+ * std::rand.
+ *
+ * After every write the written shard evicts keys, approximately least
+ * recently used first, while it exceeds its share of the memory's byte
+ * budget or while the process-wide MemoryBudget is exceeded. Growth is
+ * charged to the MemoryBudget in batches of CHARGE_BATCH bytes per shard.
+ *
+ * With the cold tier enabled, evicted keys are not dropped but compressed
+ * into the shard's ColdStore, outside the budget. Using a cold key (reading
+ * or learning it) moves it back into the shard's memory, so hot keys are
+ * served exactly as without the tier.
+ *
+ * With a storage backend, evicted keys are written to it instead, and a
+ * key missing from memory is read back from it. The backend's copy is kept
+ * when a key is read back; the copy in memory shadows it until the key is
+ * evicted again and replaces it.
+ *
+ * Bytes held for the memory elsewhere, such as a search index over its
+ * keys, can be charged to it; they come out of the byte budget before it is
+ * split over the shards, and are charged to the MemoryBudget as well.
+ * Thread-safe.
+ */
+class ShardedLearningMemory {
+public:
+    /** Number of shards, a power of two */
+    static constexpr size_t SHARD_COUNT = 16;
+
+    /** Bytes a shard grows or shrinks before charging the MemoryBudget */
+    static constexpr int64_t CHARGE_BATCH = 16 * 1024;
+
+    /**
+     * @brief Constructor for ShardedLearningMemory
+     *
+     * @param maxResponses Responses kept per key; the oldest are dropped
+     */
+    explicit ShardedLearningMemory(size_t maxResponses = 10);
+
+    /**
+     * @brief Destructor; returns the charged bytes to the MemoryBudget
+     */
+    ~ShardedLearningMemory();
+
+    /**
+     * @brief Limit the bytes of this memory, evicting keys beyond it
+     *
+     * @param budgetBytes Budget, split evenly over the shards; 0 for none
+     */
+    void SetByteBudget(size_t budgetBytes);
+
+    /**
+     * @brief Count bytes held for this memory outside its shards
+     *
+     * The bytes reduce the budget left to the shards; changes smaller than
+     * CHARGE_BATCH are ignored.
+     *
+     * @param bytes Current size of the outside data
+     */
+    void SetExternalBytes(size_t bytes);
+
+    /**
+     * @brief Set the function told about every key evicted and dropped
+     *
+     * Keys moved to the cold tier or the storage backend are not reported,
+     * but cold keys dropped by disabling the tier are. The listener runs
+     * under a shard's lock and must not call into this memory, not even
+     * SetExternalBytes; record what changed and act on it once the call
+     * that evicted returns. Call before the memory is shared between
+     * threads.
+     *
+     * @param listener Called with the hash of each dropped key, or null
+     */
+    void SetEvictionListener(std::function<void(uint64_t hash)> listener);
+
+    /**
+     * @brief Keep evicted keys compressed instead of dropping them
+     *
+     * @param enabled True to keep evicted keys in the cold tier
+     */
+    void SetColdTier(bool enabled);
+
+    /**
+     * @brief Write evicted keys to a backend instead of the cold tier
+     *
+     * Call before the memory is shared between threads.
+     *
+     * @param backend Backend keeping the evicted keys, null for none
+     */
+    void SetStorageBackend(std::unique_ptr<StorageBackend> backend);
+
+    /**
+     * @brief Check whether evicted keys go to a storage backend
+     *
+     * @return bool True if a backend is set
+     */
+    bool HasStorageBackend() const {
+        return m_backend != nullptr;
+    }
+
+    /**
+     * @brief Get the size and eviction counters
+     *
+     * @return LearningMemoryStats Current counters
+     */
+    LearningMemoryStats GetStats() const;
+
+    /**
+     * @brief Change the number of responses kept per key
+     *
+     * @param maxResponses Responses kept per key, at least 1
+     */
+    void SetMaxResponses(size_t maxResponses);
+
+    /**
+     * @brief Get the number of responses kept per key
+     *
+     * @return size_t Ring capacity
+     */
+    size_t GetMaxResponses() const;
+
+    /**
+     * @brief Pick one of a key's responses at random
+     *
+     * A key found in the cold tier or the storage backend is moved back
+     * into memory first.
+     *
+     * @param hash Key hash
+     * @param response Receives the response
+     * @return bool True if the key has a response
+     */
+    bool GetRandomResponse(uint64_t hash, std::string& response);
+
+    /**
+     * @brief Record a response for the key of a feature list
+     *
+     * @param features Features of a message, must not be empty
+     * @param response Response to record
+     * @param log If not null, receives the record while the shard is locked,
+     *            so the log holds each key's responses in memory order
+     * @return bool True if the key was new
+     */
+    bool Learn(const std::vector<std::string_view>& features, std::string_view response,
+               WriteAheadLog* log = nullptr);
+
+    /**
+     * @brief Record a batch of responses, locking each shard once
+     *
+     * Responses for the same key are recorded in batch order.
+     *
+     * @param batch Responses with their key strings
+     * @param log If not null, receives the records while their shard is locked
+     * @param newKeys If not null, receives the batch indexes of keys that were new
+     */
+    void LearnBatch(const std::vector<LearnedResponse>& batch, WriteAheadLog* log = nullptr,
+                    std::vector<size_t>* newKeys = nullptr);
+
+    /**
+     * @brief Record a response for a key string
+     *
+     * @param key Key string
+     * @param response Response to record
+     */
+    void AddResponse(std::string_view key, std::string_view response);
+
+    /**
+     * @brief Replace all responses of a key
+     *
+     * @param key Key string
+     * @param responses New responses, oldest first
+     */
+    void SetResponses(std::string_view key, const std::vector<std::string>& responses);
+
+    /**
+     * @brief Visit every key with its responses, oldest first
+     *
+     * Each shard is read-locked while it is visited. Keys held only by the
+     * storage backend are visited last, without any shard lock.
+     *
+     * @param visit Called once per key
+     */
+    void ForEach(const std::function<void(std::string_view key,
+                                          const std::vector<std::string_view>& responses)>& visit) const;
+
+    /**
+     * @brief Get the number of keys
+     *
+     * @return size_t Number of keys over all shards; keys held only by the
+     *         storage backend are not counted
+     */
+    size_t GetKeyCount() const;
+
+    /**
+     * @brief Get the bytes used by all shards
+     *
+     * @return size_t Approximate resident bytes
+     */
+    size_t GetMemoryBytes() const;
+
+    /**
+     * @brief Remove every key, including those of the storage backend
+     */
+    void Clear();
+
+    /**
+     * @brief Write all shards to one snapshot file
+     *
+     * Writers are held off only while the shard tables are copied; the file
+     * is written from the copies. With a log, the log is rotated at the copy
+     * point, the snapshot records the closed generation, and the segments it
+     * covers are deleted once the snapshot is on disk. If the log cannot be
+     * rotated, nothing is written and no segment is deleted. Keys in the
+     * storage backend are not written; the backend is flushed instead.
+     *
+     * @param path Path of the snapshot
+     * @param log Write-ahead log of this memory, or null
+     * @return bool True if the snapshot was written
+     */
+    bool SaveSnapshot(const std::string& path, WriteAheadLog* log = nullptr) const;
+
+    /**
+     * @brief Replace the memory with a snapshot file
+     *
+     * A snapshot with one memory per shard is mapped without copying any
+     * text; other snapshots, such as those of a single LearningMemory, are
+     * redistributed over the shards. The memory is left unchanged if the
+     * file is missing or invalid.
+     *
+     * @param path Path of the snapshot
+     * @param logPosition If not null, receives the stored log position
+     * @return bool True if the snapshot was loaded
+     */
+    bool LoadSnapshot(const std::string& path, uint64_t* logPosition = nullptr);
+
+private:
+    /**
+     * @brief One shard, on its own cache lines so shard locks do not false-share
+     */
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        LearningMemory memory;
+
+        /** Bytes charged to the MemoryBudget so far */
+        size_t chargedBytes = 0;
+
+        /** Eviction counters */
+        uint64_t evictions = 0;
+        uint64_t evictedBytes = 0;
+
+        /** Evicted keys, while the cold tier is enabled */
+        ColdStore cold;
+    };
+
+    /**
+     * @brief Move a key from the cold tier or the backend back into the shard's memory
+     *
+     * Needs the shard's exclusive lock.
+     *
+     * @return uint32_t Entry of the key, LearningMemory::NOT_FOUND if it is
+     *         neither cold nor stored
+     */
+    uint32_t Promote(Shard& shard, uint64_t hash);
+
+    /**
+     * @brief Evict as the budgets require and charge the MemoryBudget
+     *
+     * Needs the shard's exclusive lock.
+     *
+     * @param force Charge even a change smaller than CHARGE_BATCH
+     */
+    void AfterWrite(Shard& shard, bool force = false);
+
+    Shard& ShardOf(uint64_t hash) {
+        return m_shards[ShardIndex(hash)];
+    }
+
+    const Shard& ShardOf(uint64_t hash) const {
+        return m_shards[ShardIndex(hash)];
+    }
+
+    static size_t ShardIndex(uint64_t hash) {
+        return static_cast<size_t>(hash >> (64 - SHARD_BITS));
+    }
+
+    static constexpr unsigned SHARD_BITS = 4;
+    static_assert((size_t(1) << SHARD_BITS) == SHARD_COUNT, "SHARD_BITS must match SHARD_COUNT");
+
+    std::array<Shard, SHARD_COUNT> m_shards;
+
+    /**
+     * @brief Split the byte budget left after external bytes over the shards
+     */
+    void UpdateShardBudget();
+
+    /** Budget of the whole memory, 0 for none */
+    std::atomic<size_t> m_budgetBytes{0};
+
+    /** Budget of each shard, 0 for none */
+    std::atomic<size_t> m_shardBudget{0};
+
+    /** Bytes charged by SetExternalBytes */
+    std::atomic<size_t> m_externalBytes{0};
+
+    /** Told about dropped keys, or null */
+    std::function<void(uint64_t hash)> m_evictionListener;
+
+    /** Whether evicted keys move to the cold tier */
+    std::atomic<bool> m_coldTier{false};
+
+    /** Backend of evicted keys, or null */
+    std::unique_ptr<StorageBackend> m_backend;
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_SHARDED_LEARNING_MEMORY_H
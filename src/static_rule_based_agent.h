@@ -0,0 +1,81 @@
+// static_rule_based_agent.h
+#ifndef AI_FRAMEWORK_STATIC_RULE_BASED_AGENT_H
+#define AI_FRAMEWORK_STATIC_RULE_BASED_AGENT_H
+
+#include "agent.h"
+#include "logging_service.h"
+#include "static_rule_set.h"
+#include <string>
+
+namespace ai_framework {
+
+/**
+ * @brief Rule-based agent whose rules are fixed at build time
+ * 
+ * Answers like RuleBasedAgent, but from a StaticRuleSet: the rules are
+ * compiled with the program, so initialization does no parsing or regex
+ * compilation.
+ * 
+ * @tparam RuleSet A StaticRuleSet instantiation
+ */
+template <typename RuleSet>
+class StaticRuleBasedAgent : public Agent {
+public:
+    /**
+     * @brief Constructor for StaticRuleBasedAgent
+     * 
+     * @param env Reference to SObjectizer environment
+     * @param id Unique identifier for this agent
+     * @param defaultResponse Response if no rule matches
+     */
+    StaticRuleBasedAgent(
+        so_5::environment_t& env, 
+        std::string id,
+        std::string defaultResponse = "I don't have a specific rule for that.")
+        : Agent(env, std::move(id)), 
+          m_defaultResponse(std::move(defaultResponse)) {
+    }
+    
+    /**
+     * @brief Destructor for StaticRuleBasedAgent
+     */
+    virtual ~StaticRuleBasedAgent() = default;
+    
+    /**
+     * @brief Initialize the agent; the configuration is not used
+     * 
+     * @param config Configuration parameters for this agent (ignored)
+     * @return bool Always true
+     */
+    virtual bool Initialize(const std::string& /*config*/) override {
+        LoggingService::GetInstance().Log(
+            LogLevel::INFO, 
+            "StaticRuleBasedAgent " + m_id + " initialized with " + 
+            std::to_string(RuleSet::GetRuleCount()) + " built-in rules");
+        return true;
+    }
+    
+    /**
+     * @brief Process a message received by this agent
+     * 
+     * @param message The message to process
+     * @return std::string Response to the message
+     */
+    virtual std::string ProcessMessage(const std::string& message) override {
+        size_t rule = RuleSet::FindMatch(message);
+        if (rule != RuleSet::NO_MATCH) {
+            return RuleSet::GenerateResponse(rule, m_id);
+        }
+        
+        // No matching rule, return default response
+        return m_defaultResponse;
+    }
+
+private:
+    /** Default response if no rule matches */
+    std::string m_defaultResponse;
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_STATIC_RULE_BASED_AGENT_H
@@ -0,0 +1,322 @@
+// static_rule_set.h
+#ifndef AI_FRAMEWORK_STATIC_RULE_SET_H
+#define AI_FRAMEWORK_STATIC_RULE_SET_H
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace ai_framework {
+namespace static_rules {
+
+/**
+ * @brief Single-character atom of a compiled static pattern
+ */
+struct Token {
+    enum class Kind {
+        /** One specific character (already case folded) */
+        Char,
+        /** Any character except a line terminator (.) */
+        Any
+    };
+
+    enum class Quantifier {
+        /** Exactly once */
+        One,
+        /** Zero or more times (*) */
+        Star,
+        /** Zero or one time (?) */
+        Optional
+    };
+
+    Kind kind = Kind::Char;
+    Quantifier quantifier = Quantifier::One;
+    char c = '\0';
+};
+
+/**
+ * @brief Pattern compiled at build time into a token array
+ *
+ * @tparam N Upper bound on the token count (the pattern length)
+ */
+template <size_t N>
+struct Program {
+    std::array<Token, N + 1> tokens{};
+    size_t count = 0;
+    bool anchoredBegin = false;
+    bool anchoredEnd = false;
+
+    /** False if the pattern uses syntax outside the supported subset */
+    bool valid = true;
+};
+
+/**
+ * @brief ASCII case folding, matching the std::regex::icase rules use
+ */
+constexpr char FoldCase(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+/**
+ * @brief Check whether a character may appear unescaped as a literal
+ */
+constexpr bool IsLiteral(char c) {
+    switch (c) {
+        case '\\': case '.': case '*': case '+': case '?': case '^': case '$':
+        case '(': case ')': case '[': case ']': case '{': case '}': case '|':
+            return false;
+        default:
+            return true;
+    }
+}
+
+/**
+ * @brief Compile a pattern of the static subset
+ *
+ * Supported: literal characters, escaped metacharacters, '.', the
+ * quantifiers '*', '+' and '?' on a single atom, and the anchors '^' and
+ * '$' at the ends. Anything else (groups, alternation, classes, counted
+ * repeats) clears Program::valid.
+ *
+ * @tparam N Pattern length
+ * @param pattern ECMAScript pattern, matched case-insensitively
+ * @return Program<N> Compiled pattern
+ */
+template <size_t N>
+constexpr Program<N> Compile(std::string_view pattern) {
+    Program<N> program;
+    size_t pos = 0;
+    size_t end = pattern.size();
+
+    if (pos < end && pattern[pos] == '^') {
+        program.anchoredBegin = true;
+        ++pos;
+    }
+    if (end > pos && pattern[end - 1] == '$' &&
+        (end < 2 || pattern[end - 2] != '\\')) {
+        program.anchoredEnd = true;
+        --end;
+    }
+
+    while (pos < end) {
+        Token token;
+        char c = pattern[pos++];
+        if (c == '.') {
+            token.kind = Token::Kind::Any;
+        }
+        else if (c == '\\') {
+            if (pos >= end || IsLiteral(pattern[pos])) {
+                // Class escapes (\d, \w, ...) and back-references are not supported
+                program.valid = false;
+                return program;
+            }
+            token.c = FoldCase(pattern[pos++]);
+        }
+        else if (IsLiteral(c)) {
+            token.c = FoldCase(c);
+        }
+        else {
+            program.valid = false;
+            return program;
+        }
+
+        if (pos < end) {
+            if (pattern[pos] == '*') {
+                token.quantifier = Token::Quantifier::Star;
+                ++pos;
+            }
+            else if (pattern[pos] == '?') {
+                token.quantifier = Token::Quantifier::Optional;
+                ++pos;
+            }
+            else if (pattern[pos] == '+') {
+                // x+ is x followed by x*
+                program.tokens[program.count++] = token;
+                token.quantifier = Token::Quantifier::Star;
+                ++pos;
+            }
+        }
+        if (pos < end && (pattern[pos] == '*' || pattern[pos] == '+' || pattern[pos] == '?')) {
+            // Stacked or lazy quantifiers
+            program.valid = false;
+            return program;
+        }
+        program.tokens[program.count++] = token;
+    }
+
+    return program;
+}
+
+/**
+ * @brief Search a message for a compiled pattern
+ *
+ * Runs the pattern as an NFA whose state set is sized at compile time, so
+ * the search is O(message length * pattern length) with no backtracking and
+ * no allocation.
+ *
+ * @param program Compiled pattern
+ * @param message Message to search
+ * @return bool True if the pattern matches anywhere in the message
+ */
+template <size_t N>
+constexpr bool Search(const Program<N>& program, std::string_view message) {
+    std::array<bool, N + 1> current{};
+    std::array<bool, N + 1> next{};
+
+    // Enter a state and every state reachable by skipping optional tokens
+    auto add = [&program](std::array<bool, N + 1>& states, size_t state) {
+        while (!states[state]) {
+            states[state] = true;
+            if (state == program.count ||
+                program.tokens[state].quantifier == Token::Quantifier::One) {
+                break;
+            }
+            ++state;
+        }
+    };
+
+    add(current, 0);
+    for (size_t i = 0; ; ++i) {
+        if (current[program.count] &&
+            (!program.anchoredEnd || i == message.size())) {
+            return true;
+        }
+        if (i == message.size()) {
+            return false;
+        }
+
+        char c = FoldCase(message[i]);
+        bool any = false;
+        for (size_t state = 0; state < program.count; ++state) {
+            if (!current[state]) {
+                continue;
+            }
+            const Token& token = program.tokens[state];
+            bool accepts = token.kind == Token::Kind::Any ?
+                (c != '\n' && c != '\r') : c == token.c;
+            if (accepts) {
+                add(next, token.quantifier == Token::Quantifier::Star ? state : state + 1);
+                any = true;
+            }
+        }
+
+        // An unanchored pattern may start at every position
+        if (!program.anchoredBegin) {
+            add(next, 0);
+            any = true;
+        }
+        if (!any) {
+            return false;
+        }
+
+        current = next;
+        next = std::array<bool, N + 1>{};
+    }
+}
+
+/**
+ * @brief Compiled form of one rule type
+ *
+ * @tparam Rule Type with static constexpr std::string_view members
+ *              "pattern" and "response"
+ */
+template <typename Rule>
+struct CompiledRule {
+    static constexpr auto program = Compile<Rule::pattern.size()>(Rule::pattern);
+    static_assert(program.valid,
+                  "Static rule pattern uses syntax outside the supported subset");
+};
+
+} // namespace static_rules
+
+/**
+ * @brief Rule set declared in C++ and compiled at build time
+ *
+ * Each rule is a type with static constexpr "pattern" and "response"
+ * string_view members; rules are listed in priority order, the first
+ * matching one answers. Patterns are validated by static_assert and
+ * matched by code specialized for each pattern, so there is no JSON to
+ * parse and no std::regex to compile at startup. Responses may contain
+ * ${agent_id}; capture references are not available.
+ *
+ * @code
+ * struct Greeting {
+ *     static constexpr std::string_view pattern = ".*hello.*";
+ *     static constexpr std::string_view response = "Hi there!";
+ * };
+ * using Rules = StaticRuleSet<Greeting>;
+ * @endcode
+ *
+ * @tparam Rules Rule types in priority order
+ */
+template <typename... Rules>
+class StaticRuleSet {
+    static_assert(sizeof...(Rules) > 0, "A static rule set needs at least one rule");
+
+public:
+    /** Returned by FindMatch when no rule matches */
+    static constexpr size_t NO_MATCH = static_cast<size_t>(-1);
+
+    /**
+     * @brief Get the number of rules
+     *
+     * @return size_t Number of rules in the set
+     */
+    static constexpr size_t GetRuleCount() {
+        return sizeof...(Rules);
+    }
+
+    /**
+     * @brief Find the highest priority rule matching a message
+     *
+     * @param message The message to match
+     * @return size_t Index of the matched rule, or NO_MATCH
+     */
+    static constexpr size_t FindMatch(std::string_view message) {
+        return FindMatchImpl(message, std::index_sequence_for<Rules...>{});
+    }
+
+    /**
+     * @brief Generate the response of a matched rule
+     *
+     * @param index Index of the matched rule
+     * @param agentId ID substituted for ${agent_id}
+     * @return std::string Generated response
+     */
+    static std::string GenerateResponse(size_t index, std::string_view agentId) {
+        static constexpr std::string_view AGENT_ID_SLOT = "${agent_id}";
+
+        std::string_view response = RESPONSES[index];
+        std::string result;
+        result.reserve(response.size() + agentId.size());
+
+        size_t pos = 0;
+        for (size_t slot = response.find(AGENT_ID_SLOT); slot != std::string_view::npos;
+             slot = response.find(AGENT_ID_SLOT, pos)) {
+            result.append(response.substr(pos, slot - pos));
+            result.append(agentId);
+            pos = slot + AGENT_ID_SLOT.size();
+        }
+        result.append(response.substr(pos));
+        return result;
+    }
+
+private:
+    /** Response templates in rule order */
+    static constexpr std::string_view RESPONSES[] = {Rules::response...};
+
+    template <size_t... I>
+    static constexpr size_t FindMatchImpl(std::string_view message, std::index_sequence<I...>) {
+        size_t result = NO_MATCH;
+        // Short-circuits at the first matching rule
+        (void)((static_rules::Search(static_rules::CompiledRule<Rules>::program, message) ?
+                (result = I, true) : false) || ...);
+        return result;
+    }
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_STATIC_RULE_SET_H
@@ -0,0 +1,21 @@
+// storage_backend.cpp
+#include "storage_backend.h"
+#include "logging_service.h"
+#include "lsm_store.h"
+
+namespace ai_framework {
+
+std::unique_ptr<StorageBackend> StorageBackend::Create(const std::string& type, const std::string& path) {
+    if (type != "lsm") {
+        LoggingService::GetInstance().Log(LogLevel::ERROR, "Unknown storage backend type: " + type);
+        return nullptr;
+    }
+
+    auto store = std::make_unique<LsmStore>(path);
+    if (!store->Open()) {
+        return nullptr;
+    }
+    return store;
+}
+
+} // namespace ai_framework
@@ -0,0 +1,119 @@
+// storage_backend.h
+#ifndef AI_FRAMEWORK_STORAGE_BACKEND_H
+#define AI_FRAMEWORK_STORAGE_BACKEND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief Size and cache counters of a storage backend
+ */
+struct StorageBackendStats {
+    /** Records written and not yet merged away; a key may be counted more than once */
+    size_t records;
+
+    /** Bytes held in memory: write buffers, indexes, filters and the block cache */
+    size_t memoryBytes;
+
+    /** Bytes of the files on disk */
+    size_t diskBytes;
+
+    /** Immutable files on disk */
+    size_t segments;
+
+    /** Block reads served by the cache and from disk */
+    uint64_t cacheHits;
+    uint64_t cacheMisses;
+
+    /** Lookups answered by a filter without reading a block */
+    uint64_t filterSkips;
+};
+
+/**
+ * @brief Storage for learned keys beyond the memory budget
+ *
+ * ShardedLearningMemory writes the keys it evicts to the backend and reads
+ * them back when they are used again. Keys are identified by their hash,
+ * see LearningMemory::HashKey; a Put replaces the stored record of the same
+ * hash. Implementations are thread-safe.
+ */
+class StorageBackend {
+public:
+    virtual ~StorageBackend() = default;
+
+    /**
+     * @brief Create a backend of the specified type
+     *
+     * @param type Backend type; "lsm" for LsmStore
+     * @param path Directory of the backend's files
+     * @return std::unique_ptr<StorageBackend> The opened backend, or null if
+     *         the type is unknown or the files cannot be opened
+     */
+    static std::unique_ptr<StorageBackend> Create(const std::string& type, const std::string& path);
+
+    /**
+     * @brief Store a key with its responses
+     *
+     * @param hash Key hash
+     * @param key Key string
+     * @param responses Responses, oldest first
+     */
+    virtual void Put(uint64_t hash, std::string_view key,
+                     const std::vector<std::string_view>& responses) = 0;
+
+    /**
+     * @brief Check cheaply whether a key may be stored
+     *
+     * @param hash Key hash
+     * @return bool False if the key is certainly not stored
+     */
+    virtual bool MayContain(uint64_t hash) const = 0;
+
+    /**
+     * @brief Read the record of a key
+     *
+     * @param hash Key hash
+     * @param key Receives the key string
+     * @param responses Receives the responses, oldest first
+     * @return bool True if the key is stored
+     */
+    virtual bool Get(uint64_t hash, std::string& key, std::vector<std::string>& responses) const = 0;
+
+    /**
+     * @brief Visit every stored key with its responses, in hash order
+     *
+     * @param visit Called once per key
+     */
+    virtual void ForEach(const std::function<void(uint64_t hash, std::string_view key,
+                                                  const std::vector<std::string_view>& responses)>& visit) const = 0;
+
+    /**
+     * @brief Make every stored record durable
+     *
+     * @return bool True if all records reached the disk
+     */
+    virtual bool Flush() = 0;
+
+    /**
+     * @brief Remove every key
+     */
+    virtual void Clear() = 0;
+
+    /**
+     * @brief Get the size and cache counters
+     *
+     * @return StorageBackendStats Current counters
+     */
+    virtual StorageBackendStats GetStats() const = 0;
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_STORAGE_BACKEND_H
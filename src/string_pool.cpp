@@ -0,0 +1,120 @@
+// string_pool.cpp
+#include "string_pool.h"
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+namespace ai_framework {
+
+StringPool& StringPool::GetInstance() {
+    static StringPool instance;
+    return instance;
+}
+
+StringPool::~StringPool() {
+    for (auto& segment : m_segments) {
+        delete[] segment.load(std::memory_order_relaxed);
+    }
+}
+
+StringPool::Handle StringPool::Intern(std::string_view text) {
+    uint64_t hash = std::hash<std::string_view>{}(text);
+    Shard& shard = ShardOf(hash);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.handles.find(text);
+    if (it != shard.handles.end()) {
+        // Revives the entry even if its count just dropped to zero; the
+        // releasing thread frees only under this lock
+        EntryOf(it->second).references.fetch_add(1, std::memory_order_relaxed);
+        m_references.fetch_add(1, std::memory_order_relaxed);
+        m_referencedBytes.fetch_add(text.size(), std::memory_order_relaxed);
+        return it->second;
+    }
+
+    Handle handle = AllocateHandle();
+    Entry& entry = EntryOf(handle);
+    entry.text.reset(new char[text.size() == 0 ? 1 : text.size()]);
+    if (!text.empty()) {
+        std::memcpy(entry.text.get(), text.data(), text.size());
+    }
+    entry.length = static_cast<uint32_t>(text.size());
+    entry.hash = hash;
+    entry.references.store(1, std::memory_order_relaxed);
+    shard.handles.emplace(std::string_view(entry.text.get(), entry.length), handle);
+
+    m_uniqueStrings.fetch_add(1, std::memory_order_relaxed);
+    m_uniqueBytes.fetch_add(text.size(), std::memory_order_relaxed);
+    m_references.fetch_add(1, std::memory_order_relaxed);
+    m_referencedBytes.fetch_add(text.size(), std::memory_order_relaxed);
+    return handle;
+}
+
+void StringPool::Retain(Handle handle) {
+    Entry& entry = EntryOf(handle);
+    entry.references.fetch_add(1, std::memory_order_relaxed);
+    m_references.fetch_add(1, std::memory_order_relaxed);
+    m_referencedBytes.fetch_add(entry.length, std::memory_order_relaxed);
+}
+
+void StringPool::Release(Handle handle) {
+    Entry& entry = EntryOf(handle);
+    m_references.fetch_sub(1, std::memory_order_relaxed);
+    m_referencedBytes.fetch_sub(entry.length, std::memory_order_relaxed);
+
+    // Drop anything but the last reference without a lock
+    uint32_t references = entry.references.load(std::memory_order_relaxed);
+    while (references > 1) {
+        if (entry.references.compare_exchange_weak(references, references - 1,
+                                                   std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+
+    // The last reference goes under the shard lock, so Intern cannot
+    // revive the entry while it is being freed
+    Shard& shard = ShardOf(entry.hash);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (entry.references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        shard.handles.erase(std::string_view(entry.text.get(), entry.length));
+        m_uniqueStrings.fetch_sub(1, std::memory_order_relaxed);
+        m_uniqueBytes.fetch_sub(entry.length, std::memory_order_relaxed);
+        entry.text.reset();
+        entry.length = 0;
+    }
+
+    std::lock_guard<std::mutex> lock(m_allocationMutex);
+    m_freeHandles.push_back(handle);
+}
+
+StringPoolStats StringPool::GetStats() const {
+    StringPoolStats stats;
+    stats.uniqueStrings = m_uniqueStrings.load(std::memory_order_relaxed);
+    stats.uniqueBytes = m_uniqueBytes.load(std::memory_order_relaxed);
+    stats.references = m_references.load(std::memory_order_relaxed);
+    stats.referencedBytes = m_referencedBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+StringPool::Handle StringPool::AllocateHandle() {
+    std::lock_guard<std::mutex> lock(m_allocationMutex);
+    if (!m_freeHandles.empty()) {
+        Handle handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+        return handle;
+    }
+
+    size_t segment = m_nextHandle >> SEGMENT_BITS;
+    if (segment >= MAX_SEGMENTS) {
+        throw std::length_error("String pool is full");
+    }
+    if (m_segments[segment].load(std::memory_order_relaxed) == nullptr) {
+        m_segments[segment].store(new Entry[SEGMENT_SIZE], std::memory_order_release);
+    }
+    return static_cast<Handle>(m_nextHandle++);
+}
+
+} // namespace ai_framework
@@ -0,0 +1,176 @@
+// string_pool.h
+#ifndef AI_FRAMEWORK_STRING_POOL_H
+#define AI_FRAMEWORK_STRING_POOL_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief Counters describing how much the string pool deduplicates
+ */
+struct StringPoolStats {
+    /** Distinct strings currently stored */
+    uint64_t uniqueStrings;
+
+    /** Bytes of the distinct strings */
+    uint64_t uniqueBytes;
+
+    /** References held to pooled strings */
+    uint64_t references;
+
+    /** Bytes the references would take as separate copies */
+    uint64_t referencedBytes;
+
+    /**
+     * @brief Get the bytes saved per byte stored
+     *
+     * @return double referencedBytes / uniqueBytes, 1 when the pool is empty
+     */
+    double GetDedupRatio() const {
+        return uniqueBytes == 0 ? 1.0 : static_cast<double>(referencedBytes) / uniqueBytes;
+    }
+};
+
+/**
+ * @brief Process-wide pool of reference-counted interned strings
+ *
+ * Equal strings are stored once and addressed by a 32-bit handle, so the
+ * same response learned by many keys and many agents costs four bytes per
+ * use instead of a copy. A string is freed when its last reference is
+ * released and its handle is reused later. Get takes no lock; interning and
+ * releasing the last reference lock one of several shards.
+ */
+class StringPool {
+public:
+    /** Handle of a pooled string */
+    using Handle = uint32_t;
+
+    /**
+     * @brief Get the singleton instance of StringPool
+     *
+     * @return StringPool& Reference to the StringPool instance
+     */
+    static StringPool& GetInstance();
+
+    /**
+     * @brief Destructor; frees every string
+     */
+    ~StringPool();
+
+    /**
+     * @brief Get the handle of a string, storing it if needed
+     *
+     * @param text String to intern
+     * @return Handle Handle holding one new reference
+     */
+    Handle Intern(std::string_view text);
+
+    /**
+     * @brief Add a reference to a handle the caller already references
+     *
+     * @param handle Pooled string
+     */
+    void Retain(Handle handle);
+
+    /**
+     * @brief Drop a reference, freeing the string with the last one
+     *
+     * @param handle Pooled string
+     */
+    void Release(Handle handle);
+
+    /**
+     * @brief Get a pooled string
+     *
+     * @param handle Handle the caller holds a reference to
+     * @return std::string_view The string, valid while the reference is held
+     */
+    std::string_view Get(Handle handle) const {
+        const Entry& entry = m_segments[handle >> SEGMENT_BITS].load(std::memory_order_acquire)
+                                 [handle & (SEGMENT_SIZE - 1)];
+        return std::string_view(entry.text.get(), entry.length);
+    }
+
+    /**
+     * @brief Get the pool counters
+     *
+     * @return StringPoolStats Current counters
+     */
+    StringPoolStats GetStats() const;
+
+private:
+    /**
+     * @brief Stored string and its reference count
+     */
+    struct Entry {
+        std::unique_ptr<char[]> text;
+        uint32_t length = 0;
+        std::atomic<uint32_t> references{0};
+        uint64_t hash = 0;
+    };
+
+    /**
+     * @brief Lookup table of one shard
+     */
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string_view, Handle> handles;
+    };
+
+    /** Entries per segment; segments never move once allocated */
+    static constexpr unsigned SEGMENT_BITS = 16;
+    static constexpr size_t SEGMENT_SIZE = size_t(1) << SEGMENT_BITS;
+    static constexpr size_t MAX_SEGMENTS = size_t(1) << (32 - SEGMENT_BITS);
+    static constexpr size_t SHARD_COUNT = 16;
+
+    StringPool() = default;
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    Entry& EntryOf(Handle handle) const {
+        return m_segments[handle >> SEGMENT_BITS].load(std::memory_order_acquire)
+                   [handle & (SEGMENT_SIZE - 1)];
+    }
+
+    Shard& ShardOf(uint64_t hash) {
+        return m_shards[hash % SHARD_COUNT];
+    }
+
+    /**
+     * @brief Take an unused handle, allocating a segment if needed
+     */
+    Handle AllocateHandle();
+
+    /** Entry segments, allocated on demand */
+    std::array<std::atomic<Entry*>, MAX_SEGMENTS> m_segments{};
+
+    /** Lookup shards by string hash */
+    std::array<Shard, SHARD_COUNT> m_shards;
+
+    /** Mutex guarding handle allocation */
+    std::mutex m_allocationMutex;
+
+    /** Handles of freed strings */
+    std::vector<Handle> m_freeHandles;
+
+    /** Next never used handle */
+    uint64_t m_nextHandle = 0;
+
+    std::atomic<uint64_t> m_uniqueStrings{0};
+    std::atomic<uint64_t> m_uniqueBytes{0};
+    std::atomic<uint64_t> m_references{0};
+    std::atomic<uint64_t> m_referencedBytes{0};
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_STRING_POOL_H
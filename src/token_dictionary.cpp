@@ -0,0 +1,133 @@
+// token_dictionary.cpp
+#include "token_dictionary.h"
+#include "memory_budget.h"
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+namespace ai_framework {
+
+TokenDictionary& TokenDictionary::GetInstance() {
+    static TokenDictionary instance;
+    return instance;
+}
+
+TokenDictionary::~TokenDictionary() {
+    for (auto& segment : m_segments) {
+        delete[] segment.load(std::memory_order_relaxed);
+    }
+}
+
+TokenDictionary::Id TokenDictionary::Intern(std::string_view token) {
+    uint64_t hash = std::hash<std::string_view>{}(token);
+    Shard& shard = ShardOf(hash);
+
+    // Almost every token is already known; look under the shared lock first
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.ids.find(token);
+        if (it != shard.ids.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.ids.find(token);
+    if (it != shard.ids.end()) {
+        return it->second;
+    }
+
+    // The id is readable through GetToken before the lock publishes it
+    size_t textBytes = shard.textBytes;
+    size_t buckets = shard.ids.bucket_count();
+    std::string_view text = StoreText(shard, token);
+    Id id = AllocateId(text);
+    shard.ids.emplace(text, id);
+    Charge(shard.textBytes - textBytes + ENTRY_BYTES +
+           (shard.ids.bucket_count() - buckets) * sizeof(void*));
+    return id;
+}
+
+void TokenDictionary::Intern(const std::vector<std::string_view>& tokens, std::vector<Id>& ids) {
+    ids.clear();
+    ids.reserve(tokens.size());
+    for (std::string_view token : tokens) {
+        ids.push_back(Intern(token));
+    }
+}
+
+TokenDictionary::Id TokenDictionary::Find(std::string_view token) const {
+    const Shard& shard = ShardOf(std::hash<std::string_view>{}(token));
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.ids.find(token);
+    return it == shard.ids.end() ? NOT_FOUND : it->second;
+}
+
+size_t TokenDictionary::GetTokenCount() const {
+    return static_cast<size_t>(m_nextId.load(std::memory_order_relaxed));
+}
+
+size_t TokenDictionary::GetMemoryBytes() const {
+    size_t segments = (GetTokenCount() + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+    size_t bytes = segments * SEGMENT_SIZE * sizeof(std::string_view);
+    for (const auto& shard : m_shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        bytes += shard.textBytes +
+                 shard.ids.size() * ENTRY_BYTES +
+                 shard.ids.bucket_count() * sizeof(void*);
+    }
+    return bytes;
+}
+
+std::string_view TokenDictionary::StoreText(Shard& shard, std::string_view token) {
+    if (token.empty()) {
+        return std::string_view();
+    }
+    if (token.size() > CHUNK_BYTES) {
+        // Inserted before the current chunk, which keeps filling
+        auto chunk = shard.chunks.insert(shard.chunks.end() - (shard.chunks.empty() ? 0 : 1),
+                                         std::unique_ptr<char[]>(new char[token.size()]));
+        std::memcpy(chunk->get(), token.data(), token.size());
+        shard.textBytes += token.size();
+        return std::string_view(chunk->get(), token.size());
+    }
+
+    if (shard.chunkUsed + token.size() > CHUNK_BYTES) {
+        shard.chunks.emplace_back(new char[CHUNK_BYTES]);
+        shard.chunkUsed = 0;
+        shard.textBytes += CHUNK_BYTES;
+    }
+    char* text = shard.chunks.back().get() + shard.chunkUsed;
+    std::memcpy(text, token.data(), token.size());
+    shard.chunkUsed += token.size();
+    return std::string_view(text, token.size());
+}
+
+TokenDictionary::Id TokenDictionary::AllocateId(std::string_view token) {
+    std::lock_guard<std::mutex> lock(m_allocationMutex);
+    uint64_t id = m_nextId.load(std::memory_order_relaxed);
+    size_t segment = static_cast<size_t>(id >> SEGMENT_BITS);
+    if (id >= NOT_FOUND || segment >= MAX_SEGMENTS) {
+        throw std::length_error("Token dictionary is full");
+    }
+    std::string_view* entries = m_segments[segment].load(std::memory_order_relaxed);
+    if (entries == nullptr) {
+        entries = new std::string_view[SEGMENT_SIZE];
+        m_segments[segment].store(entries, std::memory_order_release);
+        Charge(SEGMENT_SIZE * sizeof(std::string_view));
+    }
+    entries[id & (SEGMENT_SIZE - 1)] = token;
+    m_nextId.store(id + 1, std::memory_order_relaxed);
+    return static_cast<Id>(id);
+}
+
+void TokenDictionary::Charge(size_t bytes) {
+    size_t pending = m_unchargedBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (pending >= CHARGE_BATCH) {
+        // Whoever empties the batch charges it; tokens are never freed
+        pending = m_unchargedBytes.exchange(0, std::memory_order_relaxed);
+        MemoryBudget::GetInstance().Charge(static_cast<int64_t>(pending));
+    }
+}
+
+} // namespace ai_framework
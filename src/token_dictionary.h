@@ -0,0 +1,179 @@
+// token_dictionary.h
+#ifndef AI_FRAMEWORK_TOKEN_DICTIONARY_H
+#define AI_FRAMEWORK_TOKEN_DICTIONARY_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief Process-wide dictionary of normalized tokens and dense 32-bit ids
+ *
+ * Every distinct token gets the next id, starting at 0, the first time it
+ * is interned, and keeps it for the life of the process; tokens are never
+ * removed, not even when the keys using them are evicted from a learning
+ * memory or removed from a FeatureIndex. Ids are not stable across
+ * processes, so anything persisted stores token text, not ids.
+ *
+ * The dictionary's growth is charged to the MemoryBudget in batches of
+ * CHARGE_BATCH bytes, so an open vocabulary leaves the learning memories
+ * less room instead of growing past the configured ceiling.
+ *
+ * Lookups read-lock one of several shards, so they run in parallel with
+ * each other and with interning in other shards. GetToken takes no lock.
+ */
+class TokenDictionary {
+public:
+    /** Id of a token */
+    using Id = uint32_t;
+
+    /** Returned by Find for a token never interned */
+    static constexpr Id NOT_FOUND = UINT32_MAX;
+
+    /** Growth charged to the MemoryBudget at once */
+    static constexpr size_t CHARGE_BATCH = 16 * 1024;
+
+    /**
+     * @brief Get the singleton instance of TokenDictionary
+     *
+     * @return TokenDictionary& Reference to the TokenDictionary instance
+     */
+    static TokenDictionary& GetInstance();
+
+    /**
+     * @brief Destructor; frees every token
+     */
+    ~TokenDictionary();
+
+    /**
+     * @brief Get the id of a token, adding the token if needed
+     *
+     * @param token Normalized token
+     * @return Id Id of the token
+     * @throws std::length_error If every id is taken
+     */
+    Id Intern(std::string_view token);
+
+    /**
+     * @brief Get the ids of several tokens, adding tokens as needed
+     *
+     * @param tokens Normalized tokens
+     * @param ids Receives one id per token, in order
+     */
+    void Intern(const std::vector<std::string_view>& tokens, std::vector<Id>& ids);
+
+    /**
+     * @brief Get the id of a token without adding it
+     *
+     * @param token Normalized token
+     * @return Id Id of the token, NOT_FOUND if it was never interned
+     */
+    Id Find(std::string_view token) const;
+
+    /**
+     * @brief Get the text of a token
+     *
+     * @param id Id returned by Intern or Find
+     * @return std::string_view The token, valid for the life of the process
+     */
+    std::string_view GetToken(Id id) const {
+        return m_segments[id >> SEGMENT_BITS].load(std::memory_order_acquire)[id & (SEGMENT_SIZE - 1)];
+    }
+
+    /**
+     * @brief Get the number of tokens
+     *
+     * @return size_t Number of ids handed out
+     */
+    size_t GetTokenCount() const;
+
+    /**
+     * @brief Get the bytes used by the tokens and lookup tables
+     *
+     * @return size_t Approximate resident bytes
+     */
+    size_t GetMemoryBytes() const;
+
+private:
+    /**
+     * @brief Lookup table of one shard, with the text of its tokens
+     */
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string_view, Id> ids;
+
+        /** Token text, in chunks that never move */
+        std::vector<std::unique_ptr<char[]>> chunks;
+        size_t chunkUsed = CHUNK_BYTES;
+        size_t textBytes = 0;
+    };
+
+    /** Ids per segment; segments never move once allocated */
+    static constexpr unsigned SEGMENT_BITS = 16;
+    static constexpr size_t SEGMENT_SIZE = size_t(1) << SEGMENT_BITS;
+    static constexpr size_t MAX_SEGMENTS = size_t(1) << (32 - SEGMENT_BITS);
+    static constexpr size_t SHARD_COUNT = 16;
+
+    /** Bytes of a text chunk; longer tokens get a chunk of their own */
+    static constexpr size_t CHUNK_BYTES = 64 * 1024;
+
+    /** Bytes of one lookup table entry */
+    static constexpr size_t ENTRY_BYTES = sizeof(std::string_view) + sizeof(Id) + 2 * sizeof(void*);
+
+    TokenDictionary() = default;
+    TokenDictionary(const TokenDictionary&) = delete;
+    TokenDictionary& operator=(const TokenDictionary&) = delete;
+
+    Shard& ShardOf(uint64_t hash) {
+        return m_shards[hash % SHARD_COUNT];
+    }
+
+    const Shard& ShardOf(uint64_t hash) const {
+        return m_shards[hash % SHARD_COUNT];
+    }
+
+    /**
+     * @brief Copy a token into a shard's chunks
+     *
+     * Needs the shard's exclusive lock.
+     */
+    static std::string_view StoreText(Shard& shard, std::string_view token);
+
+    /**
+     * @brief Take the next id, allocating its segment if needed
+     */
+    Id AllocateId(std::string_view token);
+
+    /**
+     * @brief Charge grown bytes to the MemoryBudget once a batch is due
+     */
+    void Charge(size_t bytes);
+
+    /** Token of each id, allocated on demand */
+    std::array<std::atomic<std::string_view*>, MAX_SEGMENTS> m_segments{};
+
+    /** Lookup shards by token hash */
+    std::array<Shard, SHARD_COUNT> m_shards;
+
+    /** Mutex guarding id allocation */
+    std::mutex m_allocationMutex;
+
+    /** Next id */
+    std::atomic<uint64_t> m_nextId{0};
+
+    /** Bytes grown but not yet charged to the MemoryBudget */
+    std::atomic<size_t> m_unchargedBytes{0};
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_TOKEN_DICTIONARY_H
@@ -0,0 +1,115 @@
+// tokenizer.cpp
+#include "tokenizer.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define AI_FRAMEWORK_TOKENIZER_SSE2 1
+#endif
+
+namespace ai_framework {
+
+namespace {
+
+/**
+ * @brief ASCII punctuation, as std::ispunct in the "C" locale
+ */
+inline bool IsPunct(unsigned char c) {
+    return (c >= 0x21 && c <= 0x2F) || (c >= 0x3A && c <= 0x40) ||
+           (c >= 0x5B && c <= 0x60) || (c >= 0x7B && c <= 0x7E);
+}
+
+#ifdef AI_FRAMEWORK_TOKENIZER_SSE2
+/**
+ * @brief Lanes strictly between two byte values; bytes >= 0x80 compare negative
+ */
+inline __m128i Between(__m128i bytes, char low, char high) {
+    return _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(low)),
+                         _mm_cmplt_epi8(bytes, _mm_set1_epi8(high)));
+}
+#endif
+
+} // namespace
+
+Tokenizer& Tokenizer::Local() {
+    thread_local Tokenizer tokenizer;
+    return tokenizer;
+}
+
+const std::vector<std::string_view>& Tokenizer::Tokenize(std::string_view message) {
+    m_tokens.clear();
+    if (m_buffer.size() < message.size()) {
+        m_buffer.resize(message.size());
+    }
+
+    const char* data = message.data();
+    size_t size = message.size();
+    size_t pos = 0;
+    size_t out = 0;
+    size_t tokenStart = 0;
+
+#ifdef AI_FRAMEWORK_TOKENIZER_SSE2
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+
+        __m128i punct = _mm_or_si128(
+            _mm_or_si128(Between(bytes, 0x20, 0x30), Between(bytes, 0x39, 0x41)),
+            _mm_or_si128(Between(bytes, 0x5A, 0x61), Between(bytes, 0x7A, 0x7F)));
+        if (_mm_movemask_epi8(punct) != 0) {
+            // Punctuation shifts the output; this block goes byte by byte
+            TokenizeScalar(data + pos, 16, out, tokenStart);
+            continue;
+        }
+
+        // Lowercase A-Z by adding 0x20 to those lanes, then store in place
+        __m128i upper = Between(bytes, 0x40, 0x5B);
+        __m128i lowered = _mm_add_epi8(bytes, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&m_buffer[out]), lowered);
+
+        // Output lines up with input here, so space bits are token ends
+        unsigned spaces = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '))));
+        while (spaces != 0) {
+            size_t end = out + static_cast<size_t>(__builtin_ctz(spaces));
+            EmitToken(tokenStart, end);
+            tokenStart = end + 1;
+            spaces &= spaces - 1;
+        }
+        out += 16;
+    }
+#endif
+
+    TokenizeScalar(data + pos, size - pos, out, tokenStart);
+    EmitToken(tokenStart, out);
+    return m_tokens;
+}
+
+const std::vector<TokenDictionary::Id>& Tokenizer::TokenizeIds(std::string_view message, bool intern) {
+    TokenDictionary& dictionary = TokenDictionary::GetInstance();
+    Tokenize(message);
+    if (intern) {
+        dictionary.Intern(m_tokens, m_ids);
+        return m_ids;
+    }
+
+    m_ids.clear();
+    for (std::string_view token : m_tokens) {
+        m_ids.push_back(dictionary.Find(token));
+    }
+    return m_ids;
+}
+
+void Tokenizer::TokenizeScalar(const char* data, size_t size, size_t& out, size_t& tokenStart) {
+    for (size_t i = 0; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c == ' ') {
+            EmitToken(tokenStart, out);
+            m_buffer[out++] = ' ';
+            tokenStart = out;
+        }
+        else if (!IsPunct(c)) {
+            m_buffer[out++] = static_cast<char>(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+        }
+    }
+}
+
+} // namespace ai_framework
@@ -0,0 +1,83 @@
+// tokenizer.h
+#ifndef AI_FRAMEWORK_TOKENIZER_H
+#define AI_FRAMEWORK_TOKENIZER_H
+
+#include "token_dictionary.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief Splits messages into normalized features
+ *
+ * A message is lowercased, stripped of ASCII punctuation and split on
+ * spaces in a single pass, 16 bytes at a time where SSE2 is available.
+ * Tokens are views into a buffer owned by the tokenizer, which is reused
+ * from one message to the next, so tokenizing allocates nothing once the
+ * buffers have grown to the message size.
+ */
+class Tokenizer {
+public:
+    /**
+     * @brief Tokenize a message
+     *
+     * @param message The message to tokenize
+     * @return const std::vector<std::string_view>& Tokens, valid until the
+     *         next call on this tokenizer
+     */
+    const std::vector<std::string_view>& Tokenize(std::string_view message);
+
+    /**
+     * @brief Tokenize a message into TokenDictionary ids
+     *
+     * @param message The message to tokenize
+     * @param intern True to add unknown tokens to the dictionary; otherwise
+     *               they map to TokenDictionary::NOT_FOUND, which suits
+     *               queries that should not grow the dictionary
+     * @return const std::vector<TokenDictionary::Id>& One id per token,
+     *         valid until the next call on this tokenizer
+     */
+    const std::vector<TokenDictionary::Id>& TokenizeIds(std::string_view message, bool intern = true);
+
+    /**
+     * @brief Get the tokenizer of the calling thread
+     *
+     * @return Tokenizer& Thread-local instance
+     */
+    static Tokenizer& Local();
+
+private:
+    /**
+     * @brief Normalize and split bytes one at a time
+     *
+     * @param data First byte
+     * @param size Number of bytes
+     * @param out Write position in m_buffer, advanced past the output
+     * @param tokenStart Start of the current token in m_buffer
+     */
+    void TokenizeScalar(const char* data, size_t size, size_t& out, size_t& tokenStart);
+
+    /**
+     * @brief Record the token ending at a separator
+     */
+    void EmitToken(size_t tokenStart, size_t end) {
+        if (end > tokenStart) {
+            m_tokens.emplace_back(m_buffer.data() + tokenStart, end - tokenStart);
+        }
+    }
+
+    /** Normalized message, spaces kept as separators */
+    std::string m_buffer;
+
+    /** Token views into m_buffer */
+    std::vector<std::string_view> m_tokens;
+
+    /** Ids of m_tokens, for TokenizeIds */
+    std::vector<TokenDictionary::Id> m_ids;
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_TOKENIZER_H
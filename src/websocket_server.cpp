@@ -15,7 +15,8 @@ WebSocketServer::WebSocketServer(
     : m_port(port), 
       m_certPath(cert_path), 
       m_keyPath(key_path), 
-      m_running(false) {
+      m_running(false),
+      m_loop(nullptr) {
 }
 
 WebSocketServer::~WebSocketServer() {
@@ -95,6 +96,9 @@ void WebSocketServer::Broadcast(const std::string& message) {
 }
 
 void WebSocketServer::ServerLoop() {
+    // Responses computed on other threads are written from this loop
+    m_loop.store(uWS::Loop::get());
+    
     if (!m_certPath.empty() && !m_keyPath.empty()) {
         // Use SSL
         m_sslApp = std::make_unique<uWS::TemplatedApp<true>>(uWS::SSLApp({
@@ -138,8 +142,8 @@ void WebSocketServer::ServerLoop() {
                     this->m_messageHandler(
                         client_id, 
                         std::string(message), 
-                        [ws](const std::string& response) {
-                            ws->send(response, uWS::OpCode::TEXT);
+                        [this, client_id](const std::string& response) {
+                            this->PostToClient(client_id, response);
                         });
                 }
             },
@@ -220,8 +224,8 @@ void WebSocketServer::ServerLoop() {
                     this->m_messageHandler(
                         client_id, 
                         std::string(message), 
-                        [ws](const std::string& response) {
-                            ws->send(response, uWS::OpCode::TEXT);
+                        [this, client_id](const std::string& response) {
+                            this->PostToClient(client_id, response);
                         });
                 }
             },
@@ -262,6 +266,33 @@ void WebSocketServer::ServerLoop() {
         // Run the event loop
         m_app->run();
     }
+    
+    m_loop.store(nullptr);
+}
+
+void WebSocketServer::PostToClient(const std::string& client_id, std::string message) {
+    uWS::Loop* loop = m_loop.load();
+    if (!loop) {
+        return;
+    }
+    
+    // uWebSockets is single-threaded; only the loop's thread may write
+    loop->defer([this, client_id, message = std::move(message)]() {
+        std::lock_guard<std::mutex> lock(m_clientsMutex);
+        
+        auto it = m_clients.find(client_id);
+        if (it == m_clients.end()) {
+            // Disconnected while the agent was working
+            return;
+        }
+        
+        if (m_sslApp) {
+            static_cast<uWS::WebSocket<true>*>(it->second)->send(message, uWS::OpCode::TEXT);
+        }
+        else {
+            static_cast<uWS::WebSocket<false>*>(it->second)->send(message, uWS::OpCode::TEXT);
+        }
+    });
 }
 
 std::string WebSocketServer::GenerateClientId() const {
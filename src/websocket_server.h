@@ -2,6 +2,7 @@
 #ifndef AI_FRAMEWORK_WEBSOCKET_SERVER_H
 #define AI_FRAMEWORK_WEBSOCKET_SERVER_H
 
+#include <atomic>
 #include <string>
 #include <functional>
 #include <memory>
@@ -14,6 +15,10 @@ namespace ai_framework {
 
 /**
  * @brief Callback type for websocket message handlers
+ * 
+ * The handler gets the client ID, the message and a function sending a
+ * response to the client. That function may be called later and from any
+ * thread, so the handler can return before the answer is ready.
  */
 using WebSocketMessageHandler = std::function<
     void(const std::string&, const std::string&, std::function<void(const std::string&)>)>;
@@ -112,6 +117,20 @@ private:
     /** uWebSockets SSL app instance */
     std::unique_ptr<uWS::TemplatedApp<true>> m_sslApp;
     
+    /** Event loop of the server thread, null while it is not running */
+    std::atomic<uWS::Loop*> m_loop;
+    
+    /**
+     * @brief Send a message to a client from any thread
+     * 
+     * The write is deferred to the server thread; it is dropped if the
+     * client has disconnected by then.
+     * 
+     * @param client_id ID of the client to send to
+     * @param message Message to send
+     */
+    void PostToClient(const std::string& client_id, std::string message);
+    
     /**
      * @brief Server loop function
      */
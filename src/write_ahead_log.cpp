@@ -0,0 +1,245 @@
+// write_ahead_log.cpp
+#include "write_ahead_log.h"
+#include "logging_service.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace ai_framework {
+
+namespace {
+
+/** Record header: payload length and CRC-32 of the payload */
+constexpr size_t RECORD_HEADER_SIZE = 2 * sizeof(uint32_t);
+
+void PutUint32(std::string& buffer, uint32_t value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+uint32_t GetUint32(const char* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint32_t Checksum(const char* data, size_t size) {
+    return static_cast<uint32_t>(
+        crc32(0L, reinterpret_cast<const Bytef*>(data), static_cast<uInt>(size)));
+}
+
+} // namespace
+
+WriteAheadLog::WriteAheadLog(std::string basePath)
+    : m_basePath(std::move(basePath)), m_fd(-1), m_generation(0) {
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    Flush();
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+uint64_t WriteAheadLog::Replay(
+    uint64_t afterGeneration,
+    const std::function<void(std::string_view, std::string_view)>& apply) const {
+
+    uint64_t applied = 0;
+    for (const auto& segment : ListSegments()) {
+        if (segment.first <= afterGeneration) {
+            continue;
+        }
+
+        auto file = MappedFile::Open(segment.second);
+        if (!file) {
+            // Empty or unreadable segment
+            continue;
+        }
+
+        const char* data = file->GetData();
+        size_t size = file->GetSize();
+        size_t pos = 0;
+        while (size - pos >= RECORD_HEADER_SIZE) {
+            uint32_t length = GetUint32(data + pos);
+            uint32_t checksum = GetUint32(data + pos + sizeof(uint32_t));
+            const char* payload = data + pos + RECORD_HEADER_SIZE;
+            if (length < sizeof(uint32_t) || length > size - pos - RECORD_HEADER_SIZE ||
+                Checksum(payload, length) != checksum) {
+                break;
+            }
+
+            uint32_t keyLength = GetUint32(payload);
+            if (keyLength > length - sizeof(uint32_t)) {
+                break;
+            }
+            std::string_view key(payload + sizeof(uint32_t), keyLength);
+            std::string_view response(payload + sizeof(uint32_t) + keyLength,
+                                      length - sizeof(uint32_t) - keyLength);
+            apply(key, response);
+            ++applied;
+            pos += RECORD_HEADER_SIZE + length;
+        }
+
+        if (pos != size) {
+            LoggingService::GetInstance().Log(
+                LogLevel::WARNING,
+                "Write-ahead log segment " + segment.second + " ends with " +
+                std::to_string(size - pos) + " bytes of a torn record");
+        }
+    }
+    return applied;
+}
+
+bool WriteAheadLog::Open(uint64_t minGeneration) {
+    uint64_t generation = minGeneration;
+    for (const auto& segment : ListSegments()) {
+        generation = std::max(generation, segment.first);
+    }
+    return OpenSegment(generation + 1);
+}
+
+bool WriteAheadLog::OpenSegment(uint64_t generation) {
+    int fd = ::open(SegmentPath(generation).c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        LoggingService::GetInstance().Log(
+            LogLevel::ERROR,
+            "Failed to open write-ahead log " + SegmentPath(generation) + ": " +
+            std::strerror(errno));
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    if (m_fd >= 0) {
+        m_closing.emplace_back(m_fd, std::move(m_buffer));
+        m_buffer.clear();
+    }
+    m_fd = fd;
+    m_generation = generation;
+    return true;
+}
+
+void WriteAheadLog::Append(std::string_view key, std::string_view response) {
+    uint32_t length = static_cast<uint32_t>(sizeof(uint32_t) + key.size() + response.size());
+
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    size_t start = m_buffer.size();
+    PutUint32(m_buffer, length);
+    PutUint32(m_buffer, 0);
+    PutUint32(m_buffer, static_cast<uint32_t>(key.size()));
+    m_buffer.append(key.data(), key.size());
+    m_buffer.append(response.data(), response.size());
+
+    // Fill in the checksum now that the payload is in place
+    uint32_t checksum = Checksum(m_buffer.data() + start + RECORD_HEADER_SIZE, length);
+    std::memcpy(&m_buffer[start + sizeof(uint32_t)], &checksum, sizeof(checksum));
+}
+
+bool WriteAheadLog::Flush() {
+    std::lock_guard<std::mutex> flushLock(m_flushMutex);
+
+    std::string buffer;
+    std::vector<std::pair<int, std::string>> closing;
+    int fd;
+    {
+        std::lock_guard<std::mutex> lock(m_bufferMutex);
+        buffer.swap(m_buffer);
+        closing.swap(m_closing);
+        fd = m_fd;
+    }
+
+    bool success = true;
+
+    // Finish the segments Rotate closed; they hold older records
+    for (auto& segment : closing) {
+        success = WriteAll(segment.first, segment.second) && success;
+        success = ::fdatasync(segment.first) == 0 && success;
+        ::close(segment.first);
+    }
+
+    if (fd >= 0 && !buffer.empty()) {
+        success = WriteAll(fd, buffer) && success;
+        success = ::fdatasync(fd) == 0 && success;
+    }
+
+    if (!success) {
+        LoggingService::GetInstance().Log(
+            LogLevel::ERROR,
+            "Failed to flush write-ahead log " + m_basePath + ": " + std::strerror(errno));
+    }
+    return success;
+}
+
+bool WriteAheadLog::Rotate(uint64_t& closed) {
+    uint64_t current = GetGeneration();
+    if (!OpenSegment(current + 1)) {
+        return false;
+    }
+    closed = current;
+    return true;
+}
+
+void WriteAheadLog::RemoveSegmentsUpTo(uint64_t generation) {
+    for (const auto& segment : ListSegments()) {
+        if (segment.first <= generation) {
+            std::error_code error;
+            std::filesystem::remove(segment.second, error);
+        }
+    }
+}
+
+uint64_t WriteAheadLog::GetGeneration() const {
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    return m_generation;
+}
+
+std::vector<std::pair<uint64_t, std::string>> WriteAheadLog::ListSegments() const {
+    std::vector<std::pair<uint64_t, std::string>> segments;
+
+    std::filesystem::path base(m_basePath);
+    std::filesystem::path directory = base.has_parent_path() ? base.parent_path() : ".";
+    std::string prefix = base.filename().string() + ".";
+
+    std::error_code error;
+    for (const auto& item : std::filesystem::directory_iterator(directory, error)) {
+        std::string name = item.path().filename().string();
+        if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        std::string suffix = name.substr(prefix.size());
+        if (suffix.size() > 19 ||
+            !std::all_of(suffix.begin(), suffix.end(),
+                         [](char c) { return c >= '0' && c <= '9'; })) {
+            continue;
+        }
+        segments.emplace_back(std::stoull(suffix), item.path().string());
+    }
+
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+std::string WriteAheadLog::SegmentPath(uint64_t generation) const {
+    return m_basePath + "." + std::to_string(generation);
+}
+
+bool WriteAheadLog::WriteAll(int fd, const std::string& buffer) {
+    size_t written = 0;
+    while (written < buffer.size()) {
+        ssize_t result = ::write(fd, buffer.data() + written, buffer.size() - written);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        written += static_cast<size_t>(result);
+    }
+    return true;
+}
+
+} // namespace ai_framework
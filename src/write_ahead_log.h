@@ -0,0 +1,146 @@
+// write_ahead_log.h
+#ifndef AI_FRAMEWORK_WRITE_AHEAD_LOG_H
+#define AI_FRAMEWORK_WRITE_AHEAD_LOG_H
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ai_framework {
+
+/**
+ * @brief Append-only log of learned (key, response) pairs
+ *
+ * Records are buffered by Append and written with one write and one
+ * fdatasync per Flush, so a background thread flushing every few
+ * milliseconds commits all records of that window as a group. The log is
+ * split into numbered segments "<base>.<generation>"; Rotate starts a new
+ * segment so older ones can be deleted once a checkpoint covers them.
+ * Each record carries a CRC-32, and replay stops at the first torn or
+ * corrupt record.
+ */
+class WriteAheadLog {
+public:
+    /**
+     * @brief Constructor for WriteAheadLog
+     *
+     * @param basePath Path prefix of the segment files
+     */
+    explicit WriteAheadLog(std::string basePath);
+
+    /**
+     * @brief Destructor; flushes and closes the current segment
+     */
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    /**
+     * @brief Apply the records of every segment after a generation
+     *
+     * Call before Open.
+     *
+     * @param afterGeneration Segments up to this generation are skipped
+     * @param apply Called with the key and response of each record, in order
+     * @return uint64_t Number of records applied
+     */
+    uint64_t Replay(uint64_t afterGeneration,
+                    const std::function<void(std::string_view, std::string_view)>& apply) const;
+
+    /**
+     * @brief Start a new segment after every existing one
+     *
+     * @param minGeneration The new generation is greater than this one
+     * @return bool True if the segment was created
+     */
+    bool Open(uint64_t minGeneration = 0);
+
+    /**
+     * @brief Buffer a record; it becomes durable with the next Flush
+     *
+     * @param key Memory key
+     * @param response Learned response
+     */
+    void Append(std::string_view key, std::string_view response);
+
+    /**
+     * @brief Write and sync every buffered record
+     *
+     * @return bool True if all records reached the disk
+     */
+    bool Flush();
+
+    /**
+     * @brief Direct further records to a new segment
+     *
+     * Only swaps buffers and opens a file; it never waits for a sync.
+     *
+     * @param closed Receives the generation of the segment that was closed;
+     *        every record appended so far belongs to it or an earlier one
+     * @return bool True if the new segment was opened; on failure records
+     *         keep going to the current segment and closed is not set
+     */
+    bool Rotate(uint64_t& closed);
+
+    /**
+     * @brief Delete the segments up to a generation
+     *
+     * @param generation Last generation to delete
+     */
+    void RemoveSegmentsUpTo(uint64_t generation);
+
+    /**
+     * @brief Get the generation of the current segment
+     *
+     * @return uint64_t Current generation, 0 before Open
+     */
+    uint64_t GetGeneration() const;
+
+private:
+    /**
+     * @brief Existing segments as (generation, path), oldest first
+     */
+    std::vector<std::pair<uint64_t, std::string>> ListSegments() const;
+
+    std::string SegmentPath(uint64_t generation) const;
+
+    /**
+     * @brief Make a new segment current; the previous one is closed by the next Flush
+     */
+    bool OpenSegment(uint64_t generation);
+
+    /**
+     * @brief Write a whole buffer to a file descriptor
+     */
+    static bool WriteAll(int fd, const std::string& buffer);
+
+    /** Path prefix of the segments */
+    std::string m_basePath;
+
+    /** Mutex guarding the buffer and current segment (held only briefly) */
+    mutable std::mutex m_bufferMutex;
+
+    /** Records not yet written */
+    std::string m_buffer;
+
+    /** Descriptor of the current segment, -1 before Open */
+    int m_fd;
+
+    /** Generation of the current segment */
+    uint64_t m_generation;
+
+    /** Segments closed by Rotate with their unwritten records */
+    std::vector<std::pair<int, std::string>> m_closing;
+
+    /** Mutex serializing Flush calls */
+    std::mutex m_flushMutex;
+};
+
+} // namespace ai_framework
+
+#endif // AI_FRAMEWORK_WRITE_AHEAD_LOG_H
@@ -2,6 +2,13 @@
 #include "catch2/catch.hpp"
 #include "../src/agent_manager.h"
 #include <so_5/all.hpp>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <cstdio>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
 
 TEST_CASE("AgentManager Functionality", "[agent_manager]") {
     // Create SObjectizer environment
@@ -101,4 +108,226 @@ TEST_CASE("AgentManager Functionality", "[agent_manager]") {
         
         REQUIRE_THROWS_AS(manager.SendMessage(agentId, message), std::runtime_error);
     }
-}
\ No newline at end of file
+    
+    SECTION("Send messages asynchronously through the agent's mbox") {
+        REQUIRE(manager.Initialize("{}") == true);
+        
+        const std::string agentId = "test-async-agent";
+        const std::string config = "{\"rules\": [{\"pattern\": \".*hello.*\", \"response\": \"Hi there!\", \"priority\": 10}]}";
+        REQUIRE(manager.CreateAgent("rule_based", agentId, config) == true);
+        
+        std::future<std::string> future = manager.SendMessageAsync(agentId, "hello world");
+        REQUIRE(future.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+        REQUIRE(future.get() == "Hi there!");
+        
+        // Every callback runs once, whichever thread posted the message
+        std::atomic<int> answered(0);
+        std::atomic<int> failures(0);
+        std::promise<void> done;
+        std::vector<std::thread> senders;
+        for (int t = 0; t < 4; ++t) {
+            senders.emplace_back([&]() {
+                for (int i = 0; i < 250; ++i) {
+                    manager.SendMessageAsync(agentId, "hello", [&](bool success, const std::string& content) {
+                        if (!success || content != "Hi there!") {
+                            ++failures;
+                        }
+                        if (++answered == 1000) {
+                            done.set_value();
+                        }
+                    });
+                }
+            });
+        }
+        for (auto& sender : senders) {
+            sender.join();
+        }
+        REQUIRE(done.get_future().wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        REQUIRE(failures.load() == 0);
+        
+        // A request in flight keeps its agent until it has answered
+        future = manager.SendMessageAsync(agentId, "hello again");
+        REQUIRE(manager.DestroyAgent(agentId) == true);
+        REQUIRE(future.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+        REQUIRE(future.get() == "Hi there!");
+        
+        REQUIRE_THROWS_AS(manager.SendMessageAsync(agentId, "hello"), std::runtime_error);
+    }
+    
+    SECTION("Run agents on configured dispatchers") {
+        const std::string config = R"({"dispatchers": {
+            "test-learners": {"type": "thread_pool", "threads": 2, "agent_types": ["learning"]},
+            "test-isolated": {"type": "active_obj"}
+        }})";
+        REQUIRE(manager.Initialize(config) == true);
+        
+        REQUIRE(manager.CreateAgent("learning", "test-pool-agent", "{}") == true);
+        const std::string rules = "{\"dispatcher\": \"test-isolated\", \"rules\": [{\"pattern\": \".*hello.*\", \"response\": \"Hi there!\"}]}";
+        REQUIRE(manager.CreateAgent("rule_based", "test-isolated-agent", rules) == true);
+        REQUIRE(manager.CreateAgent("rule_based", "test-unbound-agent", "{\"dispatcher\": \"missing\"}") == false);
+        
+        std::vector<std::future<std::string>> futures;
+        for (int i = 0; i < 50; ++i) {
+            futures.push_back(manager.SendMessageAsync("test-pool-agent", "hello " + std::to_string(i)));
+            futures.push_back(manager.SendMessageAsync("test-isolated-agent", "hello"));
+        }
+        for (size_t i = 0; i < futures.size(); ++i) {
+            REQUIRE(futures[i].wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+            std::string response = futures[i].get();
+            if (i % 2 == 1) {
+                REQUIRE(response == "Hi there!");
+            }
+        }
+        
+        nlohmann::json stats = nlohmann::json::parse(manager.GetDispatcherStats());
+        REQUIRE(stats["test-learners"]["type"] == "thread_pool");
+        REQUIRE(stats["test-learners"]["threads"] == 2);
+        REQUIRE(stats["test-learners"]["agents"] == 1);
+        REQUIRE(stats["test-learners"]["delivered"] == 50);
+        REQUIRE(stats["test-learners"]["queue_depth"] == 0);
+        REQUIRE(stats["test-isolated"]["agents"] == 1);
+        REQUIRE(stats["test-isolated"]["delivered"] == 50);
+        REQUIRE(stats["default"]["agents"] == 0);
+        
+        // Clean up
+        REQUIRE(manager.DestroyAgent("test-pool-agent") == true);
+        REQUIRE(manager.DestroyAgent("test-isolated-agent") == true);
+        stats = nlohmann::json::parse(manager.GetDispatcherStats());
+        REQUIRE(stats["test-learners"]["agents"] == 0);
+    }
+    
+    SECTION("Reload rules of an agent") {
+        // Initialize manager
+        REQUIRE(manager.Initialize("{}") == true);
+        
+        const std::string agentId = "test-reload-agent";
+        const std::string config = "{\"rules\": [{\"pattern\": \".*hello.*\", \"response\": \"Hi there!\", \"priority\": 10}]}";
+        REQUIRE(manager.CreateAgent("rule_based", agentId, config) == true);
+        
+        const std::string rules = "{\"rules\": [{\"pattern\": \".*hello.*\", \"response\": \"Hello again!\"}]}";
+        REQUIRE(manager.ReloadAgentRules(agentId, rules) == true);
+        REQUIRE(manager.SendMessage(agentId, "hello world") == "Hello again!");
+        
+        // Only rule-based agents have rules to reload
+        REQUIRE(manager.CreateAgent("learning", "test-reload-learning", "{}") == true);
+        REQUIRE(manager.ReloadAgentRules("test-reload-learning", rules) == false);
+        REQUIRE_THROWS_AS(manager.ReloadAgentRules("non-existent-agent", rules), std::runtime_error);
+        
+        // Only learning agents ingest training pairs
+        std::vector<std::pair<std::string, std::string>> pairs = {{"good morning", "Morning!"}};
+        REQUIRE(manager.IngestAgentMemory("test-reload-learning", pairs) == 1);
+        REQUIRE(manager.SendMessage("test-reload-learning", "good morning") == "Morning!");
+        REQUIRE_THROWS_AS(manager.IngestAgentMemory(agentId, pairs), std::runtime_error);
+        
+        // Ingested off the caller's thread, in the order posted
+        std::promise<size_t> first;
+        std::promise<size_t> second;
+        manager.IngestAgentMemoryAsync("test-reload-learning", {{"good night", "Sleep well!"}},
+            [&first](bool success, size_t ingested, const std::string&) {
+                first.set_value(success ? ingested : 0);
+            });
+        manager.IngestAgentMemoryAsync("test-reload-learning", {{"good night", "Night!"}, {"", "nothing"}},
+            [&second](bool success, size_t ingested, const std::string&) {
+                second.set_value(success ? ingested : 0);
+            });
+        auto secondIngested = second.get_future();
+        REQUIRE(secondIngested.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        REQUIRE(first.get_future().wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+        REQUIRE(secondIngested.get() == 1);
+        std::string night = manager.SendMessage("test-reload-learning", "good night");
+        REQUIRE((night == "Sleep well!" || night == "Night!"));
+        REQUIRE_THROWS_AS(manager.IngestAgentMemoryAsync(agentId, pairs, nullptr), std::runtime_error);
+        
+        // Rules are compiled off the caller's thread too
+        std::promise<bool> reloaded;
+        std::promise<bool> notRuleBased;
+        manager.ReloadAgentRulesAsync(agentId,
+            "{\"rules\": [{\"pattern\": \".*hello.*\", \"response\": \"Hello once more!\"}]}",
+            [&reloaded](bool success) { reloaded.set_value(success); });
+        manager.ReloadAgentRulesAsync("test-reload-learning", rules,
+            [&notRuleBased](bool success) { notRuleBased.set_value(success); });
+        auto notRuleBasedResult = notRuleBased.get_future();
+        REQUIRE(notRuleBasedResult.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        REQUIRE(notRuleBasedResult.get() == false);
+        REQUIRE(reloaded.get_future().get() == true);
+        REQUIRE(manager.SendMessage(agentId, "hello world") == "Hello once more!");
+        REQUIRE_THROWS_AS(manager.ReloadAgentRulesAsync("non-existent-agent", rules, nullptr), std::runtime_error);
+        
+        // Clean up
+        REQUIRE(manager.DestroyAgent(agentId) == true);
+        REQUIRE(manager.DestroyAgent("test-reload-learning") == true);
+    }
+    
+    SECTION("Route messages while agents are created and destroyed") {
+        REQUIRE(manager.Initialize("{}") == true);
+        
+        const std::string config = "{\"rules\": [{\"pattern\": \".*ping.*\", \"response\": \"pong\"}]}";
+        REQUIRE(manager.CreateAgent("rule_based", "stable-agent", config) == true);
+        
+        std::atomic<bool> stop(false);
+        std::atomic<int> failures(0);
+        std::vector<std::thread> senders;
+        for (int t = 0; t < 4; ++t) {
+            senders.emplace_back([&]() {
+                while (!stop.load()) {
+                    if (manager.SendMessage("stable-agent", "ping") != "pong") {
+                        ++failures;
+                    }
+                }
+            });
+        }
+        
+        // Two writers race on the same IDs; exactly one create and one
+        // destroy of each round may succeed
+        std::atomic<int> created(0);
+        std::atomic<int> destroyed(0);
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 2; ++t) {
+            writers.emplace_back([&]() {
+                for (int i = 0; i < 200; ++i) {
+                    const std::string id = "churn-agent-" + std::to_string(i);
+                    created += manager.CreateAgent("rule_based", id, config);
+                    destroyed += manager.DestroyAgent(id);
+                }
+            });
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+        stop.store(true);
+        for (auto& sender : senders) {
+            sender.join();
+        }
+        
+        REQUIRE(failures.load() == 0);
+        REQUIRE(created.load() >= 200);
+        REQUIRE(created.load() == destroyed.load());
+        REQUIRE(manager.GetAllAgentIds() == std::vector<std::string>{"stable-agent"});
+        
+        // Clean up
+        REQUIRE(manager.DestroyAgent("stable-agent") == true);
+    }
+    
+    SECTION("Build one learning agent when callers race on its ID") {
+        REQUIRE(manager.Initialize("{}") == true);
+        
+        const std::string config = "{\"initial_memory\": {\"hello\": [\"Hi!\"]}}";
+        std::atomic<int> created(0);
+        std::vector<std::thread> creators;
+        for (int t = 0; t < 4; ++t) {
+            creators.emplace_back([&]() {
+                created += manager.CreateAgent("learning", "race-learning-agent", config);
+            });
+        }
+        for (auto& creator : creators) {
+            creator.join();
+        }
+        
+        REQUIRE(created.load() == 1);
+        REQUIRE(manager.SendMessage("race-learning-agent", "hello") == "Hi!");
+        
+        // Clean up
+        REQUIRE(manager.DestroyAgent("race-learning-agent") == true);
+        std::remove("memory_race-learning-agent.bin");
+    }
+}
@@ -3,6 +3,9 @@
 #include "../src/agent.h"
 #include "../src/messages.h"
 #include <so_5/all.hpp>
+#include <chrono>
+#include <future>
+#include <stdexcept>
 
 // Mock agent implementation for testing
 class MockAgent : public ai_framework::Agent {
@@ -62,6 +65,40 @@ private:
     std::string m_processMessageResponse;
 };
 
+// Agent relying on the base class to answer its messages
+class EchoAgent : public ai_framework::Agent {
+public:
+    EchoAgent(so_5::environment_t& env, std::string id)
+        : Agent(env, std::move(id)) {}
+    
+    virtual bool Initialize(const std::string& /*config*/) override {
+        return true;
+    }
+    
+    virtual std::string ProcessMessage(const std::string& message) override {
+        if (message.empty()) {
+            throw std::runtime_error("empty message");
+        }
+        return "echo: " + message;
+    }
+};
+
+// Receives the responses sent to its direct mbox
+class ResponseCollector : public so_5::agent_t {
+public:
+    ResponseCollector(so_5::environment_t& env, std::promise<ai_framework::messages::AgentResponse>& promise)
+        : so_5::agent_t(env), m_promise(promise) {}
+    
+    virtual void so_define_agent() override {
+        so_subscribe_self().event([this](const ai_framework::messages::AgentResponse& response) {
+            m_promise.set_value(response);
+        });
+    }
+    
+private:
+    std::promise<ai_framework::messages::AgentResponse>& m_promise;
+};
+
 TEST_CASE("Agent Basic Functionality", "[agent]") {
     // Create SObjectizer environment
     so_5::wrapped_env_t env;
@@ -108,4 +145,36 @@ TEST_CASE("Agent Basic Functionality", "[agent]") {
         REQUIRE(agent->ProcessMessage(message) == expectedResponse);
         REQUIRE(agent->GetLastMessage() == message);
     }
-}
\ No newline at end of file
+    
+    SECTION("Agent answers messages sent to its mbox") {
+        std::promise<ai_framework::messages::AgentResponse> answered;
+        std::promise<ai_framework::messages::AgentResponse> failed;
+        EchoAgent* agent = nullptr;
+        ResponseCollector* first = nullptr;
+        ResponseCollector* second = nullptr;
+        env.environment().introduce_coop([&](so_5::coop_t& coop) {
+            agent = coop.make_agent<EchoAgent>("test-agent-5");
+            first = coop.make_agent<ResponseCollector>(answered);
+            second = coop.make_agent<ResponseCollector>(failed);
+        });
+        
+        so_5::send<ai_framework::messages::AgentMessage>(
+            agent->so_direct_mbox(), "test", "test-agent-5", "hello", first->so_direct_mbox(), 7);
+        so_5::send<ai_framework::messages::AgentMessage>(
+            agent->so_direct_mbox(), "test", "test-agent-5", "", second->so_direct_mbox(), 8);
+        
+        auto future = answered.get_future();
+        REQUIRE(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        auto response = future.get();
+        REQUIRE(response.agentId == "test-agent-5");
+        REQUIRE(response.content == "echo: hello");
+        REQUIRE(response.requestId == 7);
+        REQUIRE(response.error.empty());
+        
+        future = failed.get_future();
+        REQUIRE(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        response = future.get();
+        REQUIRE(response.requestId == 8);
+        REQUIRE(response.error == "empty message");
+    }
+}
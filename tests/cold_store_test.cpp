@@ -0,0 +1,97 @@
+// cold_store_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/cold_store.h"
+#include "../src/learning_memory.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+uint64_t Hash(const std::string& key) {
+    return ai_framework::LearningMemory::HashKey(key);
+}
+
+} // namespace
+
+TEST_CASE("ColdStore Functionality", "[cold_store]") {
+    SECTION("Take records back from open and sealed blocks") {
+        ai_framework::ColdStore store;
+        for (int i = 0; i < 2000; ++i) {
+            std::string key = "cold_key_" + std::to_string(i);
+            store.Add(Hash(key), key, {"first " + std::to_string(i % 7), "second"});
+        }
+        REQUIRE(store.GetKeyCount() == 2000);
+        REQUIRE(store.Contains(Hash("cold_key_0")));
+        REQUIRE_FALSE(store.Contains(Hash("cold_key_2000")));
+        
+        std::string key;
+        std::vector<std::string> responses;
+        for (int i : {0, 1, 999, 1999}) {
+            REQUIRE(store.Take(Hash("cold_key_" + std::to_string(i)), key, responses) == true);
+            REQUIRE(key == "cold_key_" + std::to_string(i));
+            REQUIRE(responses == std::vector<std::string>{"first " + std::to_string(i % 7), "second"});
+        }
+        REQUIRE(store.Take(Hash("cold_key_0"), key, responses) == false);
+        REQUIRE(store.Erase(Hash("cold_key_5")) == true);
+        REQUIRE(store.Erase(Hash("cold_key_5")) == false);
+        REQUIRE(store.GetKeyCount() == 1995);
+    }
+    
+    SECTION("Visit every live record once") {
+        ai_framework::ColdStore store;
+        std::map<std::string, std::string> expected;
+        for (int i = 0; i < 3000; ++i) {
+            std::string key = "visit_" + std::to_string(i);
+            store.Add(Hash(key), key, {"response " + std::to_string(i)});
+            expected[key] = "response " + std::to_string(i);
+        }
+        
+        // Replace some and take others
+        for (int i = 0; i < 3000; i += 3) {
+            std::string key = "visit_" + std::to_string(i);
+            store.Add(Hash(key), key, {"replaced"});
+            expected[key] = "replaced";
+        }
+        for (int i = 1; i < 3000; i += 3) {
+            std::string key = "visit_" + std::to_string(i);
+            REQUIRE(store.Erase(Hash(key)));
+            expected.erase(key);
+        }
+        
+        std::map<std::string, std::string> seen;
+        store.ForEach([&seen](std::string_view key, const std::vector<std::string_view>& responses) {
+            REQUIRE(responses.size() == 1);
+            REQUIRE(seen.emplace(std::string(key), std::string(responses[0])).second);
+        });
+        REQUIRE(seen == expected);
+        REQUIRE(store.GetKeyCount() == expected.size());
+    }
+    
+    SECTION("Compress repetitive records and reclaim taken ones") {
+        ai_framework::ColdStore store;
+        const std::vector<std::string> answers = {
+            "I'm still learning how to respond to that.",
+            "That is a very interesting question, let me think about it.",
+            "The weather today is sunny with a light breeze from the west."
+        };
+        for (int i = 0; i < 20000; ++i) {
+            std::string key = "what_is_" + std::to_string(i);
+            store.Add(Hash(key), key, {answers[i % 3], answers[(i + 1) % 3]});
+        }
+        REQUIRE(store.GetMemoryBytes() * 3 < store.GetRawBytes());
+        
+        std::string key;
+        std::vector<std::string> responses;
+        size_t before = store.GetMemoryBytes();
+        for (int i = 0; i < 20000; ++i) {
+            if (i % 10 != 0) {
+                REQUIRE(store.Take(Hash("what_is_" + std::to_string(i)), key, responses));
+            }
+        }
+        REQUIRE(store.GetKeyCount() == 2000);
+        REQUIRE(store.GetMemoryBytes() < before / 2);
+        REQUIRE(store.Take(Hash("what_is_19990"), key, responses));
+        REQUIRE(responses[0] == answers[19990 % 3]);
+    }
+}
@@ -0,0 +1,83 @@
+// dispatcher_registry_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/dispatcher_registry.h"
+#include <so_5/all.hpp>
+
+TEST_CASE("DispatcherRegistry Functionality", "[dispatcher_registry]") {
+    so_5::wrapped_env_t env;
+    ai_framework::DispatcherRegistry registry(env.environment());
+    
+    SECTION("Unbound agents run on the default dispatcher") {
+        auto binding = registry.Resolve("learning", "");
+        REQUIRE(binding != nullptr);
+        REQUIRE(binding->name == ai_framework::DispatcherRegistry::DEFAULT_NAME);
+        REQUIRE(binding->binder == nullptr);
+        
+        REQUIRE(registry.Resolve("learning", "missing") == nullptr);
+    }
+    
+    SECTION("Bind agent types and agents to configured dispatchers") {
+        const std::string config = R"({"dispatchers": {
+            "learners": {"type": "thread_pool", "threads": 4, "agent_types": ["learning"]},
+            "heavy": {"type": "adv_thread_pool", "threads": 2},
+            "rules": {"type": "one_thread", "agent_types": ["rule_based"]},
+            "isolated": {"type": "active_obj"}
+        }})";
+        REQUIRE(registry.Configure(config) == true);
+        
+        auto learning = registry.Resolve("learning", "");
+        REQUIRE(learning->name == "learners");
+        REQUIRE(learning->type == "thread_pool");
+        REQUIRE(learning->threads == 4);
+        REQUIRE(learning->binder != nullptr);
+        REQUIRE(registry.Resolve("rule_based", "")->name == "rules");
+        
+        // An agent's own choice wins over its type's
+        REQUIRE(registry.Resolve("learning", "isolated")->type == "active_obj");
+        REQUIRE(registry.Resolve("learning", "heavy")->threads == 2);
+        
+        // Configuring again keeps the running dispatchers
+        REQUIRE(registry.Configure(config) == true);
+        REQUIRE(registry.Resolve("learning", "") == learning);
+        
+        auto stats = registry.GetStats();
+        REQUIRE(stats.size() == 5);
+        REQUIRE(stats[0].name == "default");
+        REQUIRE(stats[1].name == "heavy");
+        REQUIRE(stats[1].type == "adv_thread_pool");
+        REQUIRE(stats[1].queueDepth == 0);
+    }
+    
+    SECTION("Reject invalid dispatchers") {
+        REQUIRE(registry.Configure(R"({"dispatchers": {"bad": {"type": "fiber"}}})") == false);
+        REQUIRE(registry.Configure(R"({"dispatchers": {"empty": {"type": "thread_pool", "threads": 0}}})") == false);
+        REQUIRE(registry.Resolve("learning", "bad") == nullptr);
+        
+        REQUIRE(registry.Configure(R"({"dispatchers": {"single": {"type": "one_thread"}}})") == true);
+        REQUIRE(registry.Configure(R"({"dispatchers": {"single": {"type": "active_obj"}}})") == false);
+        
+        // A running pool keeps its size
+        REQUIRE(registry.Configure(R"({"dispatchers": {"pool": {"type": "thread_pool", "threads": 2}}})") == true);
+        REQUIRE(registry.Configure(R"({"dispatchers": {"pool": {"type": "thread_pool", "threads": 3}}})") == false);
+        REQUIRE(registry.Configure(R"({"dispatchers": {"pool": {"type": "thread_pool", "threads": 2}}})") == true);
+        REQUIRE(registry.Configure(R"({"dispatchers": {"pool": {"type": "thread_pool"}}})") == true);
+        REQUIRE(registry.Resolve("learning", "pool")->threads == 2);
+        REQUIRE(registry.Configure("not json") == false);
+    }
+    
+    SECTION("Apply nothing from a configuration with an invalid entry") {
+        // Entries are applied in name order, so the valid one comes first
+        REQUIRE(registry.Configure(R"({"dispatchers": {
+            "learners": {"type": "thread_pool", "threads": 2, "agent_types": ["learning"]},
+            "rules": {"type": "fiber", "agent_types": ["rule_based"]}
+        }})") == false);
+        REQUIRE(registry.Resolve("learning", "learners") == nullptr);
+        REQUIRE(registry.Resolve("learning", "")->name == ai_framework::DispatcherRegistry::DEFAULT_NAME);
+        REQUIRE(registry.GetStats().size() == 1);
+        
+        // Single-threaded dispatchers do not take a thread count
+        REQUIRE(registry.Configure(R"({"dispatchers": {"single": {"type": "one_thread", "threads": 4}}})") == false);
+        REQUIRE(registry.Configure(R"({"dispatchers": {"isolated": {"type": "active_obj", "threads": 2}}})") == false);
+        REQUIRE(registry.GetStats().size() == 1);
+    }
+}
@@ -0,0 +1,152 @@
+// feature_index_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/feature_index.h"
+#include "../src/learning_memory.h"
+#include <cmath>
+#include <map>
+#include <random>
+#include <set>
+
+TEST_CASE("FeatureIndex Functionality", "[feature_index]") {
+    SECTION("Rank keys by shared informative tokens") {
+        ai_framework::FeatureIndex index;
+        index.AddKey(1, "what_is_the");
+        index.AddKey(2, "what_is_your");
+        index.AddKey(3, "tell_me_your");
+        index.AddKey(4, "your_name_please");
+        REQUIRE(index.GetKeyCount() == 4);
+        
+        auto results = index.Search({"please", "what", "is", "your", "name"}, 2);
+        REQUIRE(results.size() == 2);
+        REQUIRE(results[0].hash == 4);
+        REQUIRE(results[1].hash == 2);
+        REQUIRE(results[0].score > results[1].score);
+        
+        REQUIRE(index.Search({"unknown"}, 5).empty());
+        REQUIRE(index.Search({"your"}, 0).empty());
+        
+        index.Clear();
+        REQUIRE(index.Search({"your"}, 5).empty());
+    }
+    
+    SECTION("Match brute-force scoring") {
+        std::mt19937 random(42);
+        std::uniform_int_distribution<int> word(0, 200);
+        
+        ai_framework::FeatureIndex index;
+        std::vector<std::set<std::string>> keys;
+        std::map<std::string, int> df;
+        for (int i = 0; i < 3000; ++i) {
+            std::vector<std::string> tokens;
+            for (int t = 0; t < 3; ++t) {
+                // Skewed so some tokens are common and some rare
+                int w = std::min(word(random), word(random));
+                tokens.push_back("w" + std::to_string(w));
+            }
+            index.AddKey(static_cast<uint64_t>(i) + 1, tokens[0] + "_" + tokens[1] + "_" + tokens[2]);
+            keys.emplace_back(tokens.begin(), tokens.end());
+            for (const auto& token : keys.back()) {
+                ++df[token];
+            }
+        }
+        
+        for (int q = 0; q < 50; ++q) {
+            std::vector<std::string> query = {
+                "w" + std::to_string(100 + word(random) / 2),
+                "w" + std::to_string(word(random)),
+                "w" + std::to_string(150 + word(random) / 4)};
+            std::vector<std::string_view> views(query.begin(), query.end());
+            std::set<std::string> distinct(query.begin(), query.end());
+            
+            size_t candidates = 0;
+            for (const auto& token : distinct) {
+                candidates += df.count(token) ? df[token] : 0;
+            }
+            if (candidates > ai_framework::FeatureIndex::MAX_CANDIDATES) {
+                continue;
+            }
+            
+            // Best brute-force score; newest key wins ties
+            float best = 0.0f;
+            uint64_t bestHash = 0;
+            for (size_t i = 0; i < keys.size(); ++i) {
+                float score = 0.0f;
+                for (const auto& token : distinct) {
+                    if (keys[i].count(token)) {
+                        score += static_cast<float>(std::log(1.0 + 3000.0 / df[token]));
+                    }
+                }
+                if (score > 0.0f && score >= best) {
+                    best = score;
+                    bestHash = i + 1;
+                }
+            }
+            
+            auto results = index.Search(views, 3);
+            if (bestHash == 0) {
+                REQUIRE(results.empty());
+                continue;
+            }
+            REQUIRE(!results.empty());
+            REQUIRE(results[0].score == Approx(best));
+            REQUIRE(results[0].hash == bestHash);
+        }
+    }
+    
+    SECTION("Index a key once and forget removed keys") {
+        ai_framework::FeatureIndex index;
+        REQUIRE(index.AddKey(1, "hello_there") == true);
+        REQUIRE(index.AddKey(1, "hello_there") == false);
+        REQUIRE(index.GetKeyCount() == 1);
+        
+        REQUIRE(index.RemoveKey(1) == true);
+        REQUIRE(index.RemoveKey(1) == false);
+        REQUIRE(index.GetKeyCount() == 0);
+        REQUIRE(index.Search({"hello"}, 5).empty());
+        
+        // Keys removed and added again, as evicted keys are relearned,
+        // neither pile up in the lists nor repeat in results
+        for (int i = 0; i < 1000; ++i) {
+            index.AddKey(static_cast<uint64_t>(i) + 1, "common_w" + std::to_string(i));
+        }
+        size_t bytes = index.GetMemoryBytes();
+        for (int round = 0; round < 20; ++round) {
+            for (int i = 0; i < 1000; ++i) {
+                REQUIRE(index.RemoveKey(static_cast<uint64_t>(i) + 1) == true);
+                REQUIRE(index.AddKey(static_cast<uint64_t>(i) + 1, "common_w" + std::to_string(i)) == true);
+            }
+        }
+        REQUIRE(index.GetKeyCount() == 1000);
+        REQUIRE(index.GetMemoryBytes() <= 2 * bytes);
+        
+        auto results = index.Search({"common"}, 2000);
+        REQUIRE(results.size() == 1000);
+        std::set<uint64_t> hashes;
+        for (const auto& result : results) {
+            hashes.insert(result.hash);
+        }
+        REQUIRE(hashes.size() == 1000);
+        
+        results = index.Search({"w5"}, 5);
+        REQUIRE(results.size() == 1);
+        REQUIRE(results[0].hash == 6);
+    }
+    
+    SECTION("Bound the work for very common tokens") {
+        ai_framework::FeatureIndex index;
+        for (int i = 0; i < 20000; ++i) {
+            index.AddKey(static_cast<uint64_t>(i) + 1, "common_" + std::to_string(i % 7));
+        }
+        index.AddKey(99999, "common_rare");
+        
+        auto results = index.Search({"common", "rare"}, 1);
+        REQUIRE(results.size() == 1);
+        REQUIRE(results[0].hash == 99999);
+        
+        // Only common tokens: the newest keys are the candidates
+        results = index.Search({"common"}, 3);
+        REQUIRE(results.size() == 3);
+        REQUIRE(results[0].hash == 99999);
+        REQUIRE(results[1].hash == 20000);
+    }
+}
@@ -2,6 +2,28 @@
 #include "catch2/catch.hpp"
 #include "../src/learning_agent.h"
 #include <so_5/all.hpp>
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Learning agent whose shutdown a test can trigger directly
+ */
+class FinishingLearningAgent : public ai_framework::LearningAgent {
+public:
+    using LearningAgent::LearningAgent;
+    
+    void Finish() {
+        so_evt_finish();
+    }
+};
+
+} // namespace
 
 TEST_CASE("LearningAgent Functionality", "[learning_agent]") {
     // Create SObjectizer environment
@@ -46,4 +68,169 @@ TEST_CASE("LearningAgent Functionality", "[learning_agent]") {
         // Check that responses are different for different message types
         REQUIRE(response1 != response2);
     }
-}
\ No newline at end of file
+    
+    SECTION("Export and import memory as JSON") {
+        const std::string path = "learning_agent_export_test.json";
+        auto source = std::make_shared<ai_framework::LearningAgent>(env.environment(), "test-learning-agent-3");
+        REQUIRE(source->Initialize(R"({"initial_memory": {"greeting": ["Hello!"]}})") == true);
+        REQUIRE(source->ExportMemoryJson(path) == true);
+        
+        auto target = std::make_shared<ai_framework::LearningAgent>(env.environment(), "test-learning-agent-4");
+        REQUIRE(target->Initialize(R"({"initial_memory": {}})") == true);
+        REQUIRE(target->ImportMemoryJson(path) == true);
+        REQUIRE(target->ProcessMessage("Greeting!") == "Hello!");
+        
+        REQUIRE(target->ImportMemoryJson("does_not_exist.json") == false);
+        std::remove(path.c_str());
+    }
+    
+    SECTION("Retrieve responses of similar keys") {
+        auto agent = std::make_shared<ai_framework::LearningAgent>(env.environment(), "test-learning-agent-5");
+        const std::string config = R"({
+            "retrieval": true,
+            "initial_memory": {
+                "what_is_your": ["My name is Agent."],
+                "how_is_the": ["The weather is fine."]
+            }
+        })";
+        REQUIRE(agent->Initialize(config) == true);
+        
+        // The exact key "tell_me_your" is unknown
+        REQUIRE(agent->ProcessMessage("Tell me your name") == "My name is Agent.");
+        REQUIRE(agent->ProcessMessage("Nothing in common here") == "I'm still learning how to respond to that.");
+    }
+    
+    SECTION("Drop evicted keys from the index") {
+        auto agent = std::make_shared<ai_framework::LearningAgent>(env.environment(), "test-learning-agent-6");
+        REQUIRE(agent->Initialize(R"({"retrieval": true, "max_memory_bytes": 65536})") == true);
+        
+        // Evicting writes re-charge the index once their shard is unlocked
+        for (int i = 0; i < 5000; ++i) {
+            agent->ProcessMessage("evicted word" + std::to_string(i) + " other" + std::to_string(i));
+        }
+        auto stats = agent->GetMemoryStats();
+        REQUIRE(stats.evictions > 0);
+        REQUIRE(stats.keys < 5000);
+        REQUIRE(agent->ProcessMessage("unrelated words here") == "I'm still learning how to respond to that.");
+    }
+    
+    SECTION("Recover learned responses from the write-ahead log") {
+        const std::string agentId = "test-learning-agent-wal";
+        const std::string config = R"({"wal": true, "checkpoint_interval_ms": 3600000})";
+        ai_framework::WriteAheadLog("memory_" + agentId + ".wal").RemoveSegmentsUpTo(UINT64_MAX);
+        std::remove(("memory_" + agentId + ".bin").c_str());
+        
+        {
+            auto agent = std::make_shared<ai_framework::LearningAgent>(env.environment(), agentId);
+            REQUIRE(agent->Initialize(config) == true);
+            REQUIRE(agent->Checkpoint() == true);
+            
+            // Learned after the checkpoint, so only the log has it
+            REQUIRE(agent->ProcessMessage("Where is the log?") == "I'm still learning how to respond to that.");
+        }
+        
+        auto agent = std::make_shared<ai_framework::LearningAgent>(env.environment(), agentId);
+        REQUIRE(agent->Initialize(config) == true);
+        
+        const std::string path = "learning_agent_wal_test.json";
+        REQUIRE(agent->ExportMemoryJson(path) == true);
+        std::ifstream file(path);
+        nlohmann::json memory = nlohmann::json::parse(file);
+        REQUIRE(memory.contains("where_is_the"));
+        REQUIRE(memory["where_is_the"].size() == 1);
+        
+        agent.reset();
+        std::remove(path.c_str());
+        ai_framework::WriteAheadLog("memory_" + agentId + ".wal").RemoveSegmentsUpTo(UINT64_MAX);
+        std::remove(("memory_" + agentId + ".bin").c_str());
+    }
+    
+    SECTION("Learn asynchronously and flush") {
+        const std::string agentId = "test-learning-agent-async";
+        std::remove(("memory_" + agentId + ".bin").c_str());
+        auto agent = std::make_shared<ai_framework::LearningAgent>(env.environment(), agentId);
+        REQUIRE(agent->Initialize(R"({"async_learning": true})") == true);
+        
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&agent, t] {
+                for (int i = 0; i < 500; ++i) {
+                    agent->ProcessMessage("async " + std::to_string(t) + " " + std::to_string(i));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        agent->FlushLearning();
+        REQUIRE(agent->GetMemoryStats().keys == 2000);
+        
+        // A checkpoint includes what is still queued
+        agent->ProcessMessage("one more message");
+        REQUIRE(agent->Checkpoint() == true);
+        auto reloaded = std::make_shared<ai_framework::LearningAgent>(env.environment(), agentId);
+        REQUIRE(reloaded->Initialize("{}") == true);
+        REQUIRE(reloaded->GetMemoryStats().keys == 2001);
+        
+        agent.reset();
+        std::remove(("memory_" + agentId + ".bin").c_str());
+    }
+    
+    SECTION("Learn what was queued while learning stopped") {
+        const std::string agentId = "test-learning-agent-async-stop";
+        auto agent = std::make_shared<FinishingLearningAgent>(env.environment(), agentId);
+        REQUIRE(agent->Initialize(R"({"async_learning": true})") == true);
+        
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&agent, t] {
+                for (int i = 0; i < 2000; ++i) {
+                    agent->ProcessMessage("stopping " + std::to_string(t) + " " + std::to_string(i));
+                }
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        agent->Finish();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        // Nothing is left behind in the queue
+        agent->FlushLearning();
+        REQUIRE(agent->GetMemoryStats().keys == 8000);
+        
+        agent.reset();
+        std::remove(("memory_" + agentId + ".bin").c_str());
+    }
+    
+    SECTION("Ingest pairs in bulk") {
+        const std::string agentId = "test-learning-agent-ingest";
+        std::remove(("memory_" + agentId + ".bin").c_str());
+        auto agent = std::make_shared<ai_framework::LearningAgent>(env.environment(), agentId);
+        REQUIRE(agent->Initialize(R"({"max_responses": 3})") == true);
+        
+        // More than one batch, each spread over several threads
+        std::vector<std::pair<std::string, std::string>> pairs;
+        const size_t count = ai_framework::LearningAgent::INGEST_BATCH + 5000;
+        for (size_t i = 0; i < count; ++i) {
+            pairs.emplace_back("question " + std::to_string(i) + " please", "answer " + std::to_string(i));
+        }
+        pairs.emplace_back("", "ignored");
+        pairs.emplace_back("question 7 please", "second answer");
+        REQUIRE(agent->Ingest(pairs) == count + 1);
+        REQUIRE(agent->GetMemoryStats().keys == count);
+        
+        REQUIRE(agent->ProcessMessage("question 12345 please") == "answer 12345");
+        
+        // Responses for one key keep their order
+        REQUIRE(agent->ExportMemoryJson("ingest_export_test.json") == true);
+        std::ifstream file("ingest_export_test.json");
+        nlohmann::json memory = nlohmann::json::parse(file);
+        REQUIRE(memory["question_7_please"] == nlohmann::json::array({"answer 7", "second answer"}));
+        std::remove("ingest_export_test.json");
+        
+        agent.reset();
+        std::remove(("memory_" + agentId + ".bin").c_str());
+    }
+}
@@ -0,0 +1,246 @@
+// learning_memory_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/learning_memory.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+TEST_CASE("LearningMemory Functionality", "[learning_memory]") {
+    SECTION("Hash features like the joined key") {
+        std::vector<std::string_view> features = {"how", "are", "you", "today"};
+        
+        REQUIRE(ai_framework::LearningMemory::JoinKey(features) == "how_are_you");
+        REQUIRE(ai_framework::LearningMemory::HashKey(features) ==
+                ai_framework::LearningMemory::HashKey("how_are_you"));
+        REQUIRE(ai_framework::LearningMemory::HashKey(std::vector<std::string_view>{"greeting"}) ==
+                ai_framework::LearningMemory::HashKey("greeting"));
+    }
+    
+    SECTION("Store and find responses") {
+        ai_framework::LearningMemory memory(3);
+        
+        memory.SetResponses("greeting", {"Hello!", "Hi there!"});
+        uint32_t entry = memory.Find(ai_framework::LearningMemory::HashKey("greeting"));
+        REQUIRE(entry != ai_framework::LearningMemory::NOT_FOUND);
+        REQUIRE(memory.GetKey(entry) == "greeting");
+        REQUIRE(memory.GetResponseCount(entry) == 2);
+        REQUIRE(memory.GetResponse(entry, 1) == "Hi there!");
+        
+        REQUIRE(memory.Find(ai_framework::LearningMemory::HashKey("farewell")) ==
+                ai_framework::LearningMemory::NOT_FOUND);
+    }
+    
+    SECTION("Drop the oldest responses beyond the limit") {
+        ai_framework::LearningMemory memory(3);
+        uint64_t hash = ai_framework::LearningMemory::HashKey("key");
+        
+        for (int i = 0; i < 5; ++i) {
+            memory.AddResponse(hash, "key", "response " + std::to_string(i));
+        }
+        
+        uint32_t entry = memory.Find(hash);
+        REQUIRE(memory.GetKeyCount() == 1);
+        REQUIRE(memory.GetResponseCount(entry) == 3);
+        REQUIRE(memory.GetResponse(entry, 0) == "response 2");
+        REQUIRE(memory.GetResponse(entry, 2) == "response 4");
+    }
+    
+    SECTION("Keep every key through growth and compaction") {
+        ai_framework::LearningMemory memory(2);
+        const int keys = 20000;
+        
+        for (int round = 0; round < 3; ++round) {
+            for (int i = 0; i < keys; ++i) {
+                std::string key = "key_" + std::to_string(i);
+                memory.AddResponse(ai_framework::LearningMemory::HashKey(key), key,
+                                   "round " + std::to_string(round));
+            }
+        }
+        
+        REQUIRE(memory.GetKeyCount() == keys);
+        for (int i = 0; i < keys; i += 997) {
+            std::string key = "key_" + std::to_string(i);
+            uint32_t entry = memory.Find(ai_framework::LearningMemory::HashKey(key));
+            REQUIRE(entry != ai_framework::LearningMemory::NOT_FOUND);
+            REQUIRE(memory.GetKey(entry) == key);
+            REQUIRE(memory.GetResponseCount(entry) == 2);
+            REQUIRE(memory.GetResponse(entry, 0) == "round 1");
+            REQUIRE(memory.GetResponse(entry, 1) == "round 2");
+        }
+    }
+    
+    SECTION("Remove keys and keep the others findable") {
+        ai_framework::LearningMemory memory(2);
+        for (int i = 0; i < 1000; ++i) {
+            std::string key = "key_" + std::to_string(i);
+            memory.AddResponse(ai_framework::LearningMemory::HashKey(key), key, "r" + std::to_string(i));
+        }
+        size_t fullBytes = memory.GetUsedBytes();
+        
+        for (int i = 0; i < 1000; i += 2) {
+            std::string key = "key_" + std::to_string(i);
+            memory.Remove(memory.Find(ai_framework::LearningMemory::HashKey(key)));
+        }
+        REQUIRE(memory.GetKeyCount() == 500);
+        REQUIRE(memory.GetUsedBytes() < fullBytes);
+        for (int i = 0; i < 1000; ++i) {
+            std::string key = "key_" + std::to_string(i);
+            uint32_t entry = memory.Find(ai_framework::LearningMemory::HashKey(key));
+            if (i % 2 == 0) {
+                REQUIRE(entry == ai_framework::LearningMemory::NOT_FOUND);
+            } else {
+                REQUIRE(entry != ai_framework::LearningMemory::NOT_FOUND);
+                REQUIRE(memory.GetKey(entry) == key);
+                REQUIRE(memory.GetResponse(entry, 0) == "r" + std::to_string(i));
+            }
+        }
+    }
+    
+    SECTION("Evict the least recently used keys to fit a budget") {
+        ai_framework::LearningMemory memory(1);
+        for (int i = 0; i < 2000; ++i) {
+            std::string key = "key_" + std::to_string(i);
+            memory.AddResponse(ai_framework::LearningMemory::HashKey(key), key, "response");
+        }
+        
+        // Keep the first keys in use
+        for (int i = 0; i < 100; ++i) {
+            std::string key = "key_" + std::to_string(i);
+            memory.AddResponse(ai_framework::LearningMemory::HashKey(key), key, "again");
+        }
+        
+        size_t target = memory.GetUsedBytes() / 2;
+        size_t evicted = memory.EvictTo(target);
+        REQUIRE(evicted > 0);
+        REQUIRE(memory.GetKeyCount() == 2000 - evicted);
+        REQUIRE(memory.GetUsedBytes() <= target);
+        
+        size_t kept = 0;
+        for (int i = 0; i < 100; ++i) {
+            std::string key = "key_" + std::to_string(i);
+            kept += memory.Find(ai_framework::LearningMemory::HashKey(key)) !=
+                    ai_framework::LearningMemory::NOT_FOUND;
+        }
+        REQUIRE(kept > 90);
+        
+        memory.EvictTo(0);
+        REQUIRE(memory.GetKeyCount() == 0);
+    }
+    
+    SECTION("Resize the response rings") {
+        ai_framework::LearningMemory memory(4);
+        uint64_t hash = ai_framework::LearningMemory::HashKey("key");
+        
+        for (int i = 0; i < 6; ++i) {
+            memory.AddResponse(hash, "key", "response " + std::to_string(i));
+        }
+        memory.AddResponse(ai_framework::LearningMemory::HashKey("other"), "other", "only");
+        
+        memory.SetMaxResponses(2);
+        uint32_t entry = memory.Find(hash);
+        REQUIRE(memory.GetResponseCount(entry) == 2);
+        REQUIRE(memory.GetResponse(entry, 0) == "response 4");
+        REQUIRE(memory.GetResponse(entry, 1) == "response 5");
+        
+        memory.SetMaxResponses(5);
+        memory.AddResponse(hash, "key", "response 6");
+        REQUIRE(memory.GetResponseCount(entry) == 3);
+        REQUIRE(memory.GetResponse(entry, 2) == "response 6");
+        
+        uint32_t other = memory.Find(ai_framework::LearningMemory::HashKey("other"));
+        REQUIRE(memory.GetResponseCount(other) == 1);
+        REQUIRE(memory.GetResponse(other, 0) == "only");
+    }
+    
+    SECTION("Round-trip through a binary snapshot") {
+        const std::string path = "learning_memory_test.bin";
+        {
+            ai_framework::LearningMemory memory(3);
+            for (int i = 0; i < 1000; ++i) {
+                std::string key = "key_" + std::to_string(i);
+                for (int j = 0; j <= i % 5; ++j) {
+                    memory.AddResponse(ai_framework::LearningMemory::HashKey(key), key,
+                                       "response " + std::to_string(j));
+                }
+            }
+            REQUIRE(memory.SaveSnapshot(path));
+        }
+        
+        ai_framework::LearningMemory loaded;
+        REQUIRE(loaded.LoadSnapshot(path));
+        REQUIRE(loaded.GetKeyCount() == 1000);
+        REQUIRE(loaded.GetMaxResponses() == 3);
+        
+        uint32_t entry = loaded.Find(ai_framework::LearningMemory::HashKey("key_4"));
+        REQUIRE(loaded.GetKey(entry) == "key_4");
+        REQUIRE(loaded.GetResponseCount(entry) == 3);
+        REQUIRE(loaded.GetResponse(entry, 0) == "response 2");
+        REQUIRE(loaded.GetResponse(entry, 2) == "response 4");
+        
+        // Mapped memory still accepts updates
+        loaded.AddResponse(ai_framework::LearningMemory::HashKey("key_4"), "key_4", "new");
+        REQUIRE(loaded.GetResponse(entry, 2) == "new");
+        REQUIRE(loaded.GetResponse(entry, 1) == "response 4");
+        
+        std::remove(path.c_str());
+    }
+    
+    SECTION("Reject missing and corrupt snapshots") {
+        const std::string path = "learning_memory_corrupt.bin";
+        ai_framework::LearningMemory memory;
+        memory.SetResponses("greeting", {"Hello!"});
+        
+        REQUIRE_FALSE(memory.LoadSnapshot("does_not_exist.bin"));
+        
+        REQUIRE(memory.SaveSnapshot(path));
+        {
+            // Truncate the text section
+            std::ifstream in(path, std::ios::binary);
+            std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            in.close();
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 4));
+        }
+        REQUIRE_FALSE(memory.LoadSnapshot(path));
+        
+        // The memory is left as it was
+        REQUIRE(memory.GetKeyCount() == 1);
+        REQUIRE(memory.GetResponse(0, 0) == "Hello!");
+        
+        // Slots must hold each entry once, under its key's hash; a table
+        // with no empty slot would make lookups of unknown keys spin
+        REQUIRE(memory.SaveSnapshot(path));
+        std::string saved;
+        {
+            std::ifstream in(path, std::ios::binary);
+            saved.assign((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        }
+        uint64_t hash = ai_framework::LearningMemory::HashKey("greeting");
+        size_t slot = saved.find(std::string(reinterpret_cast<const char*>(&hash), sizeof(hash)));
+        REQUIRE(slot != std::string::npos);
+        const size_t slotSize = 16;
+        size_t empty = saved.compare(slot + slotSize, slotSize, std::string(slotSize, '\0')) == 0 ?
+            slot + slotSize : slot - slotSize;
+        REQUIRE(saved.compare(empty, slotSize, std::string(slotSize, '\0')) == 0);
+        
+        auto loadCorrupted = [&](const std::string& bytes) {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            out.close();
+            return memory.LoadSnapshot(path);
+        };
+        
+        std::string duplicated = saved;
+        duplicated.replace(empty, slotSize, saved, slot, slotSize);
+        REQUIRE_FALSE(loadCorrupted(duplicated));
+        
+        std::string misplaced = saved;
+        misplaced[slot] = static_cast<char>(misplaced[slot] ^ 1);
+        REQUIRE_FALSE(loadCorrupted(misplaced));
+        
+        REQUIRE(loadCorrupted(saved));
+        REQUIRE(memory.GetKeyCount() == 1);
+        
+        std::remove(path.c_str());
+    }
+}
\ No newline at end of file
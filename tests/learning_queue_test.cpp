@@ -0,0 +1,78 @@
+// learning_queue_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/learning_queue.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("LearningQueue Functionality", "[learning_queue]") {
+    SECTION("Pop responses in push order") {
+        ai_framework::LearningQueue queue;
+        REQUIRE(queue.IsEmpty());
+        
+        REQUIRE(queue.Push({"key", "first"}) == true);
+        REQUIRE(queue.Push({"key", "second"}) == false);
+        REQUIRE(queue.Push({"other", "third"}) == false);
+        REQUIRE_FALSE(queue.IsEmpty());
+        
+        std::vector<ai_framework::LearnedResponse> batch;
+        REQUIRE(queue.PopAll(batch) == 3);
+        REQUIRE(batch.size() == 3);
+        REQUIRE(batch[0].response == "first");
+        REQUIRE(batch[1].response == "second");
+        REQUIRE(batch[2].key == "other");
+        REQUIRE(queue.IsEmpty());
+        REQUIRE(queue.PopAll(batch) == 0);
+        
+        // A drained queue reports empty again
+        REQUIRE(queue.Push({"key", "fourth"}) == true);
+    }
+    
+    SECTION("Keep each producer's order under contention") {
+        ai_framework::LearningQueue queue;
+        const int producers = 4;
+        const int perProducer = 20000;
+        
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&queue, p] {
+                for (int i = 0; i < perProducer; ++i) {
+                    queue.Push({std::to_string(p), std::to_string(i)});
+                }
+            });
+        }
+        
+        // Consume while the producers run
+        std::vector<int> next(producers, 0);
+        std::atomic<int> outOfOrder{0};
+        std::vector<ai_framework::LearnedResponse> batch;
+        int received = 0;
+        while (received < producers * perProducer) {
+            batch.clear();
+            received += static_cast<int>(queue.PopAll(batch));
+            for (const auto& item : batch) {
+                int& expected = next[std::stoi(item.key)];
+                if (std::stoi(item.response) != expected) {
+                    ++outOfOrder;
+                }
+                ++expected;
+            }
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        REQUIRE(outOfOrder == 0);
+        REQUIRE(queue.IsEmpty());
+        for (int p = 0; p < producers; ++p) {
+            REQUIRE(next[p] == perProducer);
+        }
+    }
+    
+    SECTION("Free responses never popped") {
+        ai_framework::LearningQueue queue;
+        queue.Push({"key", std::string(1000, 'x')});
+        queue.Push({"key", std::string(1000, 'y')});
+    }
+}
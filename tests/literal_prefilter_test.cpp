@@ -0,0 +1,36 @@
+// literal_prefilter_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/literal_prefilter.h"
+
+using ai_framework::LiteralPrefilter;
+
+TEST_CASE("LiteralPrefilter Functionality", "[literal_prefilter]") {
+    SECTION("Extract required literals") {
+        REQUIRE(LiteralPrefilter::ExtractRequiredLiteral(".*hello.*") == "hello");
+        REQUIRE(LiteralPrefilter::ExtractRequiredLiteral("(\\w+) \\1 again") == " again");
+        REQUIRE(LiteralPrefilter::ExtractRequiredLiteral("ab?cdef") == "cdef");
+        REQUIRE(LiteralPrefilter::ExtractRequiredLiteral("price: \\$\\d+") == "price: $");
+        REQUIRE(LiteralPrefilter::ExtractRequiredLiteral("x+yz") == "yz");
+        REQUIRE(LiteralPrefilter::ExtractRequiredLiteral("hello|bye").empty());
+        REQUIRE(LiteralPrefilter::ExtractRequiredLiteral("[a-z]+\\d").empty());
+    }
+    
+    SECTION("Find candidates in one scan") {
+        LiteralPrefilter prefilter(true);
+        prefilter.AddLiteral("hello", 0);
+        prefilter.AddLiteral("he", 1);
+        prefilter.AddLiteral("world", 2);
+        prefilter.AddLiteral("lo w", 3);
+        prefilter.Build();
+        
+        std::vector<size_t> ids;
+        prefilter.FindCandidates("Say HELLO World", ids);
+        REQUIRE(ids == std::vector<size_t>{0, 1, 2, 3});
+        
+        prefilter.FindCandidates("the word", ids);
+        REQUIRE(ids == std::vector<size_t>{1});
+        
+        prefilter.FindCandidates("", ids);
+        REQUIRE(ids.empty());
+    }
+}
@@ -0,0 +1,156 @@
+// lsm_store_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/lsm_store.h"
+#include "../src/learning_memory.h"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+uint64_t Hash(const std::string& key) {
+    return ai_framework::LearningMemory::HashKey(key);
+}
+
+ai_framework::LsmStoreOptions SmallOptions() {
+    ai_framework::LsmStoreOptions options;
+    options.memtableBytes = 64 * 1024;
+    options.blockBytes = 1024;
+    options.cacheBytes = 16 * 1024;
+    options.compactionTrigger = 1000;
+    return options;
+}
+
+} // namespace
+
+TEST_CASE("LsmStore Functionality", "[lsm_store]") {
+    const std::string directory = "lsm_store_test.lsm";
+    std::filesystem::remove_all(directory);
+
+    SECTION("Read records from the table and from segments") {
+        ai_framework::LsmStore store(directory, SmallOptions());
+        REQUIRE(store.Open() == true);
+        for (int i = 0; i < 5000; ++i) {
+            std::string key = "lsm_key_" + std::to_string(i);
+            store.Put(Hash(key), key, {"first " + std::to_string(i % 7), "second"});
+        }
+
+        // Overwrite some keys after their first versions reached a segment
+        REQUIRE(store.Flush() == true);
+        for (int i = 0; i < 5000; i += 10) {
+            std::string key = "lsm_key_" + std::to_string(i);
+            store.Put(Hash(key), key, {"replaced"});
+        }
+        REQUIRE(store.GetStats().segments > 1);
+
+        std::string key;
+        std::vector<std::string> responses;
+        for (int i : {0, 1, 10, 2499, 4999}) {
+            REQUIRE(store.Get(Hash("lsm_key_" + std::to_string(i)), key, responses) == true);
+            REQUIRE(key == "lsm_key_" + std::to_string(i));
+            if (i % 10 == 0) {
+                REQUIRE(responses == std::vector<std::string>{"replaced"});
+            }
+            else {
+                REQUIRE(responses == std::vector<std::string>{"first " + std::to_string(i % 7), "second"});
+            }
+        }
+        REQUIRE(store.Get(Hash("lsm_key_5000"), key, responses) == false);
+    }
+
+    SECTION("Keep flushed records across reopening") {
+        {
+            ai_framework::LsmStore store(directory, SmallOptions());
+            REQUIRE(store.Open() == true);
+            for (int i = 0; i < 3000; ++i) {
+                std::string key = "durable_" + std::to_string(i);
+                store.Put(Hash(key), key, {"response " + std::to_string(i)});
+            }
+        }
+
+        // A segment the manifest never listed is left over from a crash
+        std::ofstream(directory + "/999.sst") << "partial";
+
+        ai_framework::LsmStore store(directory, SmallOptions());
+        REQUIRE(store.Open() == true);
+        REQUIRE_FALSE(std::filesystem::exists(directory + "/999.sst"));
+
+        std::string key;
+        std::vector<std::string> responses;
+        for (int i = 0; i < 3000; i += 7) {
+            REQUIRE(store.Get(Hash("durable_" + std::to_string(i)), key, responses) == true);
+            REQUIRE(responses == std::vector<std::string>{"response " + std::to_string(i)});
+        }
+    }
+
+    SECTION("Skip segments through their bloom filters") {
+        ai_framework::LsmStore store(directory, SmallOptions());
+        REQUIRE(store.Open() == true);
+        for (int i = 0; i < 10000; ++i) {
+            std::string key = "present_" + std::to_string(i);
+            store.Put(Hash(key), key, {"response"});
+        }
+        REQUIRE(store.Flush() == true);
+
+        size_t segments = store.GetStats().segments;
+        size_t falsePositives = 0;
+        for (int i = 0; i < 10000; ++i) {
+            if (store.MayContain(Hash("absent_" + std::to_string(i)))) {
+                ++falsePositives;
+            }
+            REQUIRE(store.MayContain(Hash("present_" + std::to_string(i))));
+        }
+
+        // About 1% per segment at 10 bits per key
+        REQUIRE(falsePositives < 10000 * segments / 25);
+        REQUIRE(store.GetStats().filterSkips > 9000);
+    }
+
+    SECTION("Compact segments into one, keeping the newest records") {
+        ai_framework::LsmStore store(directory, SmallOptions());
+        REQUIRE(store.Open() == true);
+        std::map<std::string, std::string> expected;
+        for (int round = 0; round < 4; ++round) {
+            for (int i = round * 500; i < 4000; ++i) {
+                std::string key = "merge_" + std::to_string(i);
+                std::string response = "round " + std::to_string(round);
+                store.Put(Hash(key), key, {response});
+                expected[key] = response;
+            }
+            REQUIRE(store.Flush() == true);
+        }
+        ai_framework::StorageBackendStats before = store.GetStats();
+        REQUIRE(before.segments >= 4);
+
+        REQUIRE(store.Compact() == true);
+        ai_framework::StorageBackendStats after = store.GetStats();
+        REQUIRE(after.segments == 1);
+        REQUIRE(after.records == expected.size());
+        REQUIRE(after.diskBytes < before.diskBytes);
+
+        std::map<std::string, std::string> visited;
+        uint64_t lastHash = 0;
+        store.ForEach([&](uint64_t hash, std::string_view key, const std::vector<std::string_view>& responses) {
+            REQUIRE(hash >= lastHash);
+            lastHash = hash;
+            REQUIRE(responses.size() == 1);
+            visited[std::string(key)] = std::string(responses[0]);
+        });
+        REQUIRE(visited == expected);
+
+        size_t files = 0;
+        for (const auto& item : std::filesystem::directory_iterator(directory)) {
+            files += item.path().extension() == ".sst";
+        }
+        REQUIRE(files == 1);
+    }
+
+    SECTION("Reject an unknown backend type") {
+        REQUIRE(ai_framework::StorageBackend::Create("unknown", directory) == nullptr);
+        REQUIRE(ai_framework::StorageBackend::Create("lsm", directory) != nullptr);
+    }
+
+    std::filesystem::remove_all(directory);
+}
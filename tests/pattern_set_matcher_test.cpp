@@ -0,0 +1,133 @@
+// pattern_set_matcher_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/pattern_set_matcher.h"
+#include <random>
+#include <regex>
+#include <thread>
+#include <vector>
+
+using ai_framework::PatternSetMatcher;
+
+TEST_CASE("PatternSetMatcher Functionality", "[pattern_set_matcher]") {
+    SECTION("Reports the lowest matching id") {
+        PatternSetMatcher matcher(true);
+        REQUIRE(matcher.AddPattern(".*hello.*", 0) == true);
+        REQUIRE(matcher.AddPattern(".*bye.*", 1) == true);
+        REQUIRE(matcher.AddPattern("world", 2) == true);
+
+        REQUIRE(matcher.FindFirstMatch("hello world") == 0);
+        REQUIRE(matcher.FindFirstMatch("bye world") == 1);
+        REQUIRE(matcher.FindFirstMatch("the world") == 2);
+        REQUIRE(matcher.FindFirstMatch("nothing here") == PatternSetMatcher::NO_MATCH);
+    }
+
+    SECTION("Honours case-insensitivity") {
+        PatternSetMatcher icase(true);
+        PatternSetMatcher exact(false);
+        REQUIRE(icase.AddPattern("Hello [a-z]+", 0) == true);
+        REQUIRE(exact.AddPattern("Hello [a-z]+", 0) == true);
+
+        REQUIRE(icase.FindFirstMatch("HELLO THERE") == 0);
+        REQUIRE(exact.FindFirstMatch("HELLO THERE") == PatternSetMatcher::NO_MATCH);
+        REQUIRE(exact.FindFirstMatch("Hello there") == 0);
+    }
+
+    SECTION("Handles anchors") {
+        PatternSetMatcher matcher(true);
+        REQUIRE(matcher.AddPattern("^start", 0) == true);
+        REQUIRE(matcher.AddPattern("end$", 1) == true);
+        REQUIRE(matcher.AddPattern("^$", 2) == true);
+
+        REQUIRE(matcher.FindFirstMatch("start here") == 0);
+        REQUIRE(matcher.FindFirstMatch("not start") == PatternSetMatcher::NO_MATCH);
+        REQUIRE(matcher.FindFirstMatch("the end") == 1);
+        REQUIRE(matcher.FindFirstMatch("end of it") == PatternSetMatcher::NO_MATCH);
+        REQUIRE(matcher.FindFirstMatch("") == 2);
+    }
+
+    SECTION("Rejects syntax outside the regular subset") {
+        PatternSetMatcher matcher(true);
+        REQUIRE(matcher.AddPattern("(a)\\1", 0) == false);
+        REQUIRE(matcher.AddPattern("\\bword\\b", 1) == false);
+        REQUIRE(matcher.AddPattern("foo(?=bar)", 2) == false);
+        REQUIRE(matcher.GetPatternCount() == 0);
+    }
+
+    SECTION("Agrees with std::regex") {
+        const std::vector<std::string> patterns = {
+            "a+b*c?", "(ab|cd){2,3}", "[^0-9 ]+x", "\\d{3}-\\d{4}",
+            "(?:foo|bar)baz$", "\\w+@\\w+\\.com", "^\\s*$", "colou?r"
+        };
+        const std::vector<std::string> texts = {
+            "", "abc", "ababcd", "call 555-1234", "foobaz", "a foobaz b",
+            "mail me@example.com", "   ", "color", "COLOUR", "xyz"
+        };
+
+        PatternSetMatcher matcher(true);
+        for (size_t i = 0; i < patterns.size(); ++i) {
+            REQUIRE(matcher.AddPattern(patterns[i], i) == true);
+        }
+
+        for (const auto& text : texts) {
+            size_t expected = PatternSetMatcher::NO_MATCH;
+            for (size_t i = 0; i < patterns.size(); ++i) {
+                if (std::regex_search(text, std::regex(patterns[i], std::regex::icase))) {
+                    expected = i;
+                    break;
+                }
+            }
+            REQUIRE(matcher.FindFirstMatch(text) == expected);
+        }
+    }
+    
+    SECTION("Keeps matching after the DFA cache fills up") {
+        // Remembering the last 13 bytes needs more states than the cache holds
+        const std::vector<std::string> patterns = {"a[ab]{12}c", "c{3}"};
+        PatternSetMatcher matcher(false);
+        for (size_t i = 0; i < patterns.size(); ++i) {
+            REQUIRE(matcher.AddPattern(patterns[i], i) == true);
+        }
+        
+        std::mt19937 random(42);
+        std::uniform_int_distribution<int> letter(0, 20);
+        std::vector<std::string> texts;
+        std::vector<size_t> expected;
+        for (int i = 0; i < 200; ++i) {
+            std::string text;
+            for (int j = 0; j < 400; ++j) {
+                int roll = letter(random);
+                text += roll == 0 ? 'c' : (roll % 2 ? 'a' : 'b');
+            }
+            size_t match = PatternSetMatcher::NO_MATCH;
+            for (size_t p = 0; p < patterns.size(); ++p) {
+                if (std::regex_search(text, std::regex(patterns[p]))) {
+                    match = p;
+                    break;
+                }
+            }
+            texts.push_back(text);
+            expected.push_back(match);
+        }
+        
+        // Searches racing over a flush still see consistent states
+        std::vector<size_t> mismatches(4, 0);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < mismatches.size(); ++t) {
+            threads.emplace_back([&, t]() {
+                for (size_t i = 0; i < texts.size(); ++i) {
+                    if (matcher.FindFirstMatch(texts[i]) != expected[i]) {
+                        ++mismatches[t];
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        for (size_t count : mismatches) {
+            REQUIRE(count == 0);
+        }
+        REQUIRE(matcher.GetDfaFlushCount() > 0);
+    }
+}
@@ -0,0 +1,79 @@
+// rcu_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/rcu.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Tracked {
+    explicit Tracked(int v, std::atomic<int>& live) : value(v), liveCount(live) {
+        ++liveCount;
+    }
+    ~Tracked() {
+        value = -1;
+        --liveCount;
+    }
+    int value;
+    std::atomic<int>& liveCount;
+};
+
+} // namespace
+
+TEST_CASE("RcuPointer Functionality", "[rcu]") {
+    std::atomic<int> live(0);
+    
+    SECTION("Store publishes and reclaims after readers drain") {
+        ai_framework::RcuPointer<Tracked> pointer(std::make_unique<Tracked>(1, live));
+        
+        {
+            ai_framework::EpochGuard guard;
+            Tracked* old = pointer.Load();
+            pointer.Store(std::make_unique<Tracked>(2, live));
+            
+            // The reader still sees the object it loaded
+            REQUIRE(old->value == 1);
+            REQUIRE(live == 2);
+        }
+        
+        ai_framework::EpochDomain::GetInstance().Reclaim();
+        REQUIRE(live == 1);
+        
+        ai_framework::EpochGuard guard;
+        REQUIRE(pointer.Load()->value == 2);
+    }
+    
+    SECTION("Concurrent readers never see a freed object") {
+        {
+            ai_framework::RcuPointer<Tracked> pointer(std::make_unique<Tracked>(0, live));
+            std::atomic<bool> stop(false);
+            std::atomic<bool> sawFreed(false);
+            
+            std::vector<std::thread> readers;
+            for (int i = 0; i < 4; ++i) {
+                readers.emplace_back([&]() {
+                    while (!stop) {
+                        ai_framework::EpochGuard guard;
+                        if (pointer.Load()->value < 0) {
+                            sawFreed = true;
+                        }
+                    }
+                });
+            }
+            
+            for (int i = 1; i <= 2000; ++i) {
+                pointer.Store(std::make_unique<Tracked>(i, live));
+            }
+            stop = true;
+            for (auto& reader : readers) {
+                reader.join();
+            }
+            
+            REQUIRE(sawFreed == false);
+        }
+        
+        ai_framework::EpochDomain::GetInstance().Reclaim();
+        REQUIRE(live == 0);
+    }
+}
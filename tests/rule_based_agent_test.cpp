@@ -1,6 +1,7 @@
 // rule_based_agent_test.cpp
 #include "catch2/catch.hpp"
 #include "../src/rule_based_agent.h"
+#include <nlohmann/json.hpp>
 #include <so_5/all.hpp>
 
 TEST_CASE("RuleBasedAgent Functionality", "[rule_based_agent]") {
@@ -55,4 +56,107 @@ TEST_CASE("RuleBasedAgent Functionality", "[rule_based_agent]") {
         // Test default response
         REQUIRE(agent->ProcessMessage("something random") == "I don't understand.");
     }
+    
+    SECTION("Substitute captures into responses") {
+        const std::string agentId = "test-rule-agent-3";
+        auto agent = std::make_shared<ai_framework::RuleBasedAgent>(env.environment(), agentId);
+        
+        const std::string config = R"json({
+            "rules": [
+                {"pattern": "my name is (\\w+)", "response": "Nice to meet you, $1!", "priority": 10},
+                {"pattern": "(\\d+) plus (\\d+)", "response": "$1 + $2 = ?", "priority": 5},
+                {"pattern": "cost", "response": "That costs $5.", "priority": 1}
+            ]
+        })json";
+        
+        REQUIRE(agent->Initialize(config) == true);
+        
+        REQUIRE(agent->ProcessMessage("Hi, my name is Ada") == "Nice to meet you, Ada!");
+        REQUIRE(agent->ProcessMessage("what is 2 plus 40") == "2 + 40 = ?");
+        
+        // Placeholders beyond the pattern's groups stay as written
+        REQUIRE(agent->ProcessMessage("what does it cost") == "That costs $5.");
+    }
+    
+    SECTION("Prefilter rules evaluated with std::regex") {
+        const std::string agentId = "test-rule-agent-4";
+        auto agent = std::make_shared<ai_framework::RuleBasedAgent>(env.environment(), agentId);
+        
+        // Back-references keep these rules out of the set matcher
+        const std::string config = R"json({
+            "rules": [
+                {"pattern": "(\\w+) \\1 again", "response": "Repeating $1?", "priority": 10},
+                {"pattern": "(\\w+) and \\1", "response": "Twice $1.", "priority": 5}
+            ],
+            "default_response": "I don't understand."
+        })json";
+        
+        REQUIRE(agent->Initialize(config) == true);
+        
+        REQUIRE(agent->ProcessMessage("nothing to see") == "I don't understand.");
+        REQUIRE(agent->ProcessMessage("tea and tea") == "Twice tea.");
+        REQUIRE(agent->ProcessMessage("no no again") == "Repeating no?");
+        
+        auto stats = agent->GetPrefilterStats();
+        REQUIRE(stats.messagesScanned == 3);
+        REQUIRE(stats.rulesEliminated == 4);
+        REQUIRE(stats.rulesEvaluated == 2);
+    }
+    
+    SECTION("Reload rules while serving messages") {
+        const std::string agentId = "test-rule-agent-5";
+        auto agent = std::make_shared<ai_framework::RuleBasedAgent>(env.environment(), agentId);
+        
+        REQUIRE(agent->Initialize(R"({
+            "rules": [{"pattern": ".*hello.*", "response": "Hi there!"}],
+            "default_response": "I don't understand."
+        })") == true);
+        REQUIRE(agent->ProcessMessage("hello") == "Hi there!");
+        
+        REQUIRE(agent->ReloadRules(R"({
+            "rules": [{"pattern": ".*hello.*", "response": "Welcome back!"}]
+        })") == true);
+        REQUIRE(agent->ProcessMessage("hello") == "Welcome back!");
+        
+        // The default response survives a reload that does not set it
+        REQUIRE(agent->ProcessMessage("something random") == "I don't understand.");
+        
+        // Invalid rules leave the current ones in place
+        REQUIRE(agent->ReloadRules("invalid_json") == false);
+        REQUIRE(agent->ProcessMessage("hello") == "Welcome back!");
+    }
+    
+    SECTION("Profile rule hits") {
+        const std::string agentId = "test-rule-agent-6";
+        auto agent = std::make_shared<ai_framework::RuleBasedAgent>(env.environment(), agentId);
+        
+        REQUIRE(agent->Initialize(R"({
+            "rules": [
+                {"pattern": ".*hello.*", "response": "Hi there!", "priority": 10},
+                {"pattern": ".*hello world.*", "response": "Never answered", "priority": 5},
+                {"pattern": ".*bye.*", "response": "Goodbye!", "priority": 1}
+            ]
+        })") == true);
+        
+        agent->ProcessMessage("hello world");
+        agent->ProcessMessage("bye");
+        agent->ProcessMessage("something random");
+        
+        auto profile = agent->GetRuleProfile();
+        REQUIRE(profile.messages == 3);
+        REQUIRE(profile.rules[0].matches == 1);
+        REQUIRE(profile.rules[1].evaluations == 2);
+        REQUIRE(profile.rules[1].matches == 0);
+        REQUIRE(profile.rules[2].matches == 1);
+        
+        auto dump = nlohmann::json::parse(agent->DumpRuleProfile());
+        REQUIRE(dump["agent_id"] == agentId);
+        REQUIRE(dump["rules"][1]["pattern"] == ".*hello world.*");
+        REQUIRE(dump["rules"][1]["dead"] == true);
+        REQUIRE(dump["rules"][0]["dead"] == false);
+        
+        // Reloading starts the counters over
+        REQUIRE(agent->ReloadRules(R"({"rules": [{"pattern": ".*hello.*", "response": "Hi!"}]})") == true);
+        REQUIRE(agent->GetRuleProfile().messages == 0);
+    }
 }
\ No newline at end of file
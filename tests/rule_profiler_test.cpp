@@ -0,0 +1,65 @@
+// rule_profiler_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/rule_profiler.h"
+#include <thread>
+#include <vector>
+
+TEST_CASE("RuleProfiler Functionality", "[rule_profiler]") {
+    SECTION("Derive evaluations from matches") {
+        ai_framework::RuleProfiler profiler(3);
+        auto& counters = profiler.Local();
+        
+        counters.RecordMessage(0, 10);
+        counters.RecordMessage(1, 10);
+        counters.RecordMessage(1, 10);
+        counters.RecordMessage(3, 10);  // no rule matched
+        counters.RecordRegexRun(2, 50);
+        
+        auto profile = profiler.Collect();
+        REQUIRE(profile.messages == 4);
+        REQUIRE(profile.matcherNanos == 40);
+        REQUIRE(profile.rules.size() == 3);
+        
+        REQUIRE(profile.rules[0].evaluations == 4);
+        REQUIRE(profile.rules[0].matches == 1);
+        REQUIRE(profile.rules[1].evaluations == 3);
+        REQUIRE(profile.rules[1].matches == 2);
+        REQUIRE(profile.rules[2].evaluations == 1);
+        REQUIRE(profile.rules[2].matches == 0);
+        REQUIRE(profile.rules[2].regexRuns == 1);
+        REQUIRE(profile.rules[2].regexNanos == 50);
+    }
+    
+    SECTION("Aggregate counters of all threads") {
+        ai_framework::RuleProfiler profiler(2);
+        
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&profiler]() {
+                auto& counters = profiler.Local();
+                for (int i = 0; i < 1000; ++i) {
+                    counters.RecordMessage(static_cast<size_t>(i % 2), 1);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        auto profile = profiler.Collect();
+        REQUIRE(profile.messages == 4000);
+        REQUIRE(profile.rules[0].matches == 2000);
+        REQUIRE(profile.rules[1].matches == 2000);
+        REQUIRE(profile.rules[1].evaluations == 2000);
+    }
+    
+    SECTION("Profilers keep separate counters") {
+        ai_framework::RuleProfiler first(1);
+        ai_framework::RuleProfiler second(1);
+        
+        first.Local().RecordMessage(0, 0);
+        
+        REQUIRE(first.Collect().rules[0].matches == 1);
+        REQUIRE(second.Collect().messages == 0);
+    }
+}
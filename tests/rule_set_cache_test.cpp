@@ -0,0 +1,61 @@
+// rule_set_cache_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/rule_set_cache.h"
+#include "../src/rule_based_agent.h"
+#include <so_5/all.hpp>
+
+TEST_CASE("RuleSetCache Functionality", "[rule_set_cache]") {
+    auto& cache = ai_framework::RuleSetCache::GetInstance();
+    
+    SECTION("Identical rules share one compiled set") {
+        const std::string rules = R"([{"pattern":".*cache-one.*","priority":1,"response":"One"}])";
+        
+        auto first = cache.Acquire(rules);
+        auto before = cache.GetStats();
+        auto second = cache.Acquire(rules);
+        auto after = cache.GetStats();
+        
+        REQUIRE(first == second);
+        REQUIRE(after.hits == before.hits + 1);
+        REQUIRE(after.misses == before.misses);
+        
+        auto other = cache.Acquire(R"([{"pattern":".*cache-two.*","response":"Two"}])");
+        REQUIRE(other != first);
+        REQUIRE(other->GetPatternSource(0) == ".*cache-two.*");
+    }
+    
+    SECTION("Rule sets are freed with their last user") {
+        const std::string rules = R"([{"pattern":".*cache-three.*","response":"Three"}])";
+        
+        std::weak_ptr<const ai_framework::CompiledRuleSet> weak = cache.Acquire(rules);
+        REQUIRE(weak.expired());
+        
+        auto before = cache.GetStats();
+        auto ruleSet = cache.Acquire(rules);
+        REQUIRE(cache.GetStats().misses == before.misses + 1);
+    }
+    
+    SECTION("Agents with the same config skip compilation") {
+        so_5::wrapped_env_t env;
+        const std::string config = R"({
+            "rules": [{"pattern": ".*shared.*", "response": "Shared by ${agent_id}"}]
+        })";
+        // Same rules with different key order and spacing
+        const std::string reordered = R"({"rules":[{"response":"Shared by ${agent_id}","pattern":".*shared.*"}]})";
+        
+        auto first = std::make_shared<ai_framework::RuleBasedAgent>(env.environment(), "cache-agent-1");
+        auto second = std::make_shared<ai_framework::RuleBasedAgent>(env.environment(), "cache-agent-2");
+        
+        REQUIRE(first->Initialize(config) == true);
+        auto before = cache.GetStats();
+        REQUIRE(second->Initialize(reordered) == true);
+        auto after = cache.GetStats();
+        
+        REQUIRE(after.misses == before.misses);
+        REQUIRE(after.hits == before.hits + 1);
+        
+        // Shared rules still respond per agent
+        REQUIRE(first->ProcessMessage("shared") == "Shared by cache-agent-1");
+        REQUIRE(second->ProcessMessage("shared") == "Shared by cache-agent-2");
+    }
+}
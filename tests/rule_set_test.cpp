@@ -0,0 +1,51 @@
+// rule_set_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/rule_set.h"
+
+TEST_CASE("RuleSetBuilder Functionality", "[rule_set]") {
+    SECTION("Build sorts rules by priority once") {
+        ai_framework::RuleSetBuilder builder;
+        REQUIRE(builder.AddRule("low", "Low", 1) == true);
+        REQUIRE(builder.AddRule("high", "High", 10) == true);
+        REQUIRE(builder.AddRule("tie", "First tie", 5) == true);
+        REQUIRE(builder.AddRule("tie", "Second tie", 5) == true);
+        REQUIRE(builder.AddRule("(unclosed", "Invalid", 3) == false);
+        REQUIRE(builder.GetRuleCount() == 4);
+        
+        auto ruleSet = builder.Build();
+        REQUIRE(builder.GetRuleCount() == 0);
+        REQUIRE(ruleSet->GetRuleCount() == 4);
+        REQUIRE(ruleSet->GetPatternSource(0) == "high");
+        REQUIRE(ruleSet->GetPriority(0) == 10);
+        REQUIRE(ruleSet->GetPriority(3) == 1);
+        
+        std::smatch matches;
+        ai_framework::PrefilterStats stats = {};
+        size_t index = ruleSet->FindMatch("high and low and tie", matches, stats);
+        REQUIRE(index == 0);
+        
+        // Equal priorities keep their insertion order
+        index = ruleSet->FindMatch("a tie", matches, stats);
+        REQUIRE(ruleSet->GenerateResponse(index, matches, "agent") == "First tie");
+        
+        REQUIRE(ruleSet->FindMatch("nothing", matches, stats) == 
+                ai_framework::CompiledRuleSet::NO_MATCH);
+    }
+    
+    SECTION("Build handles large rule files") {
+        ai_framework::RuleSetBuilder builder;
+        for (int i = 0; i < 5000; ++i) {
+            builder.AddRule("keyword" + std::to_string(i) + "\\b", 
+                            "Rule " + std::to_string(i), i % 7);
+        }
+        
+        auto ruleSet = builder.Build();
+        REQUIRE(ruleSet->GetRuleCount() == 5000);
+        
+        std::smatch matches;
+        ai_framework::PrefilterStats stats = {};
+        size_t index = ruleSet->FindMatch("about keyword4242 here", matches, stats);
+        REQUIRE(index != ai_framework::CompiledRuleSet::NO_MATCH);
+        REQUIRE(ruleSet->GenerateResponse(index, matches, "agent") == "Rule 4242");
+    }
+}
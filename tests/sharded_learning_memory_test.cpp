@@ -0,0 +1,303 @@
+// sharded_learning_memory_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/sharded_learning_memory.h"
+#include "../src/memory_budget.h"
+#include "../src/write_ahead_log.h"
+#include <cstdio>
+#include <filesystem>
+#include <set>
+#include <thread>
+
+TEST_CASE("ShardedLearningMemory Functionality", "[sharded_learning_memory]") {
+    SECTION("Learn and pick responses") {
+        ai_framework::ShardedLearningMemory memory(3);
+        std::vector<std::string_view> features = {"how", "are", "you", "today"};
+        uint64_t hash = ai_framework::LearningMemory::HashKey(features);
+        
+        std::string response;
+        REQUIRE(memory.GetRandomResponse(hash, response) == false);
+        
+        memory.Learn(features, "Fine");
+        memory.Learn(features, "Great");
+        REQUIRE(memory.GetKeyCount() == 1);
+        
+        std::set<std::string> seen;
+        for (int i = 0; i < 200; ++i) {
+            REQUIRE(memory.GetRandomResponse(hash, response) == true);
+            seen.insert(response);
+        }
+        REQUIRE(seen == std::set<std::string>{"Fine", "Great"});
+        
+        memory.ForEach([](std::string_view key, const std::vector<std::string_view>& responses) {
+            REQUIRE(key == "how_are_you");
+            REQUIRE(responses.size() == 2);
+            REQUIRE(responses[0] == "Fine");
+        });
+    }
+    
+    SECTION("Learn from many threads at once") {
+        ai_framework::ShardedLearningMemory memory(4);
+        const int threadCount = 8;
+        const int keysPerThread = 500;
+        
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&memory, t]() {
+                std::string response;
+                for (int i = 0; i < keysPerThread; ++i) {
+                    std::string word = "w" + std::to_string(t) + "_" + std::to_string(i);
+                    std::vector<std::string_view> features = {"key", word};
+                    memory.Learn(features, word);
+                    
+                    // Readers share every shard with the writers
+                    std::vector<std::string_view> shared = {"shared"};
+                    memory.Learn(shared, word);
+                    memory.GetRandomResponse(ai_framework::LearningMemory::HashKey(shared), response);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        REQUIRE(memory.GetKeyCount() == threadCount * keysPerThread + 1);
+        std::string response;
+        REQUIRE(memory.GetRandomResponse(ai_framework::LearningMemory::HashKey("key_w3_42"), response));
+        REQUIRE(response == "w3_42");
+    }
+    
+    SECTION("Round-trip through a sharded snapshot") {
+        const std::string path = "sharded_learning_memory_test.bin";
+        ai_framework::ShardedLearningMemory memory(3);
+        for (int i = 0; i < 100; ++i) {
+            memory.SetResponses("key" + std::to_string(i), {"a" + std::to_string(i), "b"});
+        }
+        REQUIRE(memory.SaveSnapshot(path) == true);
+        
+        ai_framework::ShardedLearningMemory loaded;
+        REQUIRE(loaded.LoadSnapshot(path) == true);
+        REQUIRE(loaded.GetKeyCount() == 100);
+        std::string response;
+        REQUIRE(loaded.GetRandomResponse(ai_framework::LearningMemory::HashKey("key7"), response));
+        REQUIRE((response == "a7" || response == "b"));
+        
+        REQUIRE(loaded.LoadSnapshot("does_not_exist.bin") == false);
+        REQUIRE(loaded.GetKeyCount() == 100);
+        std::remove(path.c_str());
+    }
+    
+    SECTION("Keep the log when it cannot be rotated for a snapshot") {
+        const std::string path = "sharded_learning_memory_wal_test.bin";
+        const std::string base = "sharded_learning_memory_test.wal";
+        ai_framework::WriteAheadLog log(base);
+        REQUIRE(log.Open() == true);
+        
+        ai_framework::ShardedLearningMemory memory(3);
+        memory.SetResponses("key", {"a"});
+        log.Append("key", "a");
+        
+        std::filesystem::create_directory(base + ".2");
+        REQUIRE(memory.SaveSnapshot(path, &log) == false);
+        REQUIRE(std::filesystem::exists(path) == false);
+        REQUIRE(std::filesystem::exists(base + ".1") == true);
+        std::filesystem::remove(base + ".2");
+        
+        REQUIRE(memory.SaveSnapshot(path, &log) == true);
+        REQUIRE(std::filesystem::exists(base + ".1") == false);
+        
+        log.RemoveSegmentsUpTo(UINT64_MAX);
+        std::remove(path.c_str());
+    }
+    
+    SECTION("Load a single-memory snapshot") {
+        const std::string path = "sharded_learning_memory_single_test.bin";
+        ai_framework::LearningMemory single(3);
+        for (int i = 0; i < 50; ++i) {
+            single.SetResponses("key" + std::to_string(i), {"r" + std::to_string(i)});
+        }
+        REQUIRE(single.SaveSnapshot(path, 7) == true);
+        
+        ai_framework::ShardedLearningMemory memory;
+        uint64_t logPosition = 0;
+        REQUIRE(memory.LoadSnapshot(path, &logPosition) == true);
+        REQUIRE(logPosition == 7);
+        REQUIRE(memory.GetKeyCount() == 50);
+        std::string response;
+        REQUIRE(memory.GetRandomResponse(ai_framework::LearningMemory::HashKey("key49"), response));
+        REQUIRE(response == "r49");
+        std::remove(path.c_str());
+    }
+    
+    SECTION("Stay within the per-memory budget") {
+        ai_framework::ShardedLearningMemory memory(2);
+        memory.SetByteBudget(256 * 1024);
+        for (int i = 0; i < 20000; ++i) {
+            memory.Learn({"key", std::to_string(i)}, "response " + std::to_string(i));
+        }
+        
+        ai_framework::LearningMemoryStats stats = memory.GetStats();
+        REQUIRE(stats.budgetBytes == 256 * 1024);
+        REQUIRE(stats.usedBytes <= stats.budgetBytes);
+        REQUIRE(stats.evictions > 0);
+        REQUIRE(stats.evictedBytes > 0);
+        REQUIRE(stats.keys == 20000 - stats.evictions);
+        
+        // The latest keys survive
+        std::string response;
+        REQUIRE(memory.GetRandomResponse(ai_framework::LearningMemory::HashKey("key_19999"), response));
+        REQUIRE(response == "response 19999");
+    }
+    
+    SECTION("Report dropped keys and charge outside bytes") {
+        ai_framework::ShardedLearningMemory memory(2);
+        memory.SetByteBudget(256 * 1024);
+        std::set<uint64_t> dropped;
+        memory.SetEvictionListener([&dropped](uint64_t hash) {
+            dropped.insert(hash);
+        });
+        for (int i = 0; i < 20000; ++i) {
+            memory.Learn({"key", std::to_string(i)}, "response");
+        }
+        REQUIRE(dropped.size() == memory.GetStats().evictions);
+        REQUIRE(dropped.count(ai_framework::LearningMemory::HashKey("key_0")) == 1);
+        
+        // Half the budget held elsewhere leaves the other half to the shards
+        ai_framework::MemoryBudget& budget = ai_framework::MemoryBudget::GetInstance();
+        int64_t before = budget.GetStats().usedBytes;
+        memory.SetExternalBytes(128 * 1024);
+        REQUIRE(budget.GetStats().usedBytes == before + 128 * 1024);
+        memory.SetExternalBytes(128 * 1024 + 1);
+        REQUIRE(budget.GetStats().usedBytes == before + 128 * 1024);
+        for (int i = 20000; i < 40000; ++i) {
+            memory.Learn({"key", std::to_string(i)}, "response");
+        }
+        REQUIRE(memory.GetStats().usedBytes <= 128 * 1024);
+        REQUIRE(dropped.size() == memory.GetStats().evictions);
+        
+        memory.SetExternalBytes(0);
+        REQUIRE(budget.GetStats().usedBytes <= before);
+    }
+    
+    SECTION("Share the process-wide budget") {
+        ai_framework::MemoryBudget& budget = ai_framework::MemoryBudget::GetInstance();
+        int64_t before = budget.GetStats().usedBytes;
+        uint64_t evictionsBefore = budget.GetStats().evictions;
+        {
+            ai_framework::ShardedLearningMemory first;
+            ai_framework::ShardedLearningMemory second;
+            budget.SetLimit(static_cast<uint64_t>(before) + 512 * 1024);
+            for (int i = 0; i < 20000; ++i) {
+                first.Learn({"first", std::to_string(i)}, "response");
+                second.Learn({"second", std::to_string(i)}, "response");
+            }
+            budget.SetLimit(0);
+            
+            // Charges lag by at most one batch per shard
+            int64_t charged = budget.GetStats().usedBytes - before;
+            REQUIRE(charged <= 512 * 1024 + 2 * 16 * ai_framework::ShardedLearningMemory::CHARGE_BATCH);
+            REQUIRE(first.GetStats().evictions > 0);
+            REQUIRE(second.GetStats().evictions > 0);
+            REQUIRE(budget.GetStats().evictions > evictionsBefore);
+        }
+        REQUIRE(budget.GetStats().usedBytes == before);
+    }
+    
+    SECTION("Keep evicted keys in the cold tier") {
+        ai_framework::ShardedLearningMemory memory(2);
+        memory.SetByteBudget(256 * 1024);
+        memory.SetColdTier(true);
+        for (int i = 0; i < 100000; ++i) {
+            memory.Learn({"key", std::to_string(i)}, "response " + std::to_string(i % 10));
+        }
+        
+        ai_framework::LearningMemoryStats stats = memory.GetStats();
+        REQUIRE(stats.usedBytes <= stats.budgetBytes);
+        REQUIRE(stats.coldKeys > 0);
+        REQUIRE(stats.keys + stats.coldKeys == 100000);
+        REQUIRE(memory.GetKeyCount() == 100000);
+        
+        // Compressed, even records this small take less than they did in memory
+        REQUIRE(stats.coldBytes < stats.evictedBytes);
+        
+        // Every key answers, cold ones move back
+        for (int i = 0; i < 100000; i += 997) {
+            std::string response;
+            REQUIRE(memory.GetRandomResponse(ai_framework::LearningMemory::HashKey("key_" + std::to_string(i)), response));
+            REQUIRE(response == "response " + std::to_string(i % 10));
+        }
+        
+        // Learning a cold key keeps its earlier response
+        memory.SetByteBudget(0);
+        memory.Learn({"key", "1"}, "again");
+        size_t visited = 0;
+        memory.ForEach([&visited](std::string_view key, const std::vector<std::string_view>& responses) {
+            if (key == "key_1") {
+                REQUIRE(responses == std::vector<std::string_view>{"response 1", "again"});
+            }
+            ++visited;
+        });
+        REQUIRE(visited == 100000);
+        
+        const std::string path = "sharded_learning_memory_cold_test.bin";
+        REQUIRE(memory.SaveSnapshot(path) == true);
+        ai_framework::ShardedLearningMemory loaded;
+        REQUIRE(loaded.LoadSnapshot(path) == true);
+        REQUIRE(loaded.GetKeyCount() == 100000);
+        std::remove(path.c_str());
+    }
+    
+    SECTION("Write evicted keys to a storage backend") {
+        const std::string directory = "sharded_learning_memory_test.lsm";
+        std::filesystem::remove_all(directory);
+        {
+            ai_framework::ShardedLearningMemory memory(2);
+            memory.SetByteBudget(256 * 1024);
+            memory.SetStorageBackend(ai_framework::StorageBackend::Create("lsm", directory));
+            REQUIRE(memory.HasStorageBackend());
+            for (int i = 0; i < 50000; ++i) {
+                memory.Learn({"key", std::to_string(i)}, "response " + std::to_string(i % 10));
+            }
+            
+            ai_framework::LearningMemoryStats stats = memory.GetStats();
+            REQUIRE(stats.usedBytes <= stats.budgetBytes);
+            REQUIRE(stats.keys < 50000);
+            REQUIRE(stats.coldKeys == 0);
+            REQUIRE(stats.storage.records >= 50000 - stats.keys);
+            
+            // Stored keys answer and move back into memory
+            for (int i = 0; i < 50000; i += 997) {
+                std::string response;
+                REQUIRE(memory.GetRandomResponse(ai_framework::LearningMemory::HashKey("key_" + std::to_string(i)), response));
+                REQUIRE(response == "response " + std::to_string(i % 10));
+            }
+            
+            // Learning a stored key keeps its earlier response
+            memory.Learn({"key", "1"}, "again");
+            size_t visited = 0;
+            memory.ForEach([&visited](std::string_view key, const std::vector<std::string_view>& responses) {
+                if (key == "key_1") {
+                    REQUIRE(responses == std::vector<std::string_view>{"response 1", "again"});
+                }
+                ++visited;
+            });
+            REQUIRE(visited == 50000);
+        }
+        
+        // The stored keys outlive the memory; the oldest were evicted first
+        ai_framework::ShardedLearningMemory reopened(2);
+        reopened.SetStorageBackend(ai_framework::StorageBackend::Create("lsm", directory));
+        std::string response;
+        size_t found = 0;
+        for (int i = 2; i < 102; ++i) {
+            if (reopened.GetRandomResponse(ai_framework::LearningMemory::HashKey("key_" + std::to_string(i)), response)) {
+                REQUIRE(response == "response " + std::to_string(i % 10));
+                ++found;
+            }
+        }
+        REQUIRE(found > 90);
+        reopened.Clear();
+        REQUIRE(reopened.GetKeyCount() == 0);
+        REQUIRE_FALSE(reopened.GetRandomResponse(ai_framework::LearningMemory::HashKey("key_2"), response));
+        std::filesystem::remove_all(directory);
+    }
+}
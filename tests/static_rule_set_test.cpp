@@ -0,0 +1,75 @@
+// static_rule_set_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/static_rule_based_agent.h"
+#include <regex>
+#include <so_5/all.hpp>
+
+namespace {
+
+struct GreetingRule {
+    static constexpr std::string_view pattern = ".*hello.*";
+    static constexpr std::string_view response = "Hi there! I'm ${agent_id}.";
+};
+
+struct FarewellRule {
+    static constexpr std::string_view pattern = "^(?:bye)$";
+    static constexpr std::string_view response = "Unused";
+};
+
+struct QuestionRule {
+    static constexpr std::string_view pattern = "^wh.+\\?$";
+    static constexpr std::string_view response = "Good question.";
+};
+
+struct ColorRule {
+    static constexpr std::string_view pattern = "colou?r";
+    static constexpr std::string_view response = "Blue.";
+};
+
+using BuiltinRules = ai_framework::StaticRuleSet<GreetingRule, QuestionRule, ColorRule>;
+
+// Matching runs at compile time too
+static_assert(BuiltinRules::FindMatch("HELLO world") == 0, "greeting");
+static_assert(BuiltinRules::FindMatch("what time is it?") == 1, "question");
+static_assert(BuiltinRules::FindMatch("favourite color") == 2, "color");
+static_assert(BuiltinRules::FindMatch("nothing") == BuiltinRules::NO_MATCH, "no match");
+static_assert(!ai_framework::static_rules::Compile<FarewellRule::pattern.size()>(
+                  FarewellRule::pattern).valid, "groups are rejected");
+
+template <typename Rule>
+bool SameAsRegex(const std::string& message) {
+    constexpr auto& program = ai_framework::static_rules::CompiledRule<Rule>::program;
+    std::regex regex(std::string(Rule::pattern), std::regex::icase);
+    return ai_framework::static_rules::Search(program, message) ==
+           std::regex_search(message, regex);
+}
+
+} // namespace
+
+TEST_CASE("StaticRuleSet Functionality", "[static_rule_set]") {
+    SECTION("Agree with std::regex") {
+        const std::vector<std::string> messages = {
+            "", "hello", "HeLLo there", "say hello\nagain", "hell o",
+            "what?", "wh?", "why not?", "who\n?", "what? no",
+            "color", "COLOUR", "colouur", "colr"
+        };
+        
+        for (const auto& message : messages) {
+            INFO(message);
+            REQUIRE(SameAsRegex<GreetingRule>(message));
+            REQUIRE(SameAsRegex<QuestionRule>(message));
+            REQUIRE(SameAsRegex<ColorRule>(message));
+        }
+    }
+    
+    SECTION("Answer through the Agent interface") {
+        so_5::wrapped_env_t env;
+        auto agent = std::make_shared<ai_framework::StaticRuleBasedAgent<BuiltinRules>>(
+            env.environment(), "builtin-agent", "No idea.");
+        
+        REQUIRE(agent->Initialize("") == true);
+        REQUIRE(agent->ProcessMessage("hello") == "Hi there! I'm builtin-agent.");
+        REQUIRE(agent->ProcessMessage("why?") == "Good question.");
+        REQUIRE(agent->ProcessMessage("something random") == "No idea.");
+    }
+}
@@ -0,0 +1,103 @@
+// string_pool_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/string_pool.h"
+#include "../src/learning_memory.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE("StringPool Functionality", "[string_pool]") {
+    ai_framework::StringPool& pool = ai_framework::StringPool::GetInstance();
+    
+    SECTION("Equal strings share one handle") {
+        auto before = pool.GetStats();
+        
+        auto first = pool.Intern("string pool test: shared");
+        auto second = pool.Intern(std::string("string pool test: ") + "shared");
+        auto other = pool.Intern("string pool test: other");
+        REQUIRE(first == second);
+        REQUIRE(first != other);
+        REQUIRE(pool.Get(first) == "string pool test: shared");
+        
+        auto during = pool.GetStats();
+        REQUIRE(during.uniqueStrings == before.uniqueStrings + 2);
+        REQUIRE(during.references == before.references + 3);
+        
+        pool.Release(first);
+        REQUIRE(pool.Get(second) == "string pool test: shared");
+        pool.Release(second);
+        pool.Release(other);
+        
+        auto after = pool.GetStats();
+        REQUIRE(after.uniqueStrings == before.uniqueStrings);
+        REQUIRE(after.references == before.references);
+        REQUIRE(after.uniqueBytes == before.uniqueBytes);
+    }
+    
+    SECTION("Freed strings can be interned again") {
+        auto handle = pool.Intern("string pool test: transient");
+        pool.Retain(handle);
+        pool.Release(handle);
+        REQUIRE(pool.Get(handle) == "string pool test: transient");
+        pool.Release(handle);
+        
+        auto again = pool.Intern("string pool test: transient");
+        REQUIRE(pool.Get(again) == "string pool test: transient");
+        pool.Release(again);
+    }
+    
+    SECTION("Intern and release from many threads") {
+        auto before = pool.GetStats();
+        std::atomic<int> mismatches{0};
+        
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&pool, &mismatches]() {
+                for (int i = 0; i < 2000; ++i) {
+                    std::string text = "string pool test: " + std::to_string(i % 50);
+                    auto handle = pool.Intern(text);
+                    if (pool.Get(handle) != text) {
+                        ++mismatches;
+                    }
+                    pool.Release(handle);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        REQUIRE(mismatches == 0);
+        auto after = pool.GetStats();
+        REQUIRE(after.uniqueStrings == before.uniqueStrings);
+        REQUIRE(after.references == before.references);
+    }
+    
+    SECTION("Memories store each response once") {
+        auto before = pool.GetStats();
+        {
+            ai_framework::LearningMemory first;
+            ai_framework::LearningMemory second;
+            for (int i = 0; i < 100; ++i) {
+                std::string key = "key_" + std::to_string(i);
+                first.AddResponse(ai_framework::LearningMemory::HashKey(key), key, "string pool test: same");
+                second.AddResponse(ai_framework::LearningMemory::HashKey(key), key, "string pool test: same");
+            }
+            
+            auto during = pool.GetStats();
+            REQUIRE(during.uniqueStrings == before.uniqueStrings + 1);
+            REQUIRE(during.references == before.references + 200);
+            REQUIRE(during.GetDedupRatio() > before.GetDedupRatio());
+            
+            // A copy shares the pooled responses
+            ai_framework::LearningMemory copy(first);
+            REQUIRE(pool.GetStats().references == before.references + 300);
+            REQUIRE(copy.GetResponse(copy.Find(ai_framework::LearningMemory::HashKey("key_7")), 0) ==
+                    "string pool test: same");
+        }
+        
+        auto after = pool.GetStats();
+        REQUIRE(after.uniqueStrings == before.uniqueStrings);
+        REQUIRE(after.references == before.references);
+    }
+}
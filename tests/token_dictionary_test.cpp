@@ -0,0 +1,99 @@
+// token_dictionary_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/token_dictionary.h"
+#include "../src/memory_budget.h"
+#include "../src/tokenizer.h"
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("TokenDictionary Functionality", "[token_dictionary]") {
+    ai_framework::TokenDictionary& dictionary = ai_framework::TokenDictionary::GetInstance();
+    
+    SECTION("Equal tokens share one dense id") {
+        size_t before = dictionary.GetTokenCount();
+        
+        auto first = dictionary.Intern("dictionary_test_alpha");
+        auto second = dictionary.Intern(std::string("dictionary_test_") + "alpha");
+        auto other = dictionary.Intern("dictionary_test_beta");
+        REQUIRE(first == second);
+        REQUIRE(first != other);
+        REQUIRE(first >= before);
+        REQUIRE(other < dictionary.GetTokenCount());
+        REQUIRE(dictionary.GetTokenCount() == before + 2);
+        
+        REQUIRE(dictionary.GetToken(first) == "dictionary_test_alpha");
+        REQUIRE(dictionary.Find("dictionary_test_beta") == other);
+        REQUIRE(dictionary.Find("dictionary_test_never") == ai_framework::TokenDictionary::NOT_FOUND);
+        REQUIRE(dictionary.GetTokenCount() == before + 2);
+        
+        // Tokens longer than a text chunk are stored on their own
+        std::string longToken(100 * 1024, 'x');
+        auto longId = dictionary.Intern(longToken);
+        REQUIRE(dictionary.GetToken(longId) == longToken);
+        REQUIRE(dictionary.GetToken(first) == "dictionary_test_alpha");
+    }
+    
+    SECTION("Tokenize messages into ids") {
+        ai_framework::Tokenizer& tokenizer = ai_framework::Tokenizer::Local();
+        
+        // Unknown tokens are left out of the dictionary when asked
+        auto ids = tokenizer.TokenizeIds("Dictionary-Query never_seen_token", false);
+        REQUIRE(ids.size() == 2);
+        REQUIRE(ids[0] == ai_framework::TokenDictionary::NOT_FOUND);
+        REQUIRE(dictionary.Find("never_seen_token") == ai_framework::TokenDictionary::NOT_FOUND);
+        
+        ids = tokenizer.TokenizeIds("Dictionary-Query HELLO dictionaryquery");
+        REQUIRE(ids.size() == 3);
+        REQUIRE(ids[0] == ids[2]);
+        REQUIRE(dictionary.GetToken(ids[0]) == "dictionaryquery");
+        REQUIRE(dictionary.GetToken(ids[1]) == "hello");
+    }
+    
+    SECTION("Concurrent interning agrees on ids") {
+        const int threadCount = 4;
+        const int tokenCount = 20000;
+        std::vector<std::vector<ai_framework::TokenDictionary::Id>> results(threadCount);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&dictionary, &results, t, threadCount, tokenCount] {
+                // Each thread starts at a different token
+                results[t].resize(tokenCount);
+                for (int i = 0; i < tokenCount; ++i) {
+                    int token = (i + t * tokenCount / threadCount) % tokenCount;
+                    results[t][token] = dictionary.Intern("concurrent_" + std::to_string(token));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        std::set<ai_framework::TokenDictionary::Id> distinct(results[0].begin(), results[0].end());
+        REQUIRE(distinct.size() == tokenCount);
+        for (int t = 1; t < threadCount; ++t) {
+            REQUIRE(results[t] == results[0]);
+        }
+        for (int i = 0; i < tokenCount; i += 101) {
+            REQUIRE(dictionary.GetToken(results[0][i]) == "concurrent_" + std::to_string(i));
+        }
+    }
+    
+    SECTION("Growth is charged to the memory budget") {
+        ai_framework::MemoryBudget& budget = ai_framework::MemoryBudget::GetInstance();
+        size_t bytesBefore = dictionary.GetMemoryBytes();
+        int64_t usedBefore = budget.GetStats().usedBytes;
+        
+        for (int i = 0; i < 20000; ++i) {
+            dictionary.Intern("charged_token_" + std::to_string(i));
+        }
+        
+        // Everything but the last, still uncharged batch counts
+        int64_t grown = static_cast<int64_t>(dictionary.GetMemoryBytes() - bytesBefore);
+        int64_t charged = budget.GetStats().usedBytes - usedBefore;
+        REQUIRE(grown > static_cast<int64_t>(ai_framework::TokenDictionary::CHARGE_BATCH));
+        REQUIRE(charged > grown / 2);
+        REQUIRE(charged <= grown + static_cast<int64_t>(ai_framework::TokenDictionary::CHARGE_BATCH));
+    }
+}
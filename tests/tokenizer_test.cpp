@@ -0,0 +1,69 @@
+// tokenizer_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/tokenizer.h"
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <sstream>
+
+namespace {
+
+// Lowercase, strip punctuation, split on spaces; the original feature extraction
+std::vector<std::string> ReferenceTokens(const std::string& message) {
+    std::string normalized;
+    for (char c : message) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (!std::ispunct(u)) {
+            normalized += static_cast<char>(u < 0x80 ? std::tolower(u) : u);
+        }
+    }
+    
+    std::vector<std::string> tokens;
+    std::istringstream iss(normalized);
+    std::string token;
+    while (std::getline(iss, token, ' ')) {
+        if (!token.empty()) {
+            tokens.push_back(token);
+        }
+    }
+    return tokens;
+}
+
+std::vector<std::string> ToStrings(const std::vector<std::string_view>& views) {
+    return std::vector<std::string>(views.begin(), views.end());
+}
+
+} // namespace
+
+TEST_CASE("Tokenizer Functionality", "[tokenizer]") {
+    ai_framework::Tokenizer tokenizer;
+    
+    SECTION("Normalize and split a message") {
+        auto tokens = ToStrings(tokenizer.Tokenize("Hello, how ARE you?  I'm fine!"));
+        REQUIRE(tokens == std::vector<std::string>{"hello", "how", "are", "you", "im", "fine"});
+        
+        REQUIRE(tokenizer.Tokenize("").empty());
+        REQUIRE(tokenizer.Tokenize(" ?! ").empty());
+    }
+    
+    SECTION("Keep non-space whitespace and non-ASCII bytes inside tokens") {
+        auto tokens = ToStrings(tokenizer.Tokenize("Tab\there caf\xc3\xa9"));
+        REQUIRE(tokens == std::vector<std::string>{"tab\there", "caf\xc3\xa9"});
+    }
+    
+    SECTION("Agree with the reference on random messages") {
+        std::mt19937 rng(42);
+        const std::string alphabet = "aZ z.,!?'-_ \t0Q\x80\xff";
+        
+        for (int i = 0; i < 2000; ++i) {
+            std::string message;
+            size_t length = rng() % 70;
+            for (size_t j = 0; j < length; ++j) {
+                message += alphabet[rng() % alphabet.size()];
+            }
+            
+            INFO(message);
+            REQUIRE(ToStrings(tokenizer.Tokenize(message)) == ReferenceTokens(message));
+        }
+    }
+}
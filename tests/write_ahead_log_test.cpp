@@ -0,0 +1,122 @@
+// write_ahead_log_test.cpp
+#include "catch2/catch.hpp"
+#include "../src/write_ahead_log.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Record = std::pair<std::string, std::string>;
+
+std::vector<Record> ReplayAll(const ai_framework::WriteAheadLog& wal, uint64_t afterGeneration = 0) {
+    std::vector<Record> records;
+    wal.Replay(afterGeneration, [&records](std::string_view key, std::string_view response) {
+        records.emplace_back(std::string(key), std::string(response));
+    });
+    return records;
+}
+
+void RemoveAll(const std::string& base) {
+    ai_framework::WriteAheadLog(base).RemoveSegmentsUpTo(UINT64_MAX);
+}
+
+} // namespace
+
+TEST_CASE("WriteAheadLog Functionality", "[write_ahead_log]") {
+    const std::string base = "write_ahead_log_test.wal";
+    RemoveAll(base);
+    
+    SECTION("Flushed records are replayed in order") {
+        {
+            ai_framework::WriteAheadLog wal(base);
+            REQUIRE(wal.Open() == true);
+            REQUIRE(wal.GetGeneration() == 1);
+            wal.Append("hello_there", "Hi!");
+            wal.Append("how_are_you", "");
+            REQUIRE(wal.Flush() == true);
+            wal.Append("hello_there", "Hello again!");
+        }
+        
+        // The destructor flushes the last record
+        ai_framework::WriteAheadLog wal(base);
+        auto records = ReplayAll(wal);
+        REQUIRE(records.size() == 3);
+        REQUIRE(records[0] == Record("hello_there", "Hi!"));
+        REQUIRE(records[1] == Record("how_are_you", ""));
+        REQUIRE(records[2] == Record("hello_there", "Hello again!"));
+        
+        // Reopening continues after the existing segment
+        REQUIRE(wal.Open() == true);
+        REQUIRE(wal.GetGeneration() == 2);
+    }
+    
+    SECTION("Replay stops at a torn record") {
+        {
+            ai_framework::WriteAheadLog wal(base);
+            REQUIRE(wal.Open() == true);
+            wal.Append("first", "kept");
+            wal.Append("second", "torn");
+        }
+        
+        // Cut the last record in half
+        std::string path = base + ".1";
+        std::string contents;
+        {
+            std::ifstream in(path, std::ios::binary);
+            contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(contents.data(), static_cast<std::streamsize>(contents.size() - 3));
+        }
+        
+        auto records = ReplayAll(ai_framework::WriteAheadLog(base));
+        REQUIRE(records.size() == 1);
+        REQUIRE(records[0] == Record("first", "kept"));
+    }
+    
+    SECTION("Rotation separates records covered by a checkpoint") {
+        ai_framework::WriteAheadLog wal(base);
+        REQUIRE(wal.Open() == true);
+        wal.Append("before", "checkpoint");
+        
+        uint64_t closed = 0;
+        REQUIRE(wal.Rotate(closed) == true);
+        REQUIRE(closed == 1);
+        REQUIRE(wal.GetGeneration() == 2);
+        wal.Append("after", "checkpoint");
+        REQUIRE(wal.Flush() == true);
+        
+        REQUIRE(ReplayAll(wal).size() == 2);
+        
+        auto newer = ReplayAll(wal, closed);
+        REQUIRE(newer.size() == 1);
+        REQUIRE(newer[0] == Record("after", "checkpoint"));
+        
+        wal.RemoveSegmentsUpTo(closed);
+        REQUIRE(ReplayAll(wal) == newer);
+    }
+    
+    SECTION("A failed rotation keeps the current segment") {
+        ai_framework::WriteAheadLog wal(base);
+        REQUIRE(wal.Open() == true);
+        wal.Append("before", "rotation");
+        
+        // A directory where the next segment goes makes opening it fail
+        std::filesystem::create_directory(base + ".2");
+        uint64_t closed = 0;
+        REQUIRE(wal.Rotate(closed) == false);
+        REQUIRE(closed == 0);
+        REQUIRE(wal.GetGeneration() == 1);
+        
+        wal.Append("after", "rotation");
+        REQUIRE(wal.Flush() == true);
+        REQUIRE(ReplayAll(wal, 0).size() == 2);
+        std::filesystem::remove(base + ".2");
+    }
+    
+    RemoveAll(base);
+}